@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------------
+// Name:        bench_main.cpp
+// Purpose:     Benchmark runner: allocation counting, command line, JSON output
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include "bench_util.h"
+
+// replaced operators are inlined into containers of this file, which makes GCC report malloc / delete mismatch
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size) {
+    bench_count_alloc(size);
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr) {
+        bench_count_free();
+        std::free(ptr);
+    }
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+std::string json_escape(const std::string &text) {
+    std::string result;
+    for (std::string::const_iterator it = text.begin(); it != text.end(); ++it) {
+        if (*it == '"' || *it == '\\')
+            result += '\\';
+        result += *it;
+    }
+    return result;
+}
+
+std::string compiler_name() {
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    std::ostringstream out;
+    out << "msvc " << _MSC_VER;
+    return out.str();
+#else
+    return "unknown";
+#endif
+}
+
+/// every benchmark is written in a single line, so that output can be compared with line-based diff
+void write_json(std::ostream &out, const bench_options &options, const std::vector<bench_result> &results) {
+    out << "{\n";
+    out << "  \"context\": {\n";
+    out << "    \"compiler\": \"" << json_escape(compiler_name()) << "\",\n";
+    out << "    \"cplusplus\": " << __cplusplus << ",\n";
+#ifdef NDEBUG
+    out << "    \"ndebug\": true,\n";
+#else
+    out << "    \"ndebug\": false,\n";
+#endif
+    out << "    \"repeat\": " << options.repeat << ",\n";
+    out << "    \"scale\": " << options.scale << "\n";
+    out << "  },\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result &result = results[i];
+        char numbers[160];
+        std::snprintf(numbers, sizeof(numbers), "\"ops\": %lu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f",
+                      static_cast<unsigned long>(result.ops), result.ns_per_op, result.allocs_per_op, result.bytes_per_op);
+        out << "    {\"suite\": \"" << json_escape(result.suite) << "\", \"name\": \"" << json_escape(result.name)
+            << "\", " << numbers << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool read_json_field(const std::string &line, const std::string &field, std::string &value) {
+    std::string prefix = "\"" + field + "\": ";
+    size_t pos = line.find(prefix);
+    if (pos == std::string::npos)
+        return false;
+    pos += prefix.size();
+    if (line[pos] == '"') {
+        value.clear();
+        for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+            if (line[pos] == '\\')
+                ++pos;
+            value += line[pos];
+        }
+    } else {
+        value = line.substr(pos, line.find_first_of(",}", pos) - pos);
+    }
+    return true;
+}
+
+/// reads ns/op from file written by write_json, key is "suite/name"
+bool read_baseline(const std::string &path, std::map<std::string, double> &baseline) {
+    std::ifstream in(path.c_str());
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string suite, name, ns;
+        if (read_json_field(line, "suite", suite) && read_json_field(line, "name", name) && read_json_field(line, "ns_per_op", ns))
+            baseline[suite + "/" + name] = std::atof(ns.c_str());
+    }
+    return true;
+}
+
+void print_comparison(FILE *out, const std::map<std::string, double> &baseline, const std::vector<bench_result> &results) {
+    std::fprintf(out, "\n%-56s %12s %12s %9s\n", "benchmark", "base ns/op", "ns/op", "change");
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::string key = results[i].suite + "/" + results[i].name;
+        std::map<std::string, double>::const_iterator found = baseline.find(key);
+        if (found == baseline.end() || found->second <= 0.0)
+            continue;
+        std::fprintf(out, "%-56s %12.2f %12.2f %+8.1f%%\n", key.c_str(), found->second, results[i].ns_per_op,
+                     (results[i].ns_per_op / found->second - 1.0) * 100.0);
+    }
+}
+
+bool suite_less(const bench_suite &lhs, const bench_suite &rhs) {
+    return lhs.name < rhs.name;
+}
+
+void print_usage() {
+    std::printf(
+        "usage: xnode_bench [options]\n"
+        "  --list              list suites\n"
+        "  --filter TEXT       run benchmarks which full name (suite/name) contains TEXT\n"
+        "  --repeat N          number of measured runs, median is reported (default 3)\n"
+        "  --scale X           multiply number of operations by X (default 1.0)\n"
+        "  --json FILE         write results in JSON format, '-' for standard output\n"
+        "  --compare FILE      compare results with JSON file from previous run\n");
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    bench_options options;
+    std::string jsonPath, comparePath;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--list") {
+            listOnly = true;
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeat = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--scale" && hasValue) {
+            options.scale = std::atof(argv[++i]);
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--compare" && hasValue) {
+            comparePath = argv[++i];
+        } else {
+            print_usage();
+            return (arg == "--help") ? 0 : 1;
+        }
+    }
+
+    std::vector<bench_suite> suites = bench_suites();
+    std::sort(suites.begin(), suites.end(), suite_less);
+
+    if (listOnly) {
+        for (size_t i = 0; i < suites.size(); ++i)
+            std::printf("%s\n", suites[i].name.c_str());
+        return 0;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!comparePath.empty() && !read_baseline(comparePath, baseline)) {
+        std::fprintf(stderr, "cannot read baseline: %s\n", comparePath.c_str());
+        return 1;
+    }
+
+    // with JSON on standard output text report is moved to standard error
+    if (jsonPath == "-")
+        options.out = stderr;
+
+    std::vector<bench_result> results;
+    for (size_t i = 0; i < suites.size(); ++i) {
+        bench_context context(suites[i].name, options, results);
+        suites[i].func(context);
+    }
+
+    if (!baseline.empty())
+        print_comparison(options.out, baseline, results);
+
+    if (jsonPath == "-") {
+        write_json(std::cout, options, results);
+    } else if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath.c_str());
+        write_json(out, options, results);
+        if (!out) {
+            std::fprintf(stderr, "cannot write results: %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
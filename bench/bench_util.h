@@ -0,0 +1,178 @@
+//----------------------------------------------------------------------------------
+// Name:        bench_util.h
+// Purpose:     Timing, allocation counting and registration helpers for benchmarks
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// \file bench_util.h
+/// Timing, allocation counting and registration helpers for benchmarks.
+/// Global operator new/delete are replaced in bench_main.cpp, so allocation
+/// counters are valid only in xnode_bench executable.
+
+struct bench_alloc_stats {
+    size_t allocs;
+    size_t frees;
+    size_t bytes;
+};
+
+/// counters updated by replaced operator new/delete from any thread
+struct bench_alloc_shared_counters {
+    std::atomic<size_t> allocs;
+    std::atomic<size_t> frees;
+    std::atomic<size_t> bytes;
+};
+
+inline bench_alloc_shared_counters &bench_alloc_shared() {
+    static bench_alloc_shared_counters counters = { {0}, {0}, {0} };
+    return counters;
+}
+
+inline void bench_count_alloc(size_t size) {
+    bench_alloc_shared_counters &counters = bench_alloc_shared();
+    counters.allocs.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+inline void bench_count_free() {
+    bench_alloc_shared().frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// returns allocations counted so far in all threads
+inline bench_alloc_stats bench_alloc_counters() {
+    bench_alloc_shared_counters &counters = bench_alloc_shared();
+    bench_alloc_stats result = {
+        counters.allocs.load(std::memory_order_relaxed),
+        counters.frees.load(std::memory_order_relaxed),
+        counters.bytes.load(std::memory_order_relaxed)
+    };
+    return result;
+}
+
+struct bench_result {
+    std::string suite;
+    std::string name;
+    size_t ops;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;
+};
+
+/// prevents compiler from optimizing out computed value
+template <typename T>
+inline void bench_keep(const T &value) {
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = static_cast<const void *>(&value);
+#endif
+}
+
+/// runs func(ops) once for warm-up and repeat times measured, func is expected to execute ops operations,
+/// reported time is median of measured runs
+template <typename Func>
+bench_result bench_run(const std::string &name, size_t ops, Func func, unsigned int repeat = 1) {
+    func(ops / 10 + 1);
+
+    std::vector<double> times;
+    bench_alloc_stats before = bench_alloc_counters();
+    bench_alloc_stats after = before;
+    for (unsigned int i = 0; i < std::max(repeat, 1u); ++i) {
+        before = bench_alloc_counters();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        func(ops);
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        after = bench_alloc_counters();
+        times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+
+    bench_result result;
+    result.name = name;
+    result.ops = ops;
+    result.ns_per_op = times[times.size() / 2] / ops;
+    result.allocs_per_op = static_cast<double>(after.allocs - before.allocs) / ops;
+    result.bytes_per_op = static_cast<double>(after.bytes - before.bytes) / ops;
+    return result;
+}
+
+inline void bench_print(FILE *out, const bench_result &result) {
+    std::fprintf(out, "%-56s %12.2f ns/op %10.3f allocs/op %12.1f bytes/op\n",
+                 (result.suite + "/" + result.name).c_str(), result.ns_per_op, result.allocs_per_op, result.bytes_per_op);
+}
+
+/// settings of benchmark run, passed to every suite
+struct bench_options {
+    bench_options() : repeat(3), scale(1.0), out(stdout) {}
+
+    std::string filter;
+    unsigned int repeat;
+    double scale;
+    FILE *out;
+};
+
+/// collects results of a single suite
+class bench_context {
+public:
+    bench_context(const std::string &suite, const bench_options &options, std::vector<bench_result> &results)
+        : suite_(suite), options_(options), results_(results) {}
+
+    /// runs benchmark if its full name ("suite/name") contains filter text,
+    /// ops is number of operations at scale 1.0
+    template <typename Func>
+    void run(const std::string &name, size_t ops, Func func) {
+        std::string fullName = suite_ + "/" + name;
+        if (!options_.filter.empty() && fullName.find(options_.filter) == std::string::npos)
+            return;
+
+        size_t scaledOps = static_cast<size_t>(static_cast<double>(ops) * options_.scale);
+        bench_result result = bench_run(name, std::max<size_t>(scaledOps, 1), func, options_.repeat);
+        result.suite = suite_;
+        bench_print(options_.out, result);
+        results_.push_back(result);
+    }
+
+private:
+    std::string suite_;
+    const bench_options &options_;
+    std::vector<bench_result> &results_;
+};
+
+typedef void (*bench_suite_func)(bench_context &context);
+
+struct bench_suite {
+    std::string name;
+    bench_suite_func func;
+};
+
+inline std::vector<bench_suite> &bench_suites() {
+    static std::vector<bench_suite> suites;
+    return suites;
+}
+
+struct bench_register {
+    bench_register(const char *name, bench_suite_func func) {
+        bench_suite suite = { name, func };
+        bench_suites().push_back(suite);
+    }
+};
+
+/// defines benchmark suite function, suites are executed in order of names
+#define BENCH_SUITE(name) \
+    static void bench_suite_##name(bench_context &context); \
+    static bench_register bench_register_##name(#name, bench_suite_##name); \
+    static void bench_suite_##name(bench_context &context)
+
+#endif
@@ -0,0 +1,671 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_container_bench.cpp
+// Purpose:     Benchmark of xobject / xarray trees, property_list and xarray::of
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xarray.h"
+#include "xobject.h"
+#include "xarray_typed.h"
+#include "xarray_reduce.h"
+#include "xarray_segmented.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include "bench_util.h"
+
+using namespace std;
+
+namespace {
+
+const size_t tree_depth = 4;
+const size_t tree_fanout = 6;
+
+std::vector<std::string> make_keys(size_t count, const char *prefix) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < count; ++i)
+        keys.push_back(prefix + to_string(i));
+    return keys;
+}
+
+// document with objects on even levels and arrays on odd levels, leaves are mixed scalars
+template <typename NodeType>
+NodeType make_tree(size_t depth) {
+    typedef property_list<std::string, NodeType> object_type;
+    typedef basic_xarray<NodeType> array_type;
+
+    static const std::vector<std::string> keys = make_keys(tree_fanout, "field_");
+
+    if (depth == 0)
+        return NodeType::value_of(std::string("leaf value"));
+
+    if (depth % 2 == 0) {
+        object_type object;
+        for (size_t i = 0; i < tree_fanout; ++i)
+            object.put(keys[i], (i % 3 == 0) ? NodeType::value_of(static_cast<int>(i)) : make_tree<NodeType>(depth - 1));
+        return NodeType::value_of(std::move(object));
+    }
+
+    array_type array;
+    for (size_t i = 0; i < tree_fanout; ++i)
+        array.push_back((i % 3 == 0) ? NodeType::value_of(static_cast<double>(i)) : make_tree<NodeType>(depth - 1));
+    return NodeType::value_of(std::move(array));
+}
+
+template <typename NodeType>
+void copy_tree(size_t ops) {
+    const NodeType tree = make_tree<NodeType>(tree_depth);
+    for (size_t i = 0; i < ops; ++i) {
+        NodeType copy(tree);
+        bench_keep(copy);
+    }
+}
+
+template <typename NodeType>
+void move_tree(size_t ops) {
+    NodeType first = make_tree<NodeType>(tree_depth);
+    NodeType second;
+    for (size_t i = 0; i < ops; ++i) {
+        second = std::move(first);
+        first = std::move(second);
+        bench_keep(first);
+    }
+}
+
+const size_t list_size = 64;
+
+// other storages of property_list, xobject keeps up to 8 fields inline
+typedef property_list<std::string, xnode, std::allocator<xnode>, property_list_hash_storage> hash_object;
+typedef property_list<std::string, xnode, std::allocator<xnode>, property_list_flat_storage> flat_object;
+
+// type used to fill object of a given type, frozen objects are frozen copies of xobject
+template <typename ObjectType>
+struct object_builder {
+    typedef ObjectType type;
+};
+
+template <>
+struct object_builder<frozen_xobject> {
+    typedef xobject type;
+};
+
+template <typename ObjectType>
+void list_put(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "key_");
+    ObjectType object;
+    for (size_t i = 0; i < ops; ++i) {
+        if (i % list_size == 0)
+            object.clear();
+        object.put(keys[i % list_size], xnode::value_of(static_cast<int>(i)));
+    }
+    bench_keep(object);
+}
+
+template <typename ObjectType>
+void list_get(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "key_");
+    typename object_builder<ObjectType>::type fields;
+    for (size_t i = 0; i < list_size; ++i)
+        fields.put(keys[i], xnode::value_of(static_cast<int>(i)));
+    const ObjectType object(std::move(fields));
+
+    // lookups are not sequential, as in random access to fields of document
+    long long sum = 0;
+    for (size_t i = 0; i < ops; ++i)
+        sum += object.get(keys[(i * 7) % list_size]).template get_as<int>();
+    bench_keep(sum);
+}
+
+// field names taken from a text buffer (like a request parser), as std::string temporaries or as text references
+const char field_buffer[] = "request_method,request_path_info,request_content_type,request_user_agent";
+const size_t field_offsets[] = {0, 15, 33, 54, sizeof(field_buffer)};
+
+template <bool UseKeyRef>
+void list_get_text(size_t ops) {
+    const size_t field_count = sizeof(field_offsets) / sizeof(field_offsets[0]) - 1;
+    xobject object;
+    for (size_t i = 0; i < field_count; ++i)
+        object.put(std::string(field_buffer + field_offsets[i], field_offsets[i + 1] - field_offsets[i] - 1),
+                   xnode::value_of(static_cast<int>(i)));
+
+    long long sum = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        size_t field = i % field_count;
+        const char *text = field_buffer + field_offsets[field];
+        size_t length = field_offsets[field + 1] - field_offsets[field] - 1;
+        if (UseKeyRef)
+            sum += object.get(property_list_key_ref(text, length)).get_as<int>();
+        else
+            sum += object.get(std::string(text, length)).get_as<int>();
+    }
+    bench_keep(sum);
+}
+
+template <typename ObjectType>
+void list_put_remove(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "key_");
+    ObjectType object;
+    for (size_t i = 0; i < ops; ++i) {
+        object.put(keys[i % list_size], xnode::value_of(static_cast<int>(i)));
+        object.remove(keys[(i + list_size / 2) % list_size]);
+    }
+    bench_keep(object);
+}
+
+template <typename ObjectType>
+void list_remove_reorg(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "key_");
+    for (size_t i = 0; i < ops; ++i) {
+        ObjectType object;
+        for (size_t k = 0; k < list_size; ++k)
+            object.put(keys[k], xnode::value_of(static_cast<int>(k)));
+        for (size_t k = 0; k < list_size; k += 2)
+            object.remove(keys[k]);
+        object.reorg();
+        bench_keep(object);
+    }
+}
+
+// builds wide object from parsed fields one by one or with a single put_all
+template <typename ObjectType, bool Bulk>
+void list_build(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "key_");
+    std::vector<std::pair<std::string, xnode> > fields;
+    for (size_t i = 0; i < list_size; ++i)
+        fields.push_back(std::make_pair(keys[i], xnode::value_of(static_cast<int>(i))));
+
+    for (size_t i = 0; i < ops; i += list_size) {
+        ObjectType object;
+        if (Bulk) {
+            object.put_all(fields.begin(), fields.end());
+        } else {
+            for (size_t k = 0; k < fields.size(); ++k)
+                object.put(fields[k].first, fields[k].second);
+        }
+        bench_keep(object);
+    }
+}
+
+// session-like churn: replace one key and walk keys in order after each change
+template <typename ObjectType>
+void list_remove_iterate(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size * 2, "key_");
+    ObjectType object;
+    for (size_t i = 0; i < list_size; ++i)
+        object.put(keys[i], xnode::value_of(static_cast<int>(i)));
+
+    size_t count = 0;
+    for (size_t i = 0; i < ops; i += list_size) {
+        object.remove(keys[i / list_size % (list_size * 2)]);
+        object.put(keys[(i / list_size + list_size) % (list_size * 2)], xnode::value_of(static_cast<int>(i)));
+        for (auto it = object.keys_begin(); it != object.keys_end(); ++it)
+            count += it->size();
+    }
+    bench_keep(count);
+}
+
+template <typename ObjectType>
+void list_iterate(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "key_");
+    ObjectType object;
+    for (size_t i = 0; i < list_size; ++i)
+        object.put(keys[i], xnode::value_of(static_cast<int>(i)));
+
+    long long sum = 0;
+    for (size_t i = 0; i < ops; i += list_size) {
+        std::vector<xnode> values = object.get_values();
+        for (size_t k = 0; k < values.size(); ++k)
+            sum += values[k].get_as<int>();
+    }
+    bench_keep(sum);
+}
+
+// creates object with FieldCount fields and reads each of them
+template <typename ObjectType, size_t FieldCount>
+void object_create_get(size_t ops) {
+    static const std::vector<std::string> keys = make_keys(FieldCount, "field_");
+    long long sum = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        ObjectType object;
+        for (size_t k = 0; k < FieldCount; ++k)
+            object.put(keys[k], xnode::value_of(static_cast<int>(k)));
+        for (size_t k = 0; k < FieldCount; ++k)
+            sum += object.get(keys[(k * 7) % FieldCount]).template get_as<int>();
+    }
+    bench_keep(sum);
+}
+
+template <size_t FieldCount>
+void object_create_get_interned(size_t ops) {
+    static const std::vector<std::string> names = make_keys(FieldCount, "field_");
+    static std::vector<xkey> keys;
+    for (size_t k = keys.size(); k < FieldCount; ++k)
+        keys.push_back(xkey::of(names[k]));
+
+    long long sum = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        xobject_interned object;
+        for (size_t k = 0; k < FieldCount; ++k)
+            object.put(keys[k], xnode::value_of(static_cast<int>(k)));
+        for (size_t k = 0; k < FieldCount; ++k)
+            sum += object.get(keys[(k * 7) % FieldCount]).get_as<int>();
+    }
+    bench_keep(sum);
+}
+
+template <size_t FieldCount>
+void run_object_fields(bench_context &context, size_t ops) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "create + get, %lu fields", static_cast<unsigned long>(FieldCount));
+    context.run(std::string(name) + " (hash)", ops, object_create_get<hash_object, FieldCount>);
+    context.run(std::string(name) + " (flat)", ops, object_create_get<flat_object, FieldCount>);
+    context.run(std::string(name) + " (small)", ops, object_create_get<xobject, FieldCount>);
+    context.run(std::string(name) + " (shaped)", ops, object_create_get<xobject_shaped, FieldCount>);
+    context.run(std::string(name) + " (interned)", ops, object_create_get_interned<FieldCount>);
+}
+
+const size_t record_count = 1000;
+
+// xarray of record objects with the same fields, as loaded from a table
+template <typename ObjectType>
+xarray make_records() {
+    xarray records;
+    records.reserve(record_count);
+    for (size_t i = 0; i < record_count; ++i) {
+        typename object_builder<ObjectType>::type record;
+        record.put("id", xnode::value_of(static_cast<int>(i)));
+        record.put("name", xnode::value_of(std::string("record name")));
+        record.put("ts", xnode::value_of(static_cast<int>(1000 + i)));
+        record.put("status", xnode::value_of(1));
+        record.put("value", xnode::value_of(static_cast<int>(i % 7)));
+        records.push_back(xnode::value_of(ObjectType(std::move(record))));
+    }
+    return records;
+}
+
+enum field_key_kind { field_key_string, field_key_text, field_key_handle };
+
+// reads "id", "ts" & "value" of each record
+template <typename ObjectType, field_key_kind KeyKind>
+void extract_fields(size_t ops) {
+    static const xarray records = make_records<ObjectType>();
+    static const std::string id_name("id"), ts_name("ts"), value_name("value");
+    static const typename ObjectType::key_handle id_key(id_name), ts_key(ts_name), value_key(value_name);
+
+    long long sum = 0;
+    for (size_t i = 0; i < ops; i += record_count) {
+        for (size_t r = 0; r < records.size(); ++r) {
+            const ObjectType &record = *records[r].template get_ptr<ObjectType>();
+            const xnode &id = (KeyKind == field_key_string) ? record.get(id_name) :
+                              (KeyKind == field_key_text) ? record.get("id") : record.get(id_key);
+            const xnode &ts = (KeyKind == field_key_string) ? record.get(ts_name) :
+                              (KeyKind == field_key_text) ? record.get("ts") : record.get(ts_key);
+            const xnode &value = (KeyKind == field_key_string) ? record.get(value_name) :
+                                 (KeyKind == field_key_text) ? record.get("value") : record.get(value_key);
+            sum += id.get_as<int>() + ts.get_as<int>() + value.get_as<int>();
+        }
+    }
+    bench_keep(sum);
+}
+
+// object shared by threads: xobject guarded by one mutex
+struct locked_object {
+    xnode get_def(const std::string &key, const xnode &def) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return object_.get_def(key, def);
+    }
+
+    void put(const std::string &key, const xnode &value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        object_.put(key, value);
+    }
+
+    std::mutex mutex_;
+    xobject object_;
+};
+
+// ops lookups of 64 tenant keys divided between threads, each 16th operation is a put
+template <typename SharedObject, size_t ThreadCount>
+void shared_get_put(size_t ops) {
+    const std::vector<std::string> keys = make_keys(list_size, "tenant_");
+    SharedObject shared;
+    for (size_t i = 0; i < list_size; ++i)
+        shared.put(keys[i], xnode::value_of(static_cast<int>(i)));
+
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(ThreadCount, 0);
+    for (size_t t = 0; t < ThreadCount; ++t) {
+        threads.push_back(std::thread([&shared, &keys, &sums, t, ops]() {
+            const xnode missing;
+            long long sum = 0;
+            for (size_t i = t; i < ops; i += ThreadCount) {
+                const std::string &key = keys[(i * 7) % list_size];
+                if (i % 16 == 0)
+                    shared.put(key, xnode::value_of(static_cast<int>(i % list_size)));
+                else
+                    sum += shared.get_def(key, missing).template get_as<int>();
+            }
+            sums[t] = sum;
+        }));
+    }
+    for (size_t t = 0; t < ThreadCount; ++t)
+        threads[t].join();
+    bench_keep(sums);
+}
+
+const size_t column_size = 1000;
+
+// column of telemetry values built element by element, ops = number of elements
+template <bool Typed>
+void column_build(size_t ops) {
+    for (size_t i = 0; i < ops; i += column_size) {
+        if (Typed) {
+            xarray_of<double> column;
+            for (size_t j = 0; j < column_size; ++j)
+                column.push_back(static_cast<double>(j) * 0.5);
+            bench_keep(column);
+        } else {
+            xarray column;
+            for (size_t j = 0; j < column_size; ++j)
+                column.push_back(xnode::value_of(static_cast<double>(j) * 0.5));
+            bench_keep(column);
+        }
+    }
+}
+
+// sum of column elements, ops = number of elements
+template <bool Packed>
+void column_sum_nodes(size_t ops) {
+    xarray column;
+    for (size_t j = 0; j < column_size; ++j)
+        column.push_back(xnode::value_of(static_cast<double>(j) * 0.5));
+    if (!Packed)
+        column.unpack();
+    double sum = 0;
+    for (size_t i = 0; i < ops; i += column_size) {
+        for (size_t j = 0; j < column_size; ++j)
+            sum += column.node_at(j).get_as<double>();
+    }
+    bench_keep(sum);
+}
+
+void column_sum_packed(size_t ops) {
+    xarray column;
+    for (size_t j = 0; j < column_size; ++j)
+        column.push_back(xnode::value_of(static_cast<double>(j) * 0.5));
+    double sum = 0;
+    for (size_t i = 0; i < ops; i += column_size) {
+        const xarray::packed_type &values = column.packed_data();
+        for (size_t j = 0; j < column_size; ++j)
+            sum += values.get<double>(j);
+    }
+    bench_keep(sum);
+}
+
+void column_sum_typed(size_t ops) {
+    xarray_of<double> column;
+    for (size_t j = 0; j < column_size; ++j)
+        column.push_back(static_cast<double>(j) * 0.5);
+    double sum = 0;
+    for (size_t i = 0; i < ops; i += column_size) {
+        const double *values = column.data();
+        for (size_t j = 0; j < column_size; ++j)
+            sum += values[j];
+    }
+    bench_keep(sum);
+}
+
+template <typename T>
+xarray make_column(bool packed) {
+    xarray column;
+    for (size_t j = 0; j < column_size; ++j)
+        column.push_back(xnode::value_of(static_cast<T>(j % 100) * static_cast<T>(3)));
+    if (!packed)
+        column.unpack();
+    return column;
+}
+
+// rollup written with get_as per element, ops = number of elements
+template <typename T>
+void reduce_get_as(size_t ops) {
+    const xarray column = make_column<T>(false);
+    double sum = 0;
+    for (size_t i = 0; i < ops; i += column_size) {
+        for (size_t j = 0; j < column_size; ++j)
+            sum += column[j].get_as<double>();
+    }
+    bench_keep(sum);
+}
+
+template <typename T, bool Packed, int Level>
+void reduce_sum(size_t ops) {
+    const xarray column = make_column<T>(Packed);
+    int previous = xarray_simd_set_level(Level);
+    double sum = 0;
+    for (size_t i = 0; i < ops; i += column_size)
+        sum += xarray_sum(column);
+    xarray_simd_set_level(previous);
+    bench_keep(sum);
+}
+
+template <bool Packed>
+void reduce_max(size_t ops) {
+    const xarray column = make_column<int>(Packed);
+    long long result = 0;
+    for (size_t i = 0; i < ops; i += column_size)
+        result += xarray_max<long long>(column);
+    bench_keep(result);
+}
+
+const size_t log_size = 100000;
+
+// log lines appended to array, ops = number of lines
+template <typename ArrayType>
+void log_append(size_t ops) {
+    const std::string line("GET /api/v1/items 200 12ms");
+    for (size_t i = 0; i < ops; i += log_size) {
+        ArrayType lines;
+        for (size_t j = 0; j < log_size; ++j)
+            lines.push_back(xnode::value_of(line));
+        bench_keep(lines);
+    }
+}
+
+template <typename ArrayType>
+void log_iterate(size_t ops) {
+    ArrayType lines;
+    for (size_t j = 0; j < log_size; ++j)
+        lines.push_back(xnode::value_of(static_cast<int>(j)));
+    long long sum = 0;
+    for (size_t i = 0; i < ops; i += log_size) {
+        for (typename ArrayType::const_iterator it = lines.begin(), end = lines.end(); it != end; ++it)
+            sum += it->template get_as<int>();
+    }
+    bench_keep(sum);
+}
+
+typedef basic_xarray<xnode, std::allocator<xnode>, 0> heap_xarray;
+
+// short arrays (pairs, coordinates, tags) stored in node, ops = number of arrays
+template <typename ArrayType, size_t Count, bool Mixed>
+void small_array_build(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        ArrayType values;
+        for (size_t j = 0; j < Count; ++j) {
+            if (Mixed && j % 2 == 1)
+                values.push_back(xnode::value_of(static_cast<double>(j)));
+            else
+                values.push_back(xnode::value_of(static_cast<int>(j)));
+        }
+        xnode node = xnode::value_of(std::move(values));
+        bench_keep(node);
+    }
+}
+
+void array_of_nodes(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        xarray values = xarray::of(
+            xnode::value_of(42),
+            xnode::value_of(std::string("Hello World")),
+            xnode::value_of(3.14),
+            xnode::value_of(true));
+        bench_keep(values);
+    }
+}
+
+void array_of_ints(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        xarray values = xarray::of(xnode::value_of(1), xnode::value_of(2), xnode::value_of(3), xnode::value_of(4),
+                                   xnode::value_of(5), xnode::value_of(6), xnode::value_of(7), xnode::value_of(8));
+        bench_keep(values);
+    }
+}
+
+#if __cplusplus >= 201703L
+void array_of_values(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        xarray values = xarray::of(42, std::string("Hello World"), 3.14, true);
+        bench_keep(values);
+    }
+}
+#endif
+
+}
+
+BENCH_SUITE(tree) {
+    const size_t ops = 20000;
+
+    context.run("copy xobject/xarray tree", ops, copy_tree<xnode>);
+    context.run("copy xobject/xarray tree, cow", ops, copy_tree<xnode_cow>);
+    context.run("move xobject/xarray tree", ops * 100, move_tree<xnode>);
+}
+
+BENCH_SUITE(property_list) {
+    const size_t ops = 1000000;
+
+    context.run("put x64 (hash)", ops, list_put<hash_object>);
+    context.run("put x64 (flat)", ops, list_put<flat_object>);
+    context.run("get of 64 (hash)", ops, list_get<hash_object>);
+    context.run("get of 64 (flat)", ops, list_get<flat_object>);
+    context.run("get of 64 (frozen)", ops, list_get<frozen_xobject>);
+    context.run("put + remove of 64 (hash)", ops, list_put_remove<hash_object>);
+    context.run("put + remove of 64 (flat)", ops, list_put_remove<flat_object>);
+    context.run("put x64, remove half, reorg (hash)", ops / list_size, list_remove_reorg<hash_object>);
+    context.run("put x64, remove half, reorg (flat)", ops / list_size, list_remove_reorg<flat_object>);
+    context.run("get_values of 64 (hash)", ops, list_iterate<hash_object>);
+    context.run("get_values of 64 (flat)", ops, list_iterate<flat_object>);
+    context.run("build 64 fields, put (hash)", ops, list_build<hash_object, false>);
+    context.run("build 64 fields, put_all (hash)", ops, list_build<hash_object, true>);
+    context.run("build 64 fields, put (flat)", ops, list_build<flat_object, false>);
+    context.run("build 64 fields, put_all (flat)", ops, list_build<flat_object, true>);
+    context.run("remove + put + iterate 64 keys (hash)", ops, list_remove_iterate<hash_object>);
+    context.run("remove + put + iterate 64 keys (flat)", ops, list_remove_iterate<flat_object>);
+    context.run("get by text slice, std::string key", ops, list_get_text<false>);
+    context.run("get by text slice, property_list_key_ref", ops, list_get_text<true>);
+}
+
+BENCH_SUITE(typed_array) {
+    const size_t ops = 2000000;
+
+    context.run("build column of 1000 doubles (xarray)", ops, column_build<false>);
+    context.run("build column of 1000 doubles (xarray_of)", ops, column_build<true>);
+    context.run("sum column of 1000 doubles (xarray, unpacked)", ops, column_sum_nodes<false>);
+    context.run("sum column of 1000 doubles (xarray, packed, node_at)", ops, column_sum_nodes<true>);
+    context.run("sum column of 1000 doubles (xarray, packed_data)", ops, column_sum_packed);
+    context.run("sum column of 1000 doubles (xarray_of)", ops, column_sum_typed);
+}
+
+BENCH_SUITE(reduce) {
+    const size_t ops = 4000000;
+
+    context.run("sum 1000 doubles, get_as loop", ops, reduce_get_as<double>);
+    context.run("sum 1000 doubles, xarray_sum (nodes)", ops, reduce_sum<double, false, xarray_simd_avx2>);
+    context.run("sum 1000 doubles, xarray_sum (packed, scalar)", ops, reduce_sum<double, true, xarray_simd_scalar>);
+    context.run("sum 1000 doubles, xarray_sum (packed, sse2)", ops, reduce_sum<double, true, xarray_simd_sse2>);
+    context.run("sum 1000 doubles, xarray_sum (packed, avx2)", ops, reduce_sum<double, true, xarray_simd_avx2>);
+    context.run("sum 1000 ints, get_as loop", ops, reduce_get_as<int>);
+    context.run("sum 1000 ints, xarray_sum (nodes)", ops, reduce_sum<int, false, xarray_simd_avx2>);
+    context.run("sum 1000 ints, xarray_sum (packed, scalar)", ops, reduce_sum<int, true, xarray_simd_scalar>);
+    context.run("sum 1000 ints, xarray_sum (packed, avx2)", ops, reduce_sum<int, true, xarray_simd_avx2>);
+    context.run("max of 1000 ints, xarray_max (nodes)", ops, reduce_max<false>);
+    context.run("max of 1000 ints, xarray_max (packed)", ops, reduce_max<true>);
+}
+
+BENCH_SUITE(segmented_array) {
+    const size_t ops = 2000000;
+
+    context.run("append 100000 text nodes (xarray)", ops, log_append<xarray>);
+    context.run("append 100000 text nodes (segmented_xarray)", ops, log_append<segmented_xarray>);
+    context.run("iterate 100000 nodes (xarray)", ops * 5, log_iterate<xarray>);
+    context.run("iterate 100000 nodes (segmented_xarray)", ops * 5, log_iterate<segmented_xarray>);
+}
+
+BENCH_SUITE(small_array) {
+    const size_t ops = 2000000;
+
+    context.run("node with 0 ints (inline 0)", ops, small_array_build<heap_xarray, 0, false>);
+    context.run("node with 0 ints (inline 4)", ops, small_array_build<xarray, 0, false>);
+    context.run("node with 1 int (inline 0)", ops, small_array_build<heap_xarray, 1, false>);
+    context.run("node with 1 int (inline 4)", ops, small_array_build<xarray, 1, false>);
+    context.run("node with 2 ints (inline 0)", ops, small_array_build<heap_xarray, 2, false>);
+    context.run("node with 2 ints (inline 4)", ops, small_array_build<xarray, 2, false>);
+    context.run("node with 4 ints (inline 0)", ops, small_array_build<heap_xarray, 4, false>);
+    context.run("node with 4 ints (inline 4)", ops, small_array_build<xarray, 4, false>);
+    context.run("node with 8 ints (inline 0)", ops, small_array_build<heap_xarray, 8, false>);
+    context.run("node with 8 ints (inline 4)", ops, small_array_build<xarray, 8, false>);
+    context.run("node with 16 ints (inline 0)", ops, small_array_build<heap_xarray, 16, false>);
+    context.run("node with 16 ints (inline 4)", ops, small_array_build<xarray, 16, false>);
+    context.run("node with 2 int/double nodes (inline 0)", ops, small_array_build<heap_xarray, 2, true>);
+    context.run("node with 2 int/double nodes (inline 4)", ops, small_array_build<xarray, 2, true>);
+    context.run("node with 4 int/double nodes (inline 0)", ops, small_array_build<heap_xarray, 4, true>);
+    context.run("node with 4 int/double nodes (inline 4)", ops, small_array_build<xarray, 4, true>);
+    context.run("node with 8 int/double nodes (inline 0)", ops, small_array_build<heap_xarray, 8, true>);
+    context.run("node with 8 int/double nodes (inline 4)", ops, small_array_build<xarray, 8, true>);
+}
+
+BENCH_SUITE(shared_object) {
+    const size_t ops = 1000000;
+
+    context.run("get/put of 64 keys, 1 thread (mutex + xobject)", ops, shared_get_put<locked_object, 1>);
+    context.run("get/put of 64 keys, 1 thread (concurrent_xobject)", ops, shared_get_put<concurrent_xobject, 1>);
+    context.run("get/put of 64 keys, 4 threads (mutex + xobject)", ops, shared_get_put<locked_object, 4>);
+    context.run("get/put of 64 keys, 4 threads (concurrent_xobject)", ops, shared_get_put<concurrent_xobject, 4>);
+}
+
+BENCH_SUITE(object_fields) {
+    const size_t ops = 200000;
+
+    run_object_fields<1>(context, ops);
+    run_object_fields<2>(context, ops);
+    run_object_fields<4>(context, ops);
+    run_object_fields<8>(context, ops);
+    run_object_fields<16>(context, ops / 2);
+    run_object_fields<32>(context, ops / 4);
+    run_object_fields<64>(context, ops / 8);
+}
+
+BENCH_SUITE(field_extract) {
+    const size_t ops = 2000000;
+
+    context.run("3 fields of records, std::string key", ops, extract_fields<xobject, field_key_string>);
+    context.run("3 fields of records, const char * key", ops, extract_fields<xobject, field_key_text>);
+    context.run("3 fields of records, key_handle", ops, extract_fields<xobject, field_key_handle>);
+    context.run("3 fields of shaped records, std::string key", ops, extract_fields<xobject_shaped, field_key_string>);
+    context.run("3 fields of shaped records, key_handle", ops, extract_fields<xobject_shaped, field_key_handle>);
+    context.run("3 fields of frozen records, std::string key", ops, extract_fields<frozen_xobject, field_key_string>);
+    context.run("3 fields of frozen records, key_handle", ops, extract_fields<frozen_xobject, field_key_handle>);
+}
+
+BENCH_SUITE(xarray_of) {
+    const size_t ops = 1000000;
+
+    context.run("of(4 mixed nodes)", ops, array_of_nodes);
+    context.run("of(8 int nodes)", ops, array_of_ints);
+#if __cplusplus >= 201703L
+    context.run("of(4 mixed values)", ops, array_of_values);
+#endif
+}
@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_conversion_bench.cpp
+// Purpose:     Benchmark of every pair from conversion matrix: caster switch vs table
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include <cstdio>
+#include <string>
+#include "bench_util.h"
+
+using namespace std;
+
+namespace {
+
+template <typename T>
+struct sample {
+    static T value() { return static_cast<T>(1); }
+};
+
+template <>
+struct sample<std::string> {
+    static std::string value() { return "1"; }
+};
+
+template <typename T> const char *type_name();
+template <> const char *type_name<bool>() { return "bool"; }
+template <> const char *type_name<float>() { return "float"; }
+template <> const char *type_name<double>() { return "double"; }
+template <> const char *type_name<char>() { return "char"; }
+template <> const char *type_name<short>() { return "short"; }
+template <> const char *type_name<int>() { return "int"; }
+template <> const char *type_name<long>() { return "long"; }
+template <> const char *type_name<long long>() { return "long long"; }
+template <> const char *type_name<unsigned char>() { return "uchar"; }
+template <> const char *type_name<unsigned short>() { return "ushort"; }
+template <> const char *type_name<unsigned int>() { return "uint"; }
+template <> const char *type_name<unsigned long>() { return "ulong"; }
+template <> const char *type_name<unsigned long long>() { return "ullong"; }
+template <> const char *type_name<std::string>() { return "string"; }
+
+// storage of source value in form used by casters
+template <typename T>
+struct source_slot {
+    source_slot() { xnode_set_scalar<T>(&slot, sample<T>::value()); }
+    void *slot;
+};
+
+template <>
+struct source_slot<std::string> {
+    source_slot() : text(sample<std::string>::value()), slot(&text) {}
+    std::string text;
+    void *slot;
+};
+
+template <typename Dest, typename Src, bool UseTable>
+void convert_loop(size_t ops) {
+    source_slot<Src> src;
+    // type code is not known at compile time, as in real node
+    volatile int codeHolder = xnode_type_code<Src>::value;
+    int code = codeHolder;
+    Dest output = Dest();
+    size_t converted = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        bool ok = UseTable ?
+            xnode_cast_row<Dest, xnode_def_cast_policy>::cast_to_value(output, &src.slot, code) :
+            xnode_caster<Dest, xnode_def_cast_policy>::cast_to_value(output, &src.slot, code);
+        if (ok)
+            ++converted;
+        bench_keep(output);
+    }
+    bench_keep(converted);
+}
+
+// source of mixed numeric types, as in heterogeneous document,
+// string is left out because parsing cost would hide dispatch cost
+struct mixed_source {
+    void *slots[13];
+    int codes[13];
+
+    mixed_source() {
+        size_t pos = 0;
+        add<bool>(pos); add<float>(pos); add<double>(pos); add<char>(pos); add<short>(pos);
+        add<int>(pos); add<long>(pos); add<long long>(pos); add<unsigned char>(pos);
+        add<unsigned short>(pos); add<unsigned int>(pos); add<unsigned long>(pos);
+        add<unsigned long long>(pos);
+    }
+
+    template <typename T>
+    void add(size_t &pos) {
+        xnode_set_scalar<T>(&slots[pos], sample<T>::value());
+        codes[pos] = xnode_type_code<T>::value;
+        ++pos;
+    }
+};
+
+template <typename Dest, bool UseTable>
+void convert_mixed_loop(size_t ops) {
+    mixed_source src;
+    Dest output = Dest();
+    size_t converted = 0;
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < ops; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        size_t idx = (seed >> 16) % 13;
+        bool ok = UseTable ?
+            xnode_cast_row<Dest, xnode_def_cast_policy>::cast_to_value(output, &src.slots[idx], src.codes[idx]) :
+            xnode_caster<Dest, xnode_def_cast_policy>::cast_to_value(output, &src.slots[idx], src.codes[idx]);
+        if (ok)
+            ++converted;
+        bench_keep(output);
+    }
+    bench_keep(converted);
+}
+
+template <typename Dest, typename Src>
+int bench_pair(bench_context &context, size_t ops) {
+    std::string name = std::string(type_name<Src>()) + " -> " + type_name<Dest>();
+    context.run(name + " (switch)", ops, convert_loop<Dest, Src, false>);
+    context.run(name + " (table)", ops, convert_loop<Dest, Src, true>);
+    return 0;
+}
+
+template <typename Dest, typename... Srcs>
+void bench_row(bench_context &context, size_t ops) {
+    int dummy[] = { bench_pair<Dest, Srcs>(context, ops)... };
+    (void)dummy;
+
+    std::string name = std::string("mixed num -> ") + type_name<Dest>();
+    context.run(name + " (switch)", ops, convert_mixed_loop<Dest, false>);
+    context.run(name + " (table)", ops, convert_mixed_loop<Dest, true>);
+}
+
+template <typename... Types>
+struct bench_matrix {
+    static void run(bench_context &context, size_t ops) {
+        int dummy[] = { (bench_row<Types, Types...>(context, ops), 0)... };
+        (void)dummy;
+    }
+};
+
+}
+
+BENCH_SUITE(conversion) {
+    const size_t ops = 500000;
+
+    bench_matrix<bool, float, double, char, short, int, long, long long,
+                 unsigned char, unsigned short, unsigned int, unsigned long, unsigned long long,
+                 std::string>::run(context, ops);
+}
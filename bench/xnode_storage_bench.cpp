@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_storage_bench.cpp
+// Purpose:     Benchmark of value storage classes
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xnode_compact.h"
+#include "xnode_memory.h"
+#include <vector>
+#include "bench_util.h"
+
+using namespace std;
+
+namespace {
+
+typedef basic_xnode<xnode_inline_value_policy<sizeof(std::string)> > xnode_inl;
+
+struct point3 {
+    double x, y, z;
+};
+
+template <typename NodeType>
+void set_short_strings(size_t ops) {
+    const std::string text("short text");
+    NodeType node;
+    for (size_t i = 0; i < ops; ++i) {
+        node.set_as(text);
+        bench_keep(node);
+    }
+}
+
+template <typename NodeType>
+void build_string_leaves(size_t ops) {
+    const std::string keys[] = { "id", "name", "value", "timestamp" };
+    std::vector<NodeType> leaves;
+    leaves.reserve(ops);
+    for (size_t i = 0; i < ops; ++i)
+        leaves.push_back(NodeType::value_of(keys[i % 4]));
+    bench_keep(leaves);
+}
+
+template <typename NodeType>
+void copy_string_leaves(size_t ops) {
+    std::vector<NodeType> leaves(1000, NodeType::value_of(std::string("leaf")));
+    for (size_t i = 0; i < ops / leaves.size() + 1; ++i) {
+        std::vector<NodeType> copy(leaves);
+        bench_keep(copy);
+    }
+}
+
+template <typename NodeType>
+void build_struct_leaves(size_t ops) {
+    point3 pt = { 1.0, 2.0, 3.0 };
+    std::vector<NodeType> leaves;
+    leaves.reserve(ops);
+    for (size_t i = 0; i < ops; ++i)
+        leaves.push_back(NodeType::value_of(pt));
+    bench_keep(leaves);
+}
+
+template <typename NodeType>
+void build_double_array(size_t ops) {
+    std::vector<NodeType> values;
+    values.reserve(ops);
+    for (size_t i = 0; i < ops; ++i)
+        values.push_back(NodeType::value_of(static_cast<double>(i) * 0.5));
+    bench_keep(values);
+}
+
+template <typename NodeType>
+void sum_double_array(size_t ops) {
+    std::vector<NodeType> values(4096, NodeType::value_of(1.5));
+    double sum = 0.0;
+    for (size_t i = 0; i < ops; ++i)
+        sum += values[i % values.size()].template get_as<double>();
+    bench_keep(sum);
+}
+
+// set_as followed by get_as of the same type, storage class depends on node & value type
+template <typename NodeType, typename T>
+struct set_get_loop {
+    explicit set_get_loop(const T &value) : value_(value) {}
+
+    void operator()(size_t ops) const {
+        NodeType node;
+        size_t found = 0;
+        for (size_t i = 0; i < ops; ++i) {
+            node.set_as(value_);
+            if (node.template get_as<T>() == value_)
+                ++found;
+            bench_keep(node);
+        }
+        bench_keep(found);
+    }
+
+    T value_;
+};
+
+template <typename NodeType, typename T>
+set_get_loop<NodeType, T> set_get(const T &value) {
+    return set_get_loop<NodeType, T>(value);
+}
+
+}
+
+BENCH_SUITE(storage) {
+    const size_t ops = 1000000;
+    static int target = 5;
+    const std::string text("short text");
+
+    context.run("set_as/get_as int, casted", ops, set_get<xnode>(5));
+    context.run("set_as/get_as int*, pointer", ops, set_get<xnode>(&target));
+    context.run("set_as/get_as string, owned", ops, set_get<xnode>(text));
+    context.run("set_as/get_as string, inline", ops, set_get<xnode_inl>(text));
+    context.run("set_as/get_as string, allocated", ops, set_get<xnode_pmr>(text));
+    context.run("set_as/get_as string, shared", ops, set_get<xnode_cow>(text));
+    context.run("set_as/get_as double, compact", ops, set_get<xnode_compact>(2.5));
+
+    context.run("set_as(string) owned", ops, set_short_strings<xnode>);
+    context.run("set_as(string) inline", ops, set_short_strings<xnode_inl>);
+    context.run("build string leaves owned", ops, build_string_leaves<xnode>);
+    context.run("build string leaves inline", ops, build_string_leaves<xnode_inl>);
+    context.run("copy string leaves x1000 owned", ops, copy_string_leaves<xnode>);
+    context.run("copy string leaves x1000 inline", ops, copy_string_leaves<xnode_inl>);
+    context.run("build struct leaves owned", ops, build_struct_leaves<xnode>);
+    context.run("build struct leaves inline", ops, build_struct_leaves<xnode_inl>);
+    context.run("build double array xnode", ops, build_double_array<xnode>);
+    context.run("build double array compact", ops, build_double_array<xnode_compact>);
+    context.run("sum double array xnode", ops, sum_double_array<xnode>);
+    context.run("sum double array compact", ops, sum_double_array<xnode_compact>);
+}
@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_type_check_bench.cpp
+// Purpose:     Benchmark of type checks and same-type reads
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include <vector>
+#include "bench_util.h"
+
+using namespace std;
+
+namespace {
+
+struct custom_value {
+    int a;
+    int b;
+};
+
+// input is mixed, so that branch predictor does not hide the cost of failed checks
+std::vector<xnode> make_input() {
+    std::vector<xnode> result;
+    custom_value cv = { 1, 2 };
+    for (int i = 0; i < 1024; ++i) {
+        switch (i % 4) {
+        case 0: result.push_back(xnode::value_of(i)); break;
+        case 1: result.push_back(xnode::value_of(static_cast<double>(i))); break;
+        case 2: result.push_back(xnode::value_of(std::string("text"))); break;
+        default: result.push_back(xnode::value_of(cv)); break;
+        }
+    }
+    return result;
+}
+
+template <typename T>
+void typeid_check(size_t ops) {
+    std::vector<xnode> input = make_input();
+    size_t found = 0;
+    for (size_t i = 0; i < ops; ++i)
+        if (input[i & 1023].type() == typeid(T))
+            ++found;
+    bench_keep(found);
+}
+
+template <typename T>
+void is_check(size_t ops) {
+    std::vector<xnode> input = make_input();
+    size_t found = 0;
+    for (size_t i = 0; i < ops; ++i)
+        if (input[i & 1023].is<T>())
+            ++found;
+    bench_keep(found);
+}
+
+void get_as_same_type(size_t ops) {
+    std::vector<xnode> input(1024, xnode::value_of(5));
+    long long sum = 0;
+    for (size_t i = 0; i < ops; ++i)
+        sum += input[i & 1023].get_as<int>();
+    bench_keep(sum);
+}
+
+void get_ptr_same_type(size_t ops) {
+    std::vector<xnode> input(1024, xnode::value_of(std::string("text")));
+    size_t len = 0;
+    for (size_t i = 0; i < ops; ++i)
+        len += input[i & 1023].get_ptr<std::string>()->size();
+    bench_keep(len);
+}
+
+void is_null_check(size_t ops) {
+    std::vector<xnode> input = make_input();
+    input[5].reset();
+    size_t found = 0;
+    for (size_t i = 0; i < ops; ++i)
+        if (input[i & 1023].is_null())
+            ++found;
+    bench_keep(found);
+}
+
+}
+
+BENCH_SUITE(type_check) {
+    const size_t ops = 20000000;
+
+    context.run("typeid(T) == type(), T = int", ops, typeid_check<int>);
+    context.run("is<T>(), T = int", ops, is_check<int>);
+    context.run("typeid(T) == type(), T = custom", ops, typeid_check<custom_value>);
+    context.run("is<T>(), T = custom", ops, is_check<custom_value>);
+    context.run("is_null()", ops, is_null_check);
+    context.run("get_as<int>() same type", ops, get_as_same_type);
+    context.run("get_ptr<string>() same type", ops, get_ptr_same_type);
+}
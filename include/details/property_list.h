@@ -9,31 +9,54 @@
 #ifndef __PROP_LIST_H__
 #define __PROP_LIST_H__
 
-#include <unordered_map>
 #include <vector>
-#include <set>
 #include <string>
 #include <stdexcept>
+#include <memory>
+#include <functional>
+#include <iterator>
 
 #include "xnode_utils.h"
+#include "property_list_hash.h"
+#include "property_list_flat.h"
+#include "property_list_small.h"
+#include "property_list_shape.h"
+#include "property_list_frozen.h"
+
+/// selects value kept by property_list::merge when both lists contain a key
+enum property_list_merge_policy {
+	property_list_merge_replace, // value of merged list replaces existing value
+	property_list_merge_keep     // existing value is kept
+};
 
 /// key-value pair container where key is unique
 /// container supports reading in insert order
 /// reading & deleting by key has O(1) complexity
-/// value is stored in just one place
-template<typename KeyType, typename ValueType>
+/// StoragePolicy selects layout of items:
+/// - property_list_hash_storage (default): key vector + std::unordered_map, one node per item, values keep their addresses,
+///   first ordered access after remove rebuilds key vector
+/// - property_list_flat_storage: single block with ordered entries & open addressing index, each key stored once,
+///   removed entries are skipped by iterators and compacted when they exceed 1/3 of entries
+/// - property_list_small_storage<N>: up to N entries inside of the list, promoted to flat storage when it grows
+/// - property_list_shape_storage: keys in a shape shared between lists, list holds only values
+/// - property_list_frozen_storage: read-only entries with perfect hash, created by freeze(), items can't be added or removed
+/// Allocator is rebound for storage
+template<typename KeyType, typename ValueType, typename Allocator = std::allocator<ValueType>, typename StoragePolicy = property_list_hash_storage>
 class property_list {
-	typedef std::vector<KeyType> key_container_type;
-	typedef std::unordered_map<KeyType, ValueType> value_container_type;
 public:
-	typedef std::vector<KeyType> key_list_type;
-    typedef property_list<KeyType, ValueType> this_type;
+	typedef property_list_storage<KeyType, ValueType, Allocator, StoragePolicy> storage_type;
+	typedef Allocator allocator_type;
+	typedef StoragePolicy storage_policy;
+	typedef typename storage_type::key_list_type key_list_type;
+    typedef property_list<KeyType, ValueType, Allocator, StoragePolicy> this_type;
     
     // Iterator typedefs
-    typedef typename key_container_type::iterator key_iterator;
-    typedef typename key_container_type::const_iterator key_const_iterator;
-    typedef typename value_container_type::iterator value_iterator;
-    typedef typename value_container_type::const_iterator value_const_iterator;
+    typedef typename storage_type::key_iterator key_iterator;
+    typedef typename storage_type::key_const_iterator key_const_iterator;
+    typedef typename storage_type::value_iterator value_iterator;
+    typedef typename storage_type::value_const_iterator value_const_iterator;
+    /// key with precalculated hash for repeated lookups in many lists, see property_list_key_handle
+    typedef property_list_key_handle<KeyType> key_handle;
 
     // Static factory methods
     static this_type of(const KeyType& k1, const ValueType& v1) {
@@ -186,38 +209,23 @@ public:
         return result;
     }
 
-	property_list() : dirty_keys_(false) {}
+	property_list() {}
 
-    property_list(const property_list &src):
-        dirty_keys_(src.dirty_keys_),
-        keys_(src.keys_),
-        values_(src.values_)
+    explicit property_list(const allocator_type &alloc) :
+        storage_(alloc)
     {
 
     }
 
-    property_list(property_list &&src) :
-        dirty_keys_(src.dirty_keys_),
-        keys_(std::move(src.keys_)),
-        values_(std::move(src.values_))
-    {
-
+    /// copies items of list with another storage policy in order of insertion
+    template<typename SourcePolicy>
+    explicit property_list(const property_list<KeyType, ValueType, Allocator, SourcePolicy> &src) {
+        property_list_copy_items(storage_, src.storage());
     }
 
-    property_list& operator=(const property_list &rhs)
-    {
-        dirty_keys_ = rhs.dirty_keys_;
-        keys_ = rhs.keys_;
-        values_ = rhs.values_;
-        return *this;
-    }
-
-    property_list& operator=(property_list &&rhs)
-    {
-        dirty_keys_ = rhs.dirty_keys_;
-        keys_ = std::move(rhs.keys_);
-        values_ = std::move(rhs.values_);
-        return *this;
+    /// returns read-only copy of list, lookup without probing (see property_list_frozen.h)
+    property_list<KeyType, ValueType, Allocator, property_list_frozen_storage> freeze() const {
+        return property_list<KeyType, ValueType, Allocator, property_list_frozen_storage>(*this);
     }
 
     bool operator==(const this_type &rhs) const
@@ -225,236 +233,314 @@ public:
         if (this == &rhs)
             return true;
 
-        if (
-            (values_ == rhs.values_)
-            &&
-            (keys_ == rhs.keys_)
-            )
-        {
-            return true;
-        }
-        else {
-            return false;
-        }
+        return storage_ == rhs.storage_;
     }
 
     /// inserts value in storage, if key already exists, old value will be replaced
     /// returns true if item was already there
 	bool put(const KeyType &key, const ValueType &value) {
-		typename value_container_type::iterator found = values_.find(key);
-        bool notFound = (found == values_.end());
-        if (notFound) {
-			keys_.push_back(key);
-		}
-		values_[key] = value;
-        return !notFound;
+		return storage_.put(key, value);
 	}
 
     /// inserts value in storage, if key already exists, old value will be replaced
     /// returns true if item was already there
 	bool put(const KeyType &key, ValueType &&value) {
-		typename value_container_type::iterator found = values_.find(key);
-        bool notFound = (found == values_.end());
-        if (notFound) {
-			keys_.push_back(key);
-            values_.insert({ key, value });
-        }
-        else {
-            found->second = value;
-        }
-        return !notFound;
+		return storage_.put(key, std::move(value));
+	}
+
+    /// inserts value in storage, key is moved into storage if it is not there yet
+    /// returns true if item was already there
+	bool put(KeyType &&key, const ValueType &value) {
+		return storage_.put(std::move(key), value);
+	}
+
+	bool put(KeyType &&key, ValueType &&value) {
+		return storage_.put(std::move(key), std::move(value));
 	}
 
+    /// inserts value constructed in place from args, if key already exists, old value will be replaced
+    /// returns true if item was already there
+    template<typename... Args>
+    bool emplace(const KeyType &key, Args &&... args) {
+        return storage_.put(key, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    bool emplace(KeyType &&key, Args &&... args) {
+        return storage_.put(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /// inserts items from range of pairs (it->first, it->second) in order, storage is prepared once
+    /// for forward ranges
+    template<typename InputIterator>
+    void put_all(InputIterator first, InputIterator last) {
+        reserve_for(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+        for (; first != last; ++first)
+            storage_.put(first->first, first->second);
+    }
+
+    /// moves all items of src to this list in order of src, src is left empty
+    /// for keys contained in both lists policy selects which value is kept
+    void merge(this_type &&src, property_list_merge_policy policy = property_list_merge_replace) {
+        if (&src == this)
+            return;
+        reserve(size() + src.size());
+        this_type &target = *this;
+        src.storage_.for_each([&target, policy](const KeyType &key, ValueType &value) {
+            if (policy == property_list_merge_keep && target.contains(key))
+                return;
+            target.storage_.put(key, std::move(value));
+        });
+        src.clear();
+    }
+
+    /// prepares storage for a given number of items, so that they can be added without rehashing
+    void reserve(size_t count) {
+        storage_.reserve(count);
+    }
+
     /// returns value selected by key
     /// throws error if key not found
 	ValueType &get(const KeyType &key) {
-		typename value_container_type::iterator found = values_.find(key);
-		if (found == values_.end()) {
+		ValueType *found = storage_.find(key);
+		if (found == nullptr) {
 			throwNotFound(key);
 		}
-		return found->second;
+		return *found;
 	}
 
     /// returns value selected by key
     /// throws error if key not found
 	const ValueType &get(const KeyType &key) const {
-		typename value_container_type::const_iterator found = values_.find(key);
-		if (found == values_.end()) {
+		const ValueType *found = storage_.find(key);
+		if (found == nullptr) {
 			throwNotFound(key);
 		}
-		return found->second;
+		return *found;
 	}
 
     /// returns value selected by key
     /// returns provided default value if key not found
 	const ValueType get_def(const KeyType &key, const ValueType &defValue) const {
-		typename value_container_type::const_iterator found = values_.find(key);
-		if (found == values_.end()) {
+		const ValueType *found = storage_.find(key);
+		if (found == nullptr) {
             return defValue;
 		}
-		return found->second;
+		return *found;
 	}
 
     /// returns value selected by key
     /// throws error if key not found
 	ValueType &get(const KeyType &key, ValueType &output) const {
-		typename value_container_type::iterator found = values_.find(key);
-		if (found == values_.end()) {
-			throwNotFound(key);
-		}
-      	output = *found;
+		output = get(key);
 		return output;
 	}
 
     /// returns pointer to value selected by key
     /// returns null if value not found
 	ValueType *get_ptr(const KeyType &key) {
-		typename value_container_type::iterator found = values_.find(key);
-		if (found != values_.end()) {
-			return &(found->second);
-		}
-		else {
-			return nullptr;
-		}
+		return storage_.find(key);
 	}
 
     /// removes value selected by key
 	void remove(const KeyType &key) {
-		typename value_container_type::iterator found = values_.find(key);
-		if (found != values_.end()) {
-			values_.erase(found);
-			dirty_keys_ = true;
+		storage_.remove(key);
+	}
+
+    /// lookup by key handle, hash of key is not calculated again
+    /// throws error if key not found
+	ValueType &get(const key_handle &key) {
+		ValueType *found = storage_.find(key);
+		if (found == nullptr) {
+			throwNotFound(key.key());
 		}
+		return *found;
+	}
+
+	const ValueType &get(const key_handle &key) const {
+		const ValueType *found = storage_.find(key);
+		if (found == nullptr) {
+			throwNotFound(key.key());
+		}
+		return *found;
+	}
+
+	const ValueType get_def(const key_handle &key, const ValueType &defValue) const {
+		const ValueType *found = storage_.find(key);
+		if (found == nullptr) {
+            return defValue;
+		}
+		return *found;
+	}
+
+	ValueType *get_ptr(const key_handle &key) {
+		return storage_.find(key);
+	}
+
+	bool contains(const key_handle &key) const {
+		return storage_.find(key) != nullptr;
 	}
 
+    /// lookup by text of key without constructing std::string key:
+    /// Text is const char *, std::string_view (C++17) or property_list_key_ref (pointer + length)
+    template<typename Text>
+    typename property_list_text_lookup<KeyType, Text, ValueType &>::type get(const Text &key) {
+        ValueType *found = storage_.find(property_list_key_ref(key));
+        if (found == nullptr) {
+            throwNotFound(property_list_key_ref(key).str());
+        }
+        return *found;
+    }
+
+    template<typename Text>
+    typename property_list_text_lookup<KeyType, Text, const ValueType &>::type get(const Text &key) const {
+        const ValueType *found = storage_.find(property_list_key_ref(key));
+        if (found == nullptr) {
+            throwNotFound(property_list_key_ref(key).str());
+        }
+        return *found;
+    }
+
+    template<typename Text>
+    typename property_list_text_lookup<KeyType, Text, const ValueType>::type get_def(const Text &key, const ValueType &defValue) const {
+        const ValueType *found = storage_.find(property_list_key_ref(key));
+        if (found == nullptr) {
+            return defValue;
+        }
+        return *found;
+    }
+
+    template<typename Text>
+    typename property_list_text_lookup<KeyType, Text, ValueType *>::type get_ptr(const Text &key) {
+        return storage_.find(property_list_key_ref(key));
+    }
+
+    template<typename Text>
+    typename property_list_text_lookup<KeyType, Text, bool>::type contains(const Text &key) const {
+        return storage_.find(property_list_key_ref(key)) != nullptr;
+    }
+
+    template<typename Text>
+    typename property_list_text_lookup<KeyType, Text, void>::type remove(const Text &key) {
+        storage_.remove(property_list_key_ref(key));
+    }
+
     /// removes all items stored in container
 	void clear() {
-		values_.clear();
-		keys_.clear();
-		dirty_keys_ = false;
+		storage_.clear();
 	}
 
     /// returns number of stored values
 	size_t size() const {
-		return values_.size();
+		return storage_.size();
 	}
 
     /// returns true if there are no values in the storage
 	bool empty() const {
-		return values_.empty();
+		return storage_.size() == 0;
 	}
 
     /// returns true if reorg is needed to be executed
     bool needs_reorg() const {
-        return dirty_keys_;
+        return storage_.needs_reorg();
     }
 
     /// reorganize structure after heavy changes
 	void reorg() {
-		if (dirty_keys_)
-			purge_keys();
+		storage_.reorg();
 	}
 
     /// returns true if container holds value for a given key
 	bool contains(const KeyType &key) const {
-		typename value_container_type::const_iterator found = values_.find(key);
-		return found != values_.end();
+		return storage_.find(key) != nullptr;
 	}
 
 	/// return keys in order of insertion
 	key_list_type get_keys() {
-		if (dirty_keys_)
-			purge_keys();
-		key_list_type result(keys_);
+		key_list_type result;
+		const key_list_type &keys = storage_.get_keys(result);
+		if (&keys != &result)
+			result = keys;
 		return result;
 	}
 
 	/// return keys in order of insertion
     /// param[in] helper, buffer optionally to be used
-    /// return reference to key storage
-	const key_list_type &get_keys(key_list_type &/* helper */) {
-		if (dirty_keys_)
-			purge_keys();
-		return keys_;
+    /// return reference to key storage or to helper
+	const key_list_type &get_keys(key_list_type &helper) {
+		return storage_.get_keys(helper);
 	}
 
 	/// return values in order of insertion
 	std::vector<ValueType> get_values() {
 		std::vector<ValueType> result;
-		if (dirty_keys_)
-			purge_keys();
-		for (KeyType key : keys_)
-			result.push_back(values_[key]);
+		result.reserve(size());
+		storage_.for_each([&result](const KeyType &, const ValueType &value) {
+			result.push_back(value);
+		});
 		return result;
 	}
 
     /// returns iterator to the beginning of keys container
     key_iterator keys_begin() {
-        if (dirty_keys_)
-            purge_keys();
-        return keys_.begin();
+        return storage_.keys_begin();
     }
 
     /// returns iterator to the end of keys container
     key_iterator keys_end() {
-        return keys_.end();
+        return storage_.keys_end();
     }
 
     /// returns const_iterator to the beginning of keys container
     key_const_iterator keys_cbegin() const {
-        if (dirty_keys_)
-            purge_keys();
-        return keys_.cbegin();
+        return storage_.keys_cbegin();
     }
 
     /// returns const_iterator to the end of keys container
     key_const_iterator keys_cend() const {
-        return keys_.cend();
+        return storage_.keys_cend();
     }
 
     /// returns iterator to the beginning of values container
     value_iterator values_begin() {
-        return values_.begin();
+        return storage_.values_begin();
     }
 
     /// returns iterator to the end of values container
     value_iterator values_end() {
-        return values_.end();
+        return storage_.values_end();
     }
 
     /// returns const_iterator to the beginning of values container
     value_const_iterator values_cbegin() const {
-        return values_.cbegin();
+        return storage_.values_cbegin();
     }
 
     /// returns const_iterator to the end of values container
     value_const_iterator values_cend() const {
-        return values_.cend();
+        return storage_.values_cend();
+    }
+
+    /// returns storage of items, for operations specific to storage policy
+    const storage_type &storage() const {
+        return storage_;
     }
 
 protected:
-	void purge_keys() const {
-		key_container_type new_keys;
-		for (const KeyType& key : keys_) {
-			if (values_.find(key) != values_.end())
-				new_keys.push_back(key);
-		}
-		// Cast away const to update the member variables
-		// This is safe because we're maintaining logical constness
-		key_container_type& keys_nonconst = const_cast<key_container_type&>(keys_);
-		bool& dirty_keys_nonconst = const_cast<bool&>(dirty_keys_);
-		
-		keys_nonconst = std::move(new_keys);
-		dirty_keys_nonconst = false;
-	}
+    template<typename ForwardIterator>
+    void reserve_for(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag) {
+        reserve(size() + static_cast<size_t>(std::distance(first, last)));
+    }
+
+    template<typename InputIterator>
+    void reserve_for(InputIterator, InputIterator, std::input_iterator_tag) {
+    }
 
 	void throwNotFound(const KeyType &key) const {
 		throw std::runtime_error("key not found: " + to_string(key));
 	}
 private:
-	bool dirty_keys_;
-	key_container_type keys_;
-	value_container_type values_;
+	storage_type storage_;
 };
 
 #endif
@@ -0,0 +1,471 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_concurrent.h
+// Purpose:     Thread-safe property_list with lock-striped items
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_CONCURRENT_H__
+#define __PROP_LIST_CONCURRENT_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+#include "property_list.h"
+
+/// reader-writer spin lock: readers share lock, writer blocks new readers and waits until current ones leave,
+/// std::shared_mutex is not available in C++11
+class property_list_rw_lock {
+public:
+	property_list_rw_lock() : state_(0) {}
+
+	void lock() {
+		unsigned spins = 0;
+		uint32_t state = state_.load(std::memory_order_relaxed);
+		for (;;) {
+			if ((state & writer_bit) == 0) {
+				if (state_.compare_exchange_weak(state, state | writer_bit, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+			} else {
+				pause(spins);
+				state = state_.load(std::memory_order_relaxed);
+			}
+		}
+		while (state_.load(std::memory_order_acquire) != writer_bit)
+			pause(spins);
+	}
+
+	void unlock() {
+		state_.store(0, std::memory_order_release);
+	}
+
+	void lock_shared() {
+		unsigned spins = 0;
+		uint32_t state = state_.load(std::memory_order_relaxed);
+		for (;;) {
+			if ((state & writer_bit) == 0) {
+				if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+			} else {
+				pause(spins);
+				state = state_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void unlock_shared() {
+		state_.fetch_sub(1, std::memory_order_release);
+	}
+
+private:
+	property_list_rw_lock(const property_list_rw_lock &);
+	property_list_rw_lock &operator=(const property_list_rw_lock &);
+
+	static const uint32_t writer_bit = 0x80000000u;
+
+	static void pause(unsigned &spins) {
+		if (++spins > 16)
+			std::this_thread::yield();
+	}
+
+	std::atomic<uint32_t> state_; // writer_bit | number of readers
+};
+
+/// holds shared lock of property_list_rw_lock for a lifetime of guard
+class property_list_read_guard {
+public:
+	explicit property_list_read_guard(property_list_rw_lock &lock) : lock_(lock) {
+		lock_.lock_shared();
+	}
+
+	~property_list_read_guard() {
+		lock_.unlock_shared();
+	}
+
+private:
+	property_list_read_guard(const property_list_read_guard &);
+	property_list_read_guard &operator=(const property_list_read_guard &);
+
+	property_list_rw_lock &lock_;
+};
+
+/// value of concurrent list with number which orders items of all stripes in order of insertion
+template<typename ValueType>
+struct property_list_sequenced_value {
+	property_list_sequenced_value() : seq_(0), value_() {}
+
+	template<typename... Args>
+	explicit property_list_sequenced_value(uint64_t seq, Args &&... args) :
+		seq_(seq), value_(std::forward<Args>(args)...)
+	{
+	}
+
+	bool operator==(const property_list_sequenced_value &rhs) const {
+		return value_ == rhs.value_;
+	}
+
+	uint64_t seq_;
+	ValueType value_;
+};
+
+/// Key-value container with the interface of property_list, which can be used by many threads at once.
+/// Items are divided by hash of key between StripeCount stripes, each stripe is flat storage with its own
+/// reader-writer lock, so readers of any keys do not block each other and writers block only one stripe.
+///
+/// Values are returned by copy, because reference to item could be invalidated by other thread.
+/// Ordered access is provided by snapshot(): all stripes are locked for reading at once and items are
+/// copied to property_list in order of insertion (each item keeps insertion number).
+template<typename KeyType, typename ValueType, typename Allocator = std::allocator<ValueType>, size_t StripeCount = 16>
+class concurrent_property_list {
+	static_assert(StripeCount > 0 && (StripeCount & (StripeCount - 1)) == 0, "stripe count must be a power of 2");
+
+	typedef property_list_sequenced_value<ValueType> item_type;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<item_type> item_allocator_type;
+	typedef property_list_storage<KeyType, item_type, item_allocator_type, property_list_flat_storage> stripe_storage_type;
+public:
+	typedef concurrent_property_list<KeyType, ValueType, Allocator, StripeCount> this_type;
+	typedef Allocator allocator_type;
+	typedef property_list<KeyType, ValueType, Allocator> snapshot_type;
+	typedef typename snapshot_type::key_list_type key_list_type;
+	typedef property_list_key_handle<KeyType> key_handle;
+
+	concurrent_property_list() : next_seq_(0), size_(0) {
+		create_stripes(Allocator());
+	}
+
+	explicit concurrent_property_list(const allocator_type &alloc) : next_seq_(0), size_(0) {
+		create_stripes(alloc);
+	}
+
+	/// copies items of src, which can be used by other threads at the same time
+	concurrent_property_list(const this_type &src) : next_seq_(0), size_(0) {
+		create_stripes(Allocator());
+		copy_items(src);
+	}
+
+	/// copies items of list with any storage policy in order of insertion
+	template<typename SourcePolicy>
+	explicit concurrent_property_list(const property_list<KeyType, ValueType, Allocator, SourcePolicy> &src) :
+		next_seq_(0), size_(0)
+	{
+		create_stripes(Allocator());
+		src.storage().for_each([this](const KeyType &key, const ValueType &value) {
+			put(key, value);
+		});
+	}
+
+	~concurrent_property_list() {
+		for (size_t i = 0; i < StripeCount; ++i)
+			stripes()[i].~stripe();
+	}
+
+	this_type &operator=(const this_type &rhs) {
+		if (this != &rhs) {
+			this_type copy(rhs);
+			lock_all();
+			for (size_t i = 0; i < StripeCount; ++i)
+				stripes()[i].items_ = std::move(copy.stripes()[i].items_);
+			next_seq_.store(copy.next_seq_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			size_.store(copy.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			unlock_all();
+		}
+		return *this;
+	}
+
+	/// lists are equal if their snapshots are equal
+	bool operator==(const this_type &rhs) const {
+		if (this == &rhs)
+			return true;
+		return snapshot() == rhs.snapshot();
+	}
+
+	/// inserts value, if key already exists, old value will be replaced
+	/// returns true if item was already there
+	bool put(const KeyType &key, const ValueType &value) {
+		return put_hashed(key, property_list_entry_hash(key), value);
+	}
+
+	bool put(const KeyType &key, ValueType &&value) {
+		return put_hashed(key, property_list_entry_hash(key), std::move(value));
+	}
+
+	/// inserts value constructed in place from args, if key already exists, old value will be replaced
+	/// returns true if item was already there
+	template<typename... Args>
+	bool emplace(const KeyType &key, Args &&... args) {
+		return put_hashed(key, property_list_entry_hash(key), std::forward<Args>(args)...);
+	}
+
+	/// returns copy of value selected by key
+	/// throws error if key not found
+	ValueType get(const KeyType &key) const {
+		return get_hashed(key, property_list_entry_hash(key));
+	}
+
+	/// returns copy of value selected by key or defValue if key not found
+	ValueType get_def(const KeyType &key, const ValueType &defValue) const {
+		return get_def_hashed(key, property_list_entry_hash(key), defValue);
+	}
+
+	/// copies value selected by key to output, returns false if key not found
+	bool try_get(const KeyType &key, ValueType &output) const {
+		size_t hash = property_list_entry_hash(key);
+		const stripe &part = stripe_of(hash);
+		property_list_read_guard guard(part.lock_);
+		const item_type *found = part.items_.find_hashed(key, hash);
+		if (found == nullptr)
+			return false;
+		output = found->value_;
+		return true;
+	}
+
+	/// returns true if container holds value for a given key
+	bool contains(const KeyType &key) const {
+		return contains_hashed(key, property_list_entry_hash(key));
+	}
+
+	/// removes value selected by key, returns true if item was removed
+	bool remove(const KeyType &key) {
+		return remove_hashed(key, property_list_entry_hash(key));
+	}
+
+	/// lookup by key handle, hash of key is not calculated again
+	ValueType get(const key_handle &key) const {
+		return get_hashed(key.key(), key.hash());
+	}
+
+	ValueType get_def(const key_handle &key, const ValueType &defValue) const {
+		return get_def_hashed(key.key(), key.hash(), defValue);
+	}
+
+	bool contains(const key_handle &key) const {
+		return contains_hashed(key.key(), key.hash());
+	}
+
+	bool remove(const key_handle &key) {
+		return remove_hashed(key.key(), key.hash());
+	}
+
+	/// lookup by text of key without constructing std::string key (see property_list)
+	template<typename Text>
+	typename property_list_text_lookup<KeyType, Text, ValueType>::type get(const Text &key) const {
+		property_list_key_ref text(key);
+		return get_hashed(text, property_list_entry_hash(text));
+	}
+
+	template<typename Text>
+	typename property_list_text_lookup<KeyType, Text, ValueType>::type get_def(const Text &key, const ValueType &defValue) const {
+		property_list_key_ref text(key);
+		return get_def_hashed(text, property_list_entry_hash(text), defValue);
+	}
+
+	template<typename Text>
+	typename property_list_text_lookup<KeyType, Text, bool>::type contains(const Text &key) const {
+		property_list_key_ref text(key);
+		return contains_hashed(text, property_list_entry_hash(text));
+	}
+
+	template<typename Text>
+	typename property_list_text_lookup<KeyType, Text, bool>::type remove(const Text &key) {
+		property_list_key_ref text(key);
+		return remove_hashed(text, property_list_entry_hash(text));
+	}
+
+	/// removes all items stored in container
+	void clear() {
+		lock_all();
+		for (size_t i = 0; i < StripeCount; ++i)
+			stripes()[i].items_.clear();
+		size_.store(0, std::memory_order_relaxed);
+		unlock_all();
+	}
+
+	/// returns number of stored values, exact only if no other thread changes list
+	size_t size() const {
+		return size_.load(std::memory_order_relaxed);
+	}
+
+	/// returns true if there are no values in the storage
+	bool empty() const {
+		return size() == 0;
+	}
+
+	/// returns copy of all items in order of insertion, consistent with state of list at a single point in time
+	snapshot_type snapshot() const {
+		snapshot_type result;
+		lock_all_shared();
+		try {
+			std::vector<std::pair<uint64_t, std::pair<const KeyType *, const ValueType *> > > items;
+			items.reserve(size());
+			for (size_t i = 0; i < StripeCount; ++i) {
+				stripes()[i].items_.for_each([&items](const KeyType &key, const item_type &item) {
+					items.push_back(std::make_pair(item.seq_, std::make_pair(&key, &item.value_)));
+				});
+			}
+			std::sort(items.begin(), items.end(), [](
+				const std::pair<uint64_t, std::pair<const KeyType *, const ValueType *> > &lhs,
+				const std::pair<uint64_t, std::pair<const KeyType *, const ValueType *> > &rhs)
+			{
+				return lhs.first < rhs.first;
+			});
+			result.reserve(items.size());
+			for (size_t i = 0; i < items.size(); ++i)
+				result.put(*items[i].second.first, *items[i].second.second);
+		}
+		catch (...) {
+			unlock_all_shared();
+			throw;
+		}
+		unlock_all_shared();
+		return result;
+	}
+
+	/// return keys in order of insertion
+	key_list_type get_keys() const {
+		return snapshot().get_keys();
+	}
+
+	/// return values in order of insertion
+	std::vector<ValueType> get_values() const {
+		return snapshot().get_values();
+	}
+
+private:
+	/// items with one lock, padded so that locks of neighbour stripes are not in the same cache line
+	struct stripe {
+		explicit stripe(const item_allocator_type &alloc) : items_(alloc) {}
+
+		mutable property_list_rw_lock lock_;
+		stripe_storage_type items_;
+		unsigned char padding_[64];
+	};
+
+	stripe *stripes() const {
+		return reinterpret_cast<stripe *>(const_cast<unsigned char *>(buffer_));
+	}
+
+	/// lowest bit of entry hash is always set
+	stripe &stripe_of(size_t hash) const {
+		return stripes()[(hash >> 1) & (StripeCount - 1)];
+	}
+
+	void create_stripes(const Allocator &alloc) {
+		item_allocator_type item_alloc(alloc);
+		for (size_t i = 0; i < StripeCount; ++i)
+			new (static_cast<void *>(stripes() + i)) stripe(item_alloc);
+	}
+
+	/// stripes are locked in order of their numbers, so that threads which lock all stripes do not deadlock
+	void lock_all() const {
+		for (size_t i = 0; i < StripeCount; ++i)
+			stripes()[i].lock_.lock();
+	}
+
+	void unlock_all() const {
+		for (size_t i = 0; i < StripeCount; ++i)
+			stripes()[i].lock_.unlock();
+	}
+
+	void lock_all_shared() const {
+		for (size_t i = 0; i < StripeCount; ++i)
+			stripes()[i].lock_.lock_shared();
+	}
+
+	void unlock_all_shared() const {
+		for (size_t i = 0; i < StripeCount; ++i)
+			stripes()[i].lock_.unlock_shared();
+	}
+
+	/// copies items of src to empty list
+	void copy_items(const this_type &src) {
+		src.lock_all_shared();
+		try {
+			for (size_t i = 0; i < StripeCount; ++i)
+				stripes()[i].items_ = src.stripes()[i].items_;
+		}
+		catch (...) {
+			src.unlock_all_shared();
+			throw;
+		}
+		next_seq_.store(src.next_seq_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		size_.store(src.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		src.unlock_all_shared();
+	}
+
+	template<typename... Args>
+	bool put_hashed(const KeyType &key, size_t hash, Args &&... args) {
+		stripe &part = stripe_of(hash);
+		std::lock_guard<property_list_rw_lock> guard(part.lock_);
+		item_type *found = part.items_.find_hashed(key, hash);
+		if (found != nullptr) {
+			property_list_assign(found->value_, std::forward<Args>(args)...);
+			return true;
+		}
+		part.items_.put_hashed(key, hash, next_seq_.fetch_add(1, std::memory_order_relaxed), std::forward<Args>(args)...);
+		size_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	template<typename Lookup>
+	ValueType get_hashed(const Lookup &key, size_t hash) const {
+		{
+			const stripe &part = stripe_of(hash);
+			property_list_read_guard guard(part.lock_);
+			const item_type *found = part.items_.find_hashed(key, hash);
+			if (found != nullptr)
+				return found->value_;
+		}
+		throwNotFound(key);
+		return ValueType();
+	}
+
+	static void throwNotFound(const KeyType &key) {
+		throw std::runtime_error("key not found: " + to_string(key));
+	}
+
+	static void throwNotFound(const property_list_key_ref &key) {
+		throw std::runtime_error("key not found: " + key.str());
+	}
+
+	template<typename Lookup>
+	ValueType get_def_hashed(const Lookup &key, size_t hash, const ValueType &defValue) const {
+		const stripe &part = stripe_of(hash);
+		property_list_read_guard guard(part.lock_);
+		const item_type *found = part.items_.find_hashed(key, hash);
+		return (found != nullptr) ? found->value_ : defValue;
+	}
+
+	template<typename Lookup>
+	bool contains_hashed(const Lookup &key, size_t hash) const {
+		const stripe &part = stripe_of(hash);
+		property_list_read_guard guard(part.lock_);
+		return part.items_.find_hashed(key, hash) != nullptr;
+	}
+
+	template<typename Lookup>
+	bool remove_hashed(const Lookup &key, size_t hash) {
+		stripe &part = stripe_of(hash);
+		std::lock_guard<property_list_rw_lock> guard(part.lock_);
+		if (!part.items_.remove_hashed(key, hash))
+			return false;
+		size_.fetch_sub(1, std::memory_order_relaxed);
+		if (part.items_.needs_reorg())
+			part.items_.reorg();
+		return true;
+	}
+
+	alignas(stripe) unsigned char buffer_[sizeof(stripe) * StripeCount];
+	std::atomic<uint64_t> next_seq_; // insertion number of next new item
+	std::atomic<size_t> size_;
+};
+
+#endif
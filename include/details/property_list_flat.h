@@ -0,0 +1,619 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_flat.h
+// Purpose:     Storage of property_list: insertion-ordered entries + open addressing index
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_FLAT_H__
+#define __PROP_LIST_FLAT_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include <vector>
+
+#include "property_list_storage.h"
+
+/// item of property_list storage, key is not const here so that entries can be moved to a new block;
+/// value iterators expose it as property_list_item with const key
+template<typename KeyType, typename ValueType>
+class property_list_entry {
+public:
+	typedef KeyType key_type;
+	typedef ValueType mapped_type;
+
+	template<typename Key, typename... Args>
+	property_list_entry(size_t hash, Key &&key, Args &&... args) :
+		first(std::forward<Key>(key)), second(std::forward<Args>(args)...), hash_(hash)
+	{
+	}
+
+	KeyType first;
+	ValueType second;
+private:
+	template<typename, typename, typename, typename> friend class property_list_storage;
+	template<typename, typename> friend class property_list_entry_iterator;
+
+	property_list_entry(const property_list_entry &);
+	property_list_entry &operator=(const property_list_entry &);
+
+	// hash with lowest bit set, 0 for removed entry
+	size_t hash_;
+};
+
+/// how entry iterator shows an entry: key iterators return const key
+template<typename EntryType, typename ItemType>
+struct property_list_entry_access {
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename std::remove_const<ItemType>::type value_type;
+	typedef ItemType &reference;
+	typedef ItemType *pointer;
+
+	static reference get(EntryType &value) {
+		return value.first;
+	}
+
+	static pointer address(EntryType &value) {
+		return &value.first;
+	}
+};
+
+/// value iterators return item with references to const key and (const) value
+template<typename EntryType, typename KeyType, typename ValueType>
+struct property_list_entry_access<EntryType, property_list_item<KeyType, ValueType> > {
+	typedef std::input_iterator_tag iterator_category;
+	typedef property_list_item<KeyType, ValueType> value_type;
+	typedef value_type reference;
+	typedef property_list_item_pointer<KeyType, ValueType> pointer;
+
+	static reference get(EntryType &value) {
+		reference result = { value.first, value.second };
+		return result;
+	}
+
+	static pointer address(EntryType &value) {
+		return pointer(get(value));
+	}
+};
+
+/// forward iterator over live entries of array, ItemType is const key or property_list_item
+template<typename EntryType, typename ItemType>
+class property_list_entry_iterator {
+	typedef property_list_entry_access<EntryType, ItemType> access;
+public:
+	typedef typename access::iterator_category iterator_category;
+	typedef typename access::value_type value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef typename access::pointer pointer;
+	typedef typename access::reference reference;
+
+	property_list_entry_iterator() : pos_(nullptr), end_(nullptr) {}
+
+	property_list_entry_iterator(EntryType *pos, EntryType *end) : pos_(pos), end_(end) {
+		skip_removed();
+	}
+
+	reference operator*() const {
+		return access::get(*pos_);
+	}
+
+	pointer operator->() const {
+		return access::address(*pos_);
+	}
+
+	property_list_entry_iterator &operator++() {
+		++pos_;
+		skip_removed();
+		return *this;
+	}
+
+	property_list_entry_iterator operator++(int) {
+		property_list_entry_iterator result(*this);
+		++(*this);
+		return result;
+	}
+
+	bool operator==(const property_list_entry_iterator &rhs) const {
+		return pos_ == rhs.pos_;
+	}
+
+	bool operator!=(const property_list_entry_iterator &rhs) const {
+		return pos_ != rhs.pos_;
+	}
+
+private:
+	void skip_removed() {
+		while (pos_ != end_ && pos_->hash_ == 0)
+			++pos_;
+	}
+
+	EntryType *pos_;
+	EntryType *end_;
+};
+
+/// Compact ordered hash table (layout of CPython dict): entries are stored densely in order of
+/// insertion, followed by index of 2^n slots which hold (entry number + 1) or 0 for empty slot.
+/// Both arrays live in a single block, so object needs one allocation (plus allocations of keys / values).
+///
+/// Removed entry becomes a tombstone: its value is reset immediately, entry and its index slot stay
+/// until the block is rebuilt (on growth or reorg). Iterators skip tombstones.
+///
+/// Entries are move-constructed in a new block when key and value have nothrow move constructors,
+/// otherwise they are copied, so that the list is not changed if a copy throws.
+template<typename KeyType, typename ValueType, typename Allocator>
+class property_list_storage<KeyType, ValueType, Allocator, property_list_flat_storage> {
+public:
+	typedef property_list_entry<KeyType, ValueType> entry;
+
+private:
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<entry> entry_allocator_type;
+	typedef std::allocator_traits<entry_allocator_type> entry_allocator_traits;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<KeyType> key_allocator_type;
+	typedef std::uint32_t index_type;
+
+	enum { min_slots = 8 };
+
+public:
+	typedef std::vector<KeyType, key_allocator_type> key_list_type;
+	typedef property_list_entry_iterator<entry, const KeyType> key_iterator;
+	typedef property_list_entry_iterator<const entry, const KeyType> key_const_iterator;
+	typedef property_list_entry_iterator<entry, property_list_item<KeyType, ValueType> > value_iterator;
+	typedef property_list_entry_iterator<const entry, property_list_item<KeyType, const ValueType> > value_const_iterator;
+
+	property_list_storage() {
+		init_empty();
+	}
+
+	explicit property_list_storage(const Allocator &alloc) : alloc_(entry_allocator_type(alloc)) {
+		init_empty();
+	}
+
+	property_list_storage(const property_list_storage &src) :
+		alloc_(entry_allocator_traits::select_on_container_copy_construction(src.alloc_))
+	{
+		init_empty();
+		copy_entries(src);
+	}
+
+	property_list_storage(property_list_storage &&src) : alloc_(src.alloc_) {
+		init_empty();
+		take_block(src);
+	}
+
+	~property_list_storage() {
+		release_block();
+	}
+
+	property_list_storage &operator=(const property_list_storage &rhs) {
+		if (this != &rhs) {
+			release_block();
+			copy_entries(rhs);
+		}
+		return *this;
+	}
+
+	property_list_storage &operator=(property_list_storage &&rhs) {
+		if (this != &rhs) {
+			release_block();
+			if (alloc_ == rhs.alloc_)
+				take_block(rhs);
+			else
+				copy_entries(rhs);
+		}
+		return *this;
+	}
+
+	Allocator get_allocator() const {
+		return Allocator(alloc_);
+	}
+
+	/// lists are equal if they have the same items in the same order
+	bool operator==(const property_list_storage &rhs) const {
+		if (live_ != rhs.live_)
+			return false;
+		value_const_iterator it = values_cbegin(), rit = rhs.values_cbegin(), end = values_cend();
+		for (; it != end; ++it, ++rit) {
+			if (!(it->first == rit->first) || !(it->second == rit->second))
+				return false;
+		}
+		return true;
+	}
+
+	/// sets value of key from args (see property_list_assign), returns true if item was already there
+	template<typename Key, typename... Args>
+	bool put(Key &&key, Args &&... args) {
+		size_t hash = property_list_entry_hash(key);
+		return put_hashed(std::forward<Key>(key), hash, std::forward<Args>(args)...);
+	}
+
+	/// put with hash already calculated with property_list_entry_hash
+	template<typename Key, typename... Args>
+	bool put_hashed(Key &&key, size_t hash, Args &&... args) {
+		size_t slot = 0;
+		if (entries_ != nullptr) {
+			slot = find_slot(key, hash);
+			if (index_[slot] != 0) {
+				property_list_assign(entries_[index_[slot] - 1].second, std::forward<Args>(args)...);
+				return true;
+			}
+		}
+
+		if (used_ == capacity_) {
+			// args can refer to item of this list, so new entry is constructed before entries are moved
+			auto add = [&](entry_allocator_type &alloc, entry *place) {
+				entry_allocator_traits::construct(alloc, place, hash, std::forward<Key>(key), std::forward<Args>(args)...);
+			};
+			rebuild(slots_for(live_ + live_ / 2 + 1), hash, &add);
+			return false;
+		}
+
+		entry_allocator_traits::construct(alloc_, entries_ + used_, hash, std::forward<Key>(key), std::forward<Args>(args)...);
+		++used_;
+		++live_;
+		index_[slot] = static_cast<index_type>(used_);
+		return false;
+	}
+
+	template<typename Lookup>
+	ValueType *find(const Lookup &key) {
+		entry *found = find_entry(key, property_list_entry_hash(key));
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	template<typename Lookup>
+	const ValueType *find(const Lookup &key) const {
+		entry *found = find_entry(key, property_list_entry_hash(key));
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	ValueType *find(const property_list_key_handle<KeyType> &key) {
+		return find_hashed(key.key(), key.hash());
+	}
+
+	const ValueType *find(const property_list_key_handle<KeyType> &key) const {
+		return find_hashed(key.key(), key.hash());
+	}
+
+	/// find with hash already calculated with property_list_entry_hash
+	template<typename Lookup>
+	ValueType *find_hashed(const Lookup &key, size_t hash) {
+		entry *found = find_entry(key, hash);
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	template<typename Lookup>
+	const ValueType *find_hashed(const Lookup &key, size_t hash) const {
+		entry *found = find_entry(key, hash);
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	/// returns true if item was removed
+	template<typename Lookup>
+	bool remove(const Lookup &key) {
+		return remove_hashed(key, property_list_entry_hash(key));
+	}
+
+	/// remove with hash already calculated with property_list_entry_hash
+	template<typename Lookup>
+	bool remove_hashed(const Lookup &key, size_t hash) {
+		entry *found = find_entry(key, hash);
+		if (found == nullptr)
+			return false;
+		found->hash_ = 0;
+		found->second = ValueType();
+		--live_;
+		return true;
+	}
+
+	/// removes all items, memory block is kept for reuse
+	void clear() {
+		destroy_entries();
+		clear_index();
+	}
+
+	size_t size() const {
+		return live_;
+	}
+
+	/// true if more than 1/3 of entries are tombstones, then iteration is compacted first
+	bool needs_reorg() const {
+		return used_ - live_ > live_ / 2;
+	}
+
+	/// prepares block for a given number of items
+	void reserve(size_t count) {
+		if (count > capacity_)
+			rebuild(slots_for(count), 0, static_cast<no_entry *>(nullptr));
+	}
+
+	/// removes tombstones, shrinks memory block if possible
+	void reorg() {
+		if (used_ == live_)
+			return;
+		if (live_ == 0)
+			release_block();
+		else
+			rebuild(slots_for(live_), 0, static_cast<no_entry *>(nullptr));
+	}
+
+	/// fills helper with keys, returns reference to helper
+	const key_list_type &get_keys(key_list_type &helper) const {
+		helper.clear();
+		helper.reserve(live_);
+		for (key_const_iterator it = keys_cbegin(), end = keys_cend(); it != end; ++it)
+			helper.push_back(*it);
+		return helper;
+	}
+
+	/// calls func(key, value) for each item in order of insertion
+	template<typename Func>
+	void for_each(Func func) const {
+		for (value_const_iterator it = values_cbegin(), end = values_cend(); it != end; ++it)
+			func(it->first, it->second);
+	}
+
+	template<typename Func>
+	void for_each(Func func) {
+		for (value_iterator it = values_begin(), end = values_end(); it != end; ++it)
+			func(it->first, it->second);
+	}
+
+	/// iterators skip tombstones, so entries are compacted only when there are too many of them,
+	/// which keeps remove + iterate loops linear; keys_end does not compact, so that it can be
+	/// called in condition of a loop which removes items
+	key_iterator keys_begin() {
+		if (needs_reorg())
+			reorg();
+		return key_iterator(entries_, entries_ + used_);
+	}
+
+	key_iterator keys_end() {
+		return key_iterator(entries_ + used_, entries_ + used_);
+	}
+
+	key_const_iterator keys_cbegin() const {
+		return key_const_iterator(entries_, entries_ + used_);
+	}
+
+	key_const_iterator keys_cend() const {
+		return key_const_iterator(entries_ + used_, entries_ + used_);
+	}
+
+	value_iterator values_begin() {
+		return value_iterator(entries_, entries_ + used_);
+	}
+
+	value_iterator values_end() {
+		return value_iterator(entries_ + used_, entries_ + used_);
+	}
+
+	value_const_iterator values_cbegin() const {
+		return value_const_iterator(entries_, entries_ + used_);
+	}
+
+	value_const_iterator values_cend() const {
+		return value_const_iterator(entries_ + used_, entries_ + used_);
+	}
+
+private:
+	/// usable number of entries for a given number of index slots, load factor is kept below 2/3
+	static size_t capacity_for(size_t slots) {
+		return slots * 2 / 3;
+	}
+
+	static size_t slots_for(size_t count) {
+		size_t slots = min_slots;
+		while (capacity_for(slots) < count)
+			slots *= 2;
+		return slots;
+	}
+
+	/// number of entries allocated for entries + index
+	static size_t block_size(size_t slots) {
+		return capacity_for(slots) + (slots * sizeof(index_type) + sizeof(entry) - 1) / sizeof(entry);
+	}
+
+	/// Fibonacci hashing, so that keys with equal low bits (like pointers) do not collide
+	size_t home_slot(size_t hash) const {
+		return static_cast<size_t>((static_cast<unsigned long long>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+	}
+
+	/// returns slot with entry of a given key or empty slot where the key can be inserted
+	template<typename Lookup>
+	size_t find_slot(const Lookup &key, size_t hash) const {
+		size_t slot = home_slot(hash);
+		for (;;) {
+			index_type pos = index_[slot];
+			if (pos == 0)
+				return slot;
+			const entry &item = entries_[pos - 1];
+			if (item.hash_ == hash && item.first == key)
+				return slot;
+			slot = (slot + 1) & mask_;
+		}
+	}
+
+	size_t find_empty_slot(size_t hash) const {
+		size_t slot = home_slot(hash);
+		while (index_[slot] != 0)
+			slot = (slot + 1) & mask_;
+		return slot;
+	}
+
+	template<typename Lookup>
+	entry *find_entry(const Lookup &key, size_t hash) const {
+		if (live_ == 0)
+			return nullptr;
+		index_type pos = index_[find_slot(key, hash)];
+		return (pos != 0) ? entries_ + pos - 1 : nullptr;
+	}
+
+	void init_empty() {
+		entries_ = nullptr;
+		index_ = nullptr;
+		capacity_ = used_ = live_ = 0;
+		mask_ = 0;
+		shift_ = 0;
+	}
+
+	void set_block(entry *block, size_t slots) {
+		entries_ = block;
+		capacity_ = capacity_for(slots);
+		index_ = reinterpret_cast<index_type *>(block + capacity_);
+		mask_ = slots - 1;
+		shift_ = 64;
+		for (size_t i = slots; i > 1; i /= 2)
+			--shift_;
+	}
+
+	void clear_index() {
+		for (size_t i = 0; i <= mask_ && index_ != nullptr; ++i)
+			index_[i] = 0;
+	}
+
+	void destroy_entries() {
+		for (size_t i = 0; i < used_; ++i)
+			entry_allocator_traits::destroy(alloc_, entries_ + i);
+		used_ = live_ = 0;
+	}
+
+	void release_block() {
+		if (entries_ == nullptr)
+			return;
+		destroy_entries();
+		entry_allocator_traits::deallocate(alloc_, entries_, block_size(mask_ + 1));
+		init_empty();
+	}
+
+	void take_block(property_list_storage &src) {
+		entries_ = src.entries_;
+		index_ = src.index_;
+		capacity_ = src.capacity_;
+		used_ = src.used_;
+		live_ = src.live_;
+		mask_ = src.mask_;
+		shift_ = src.shift_;
+		src.init_empty();
+	}
+
+	/// copies live items of src to empty storage
+	void copy_entries(const property_list_storage &src) {
+		if (src.live_ == 0)
+			return;
+		size_t slots = slots_for(src.live_);
+		set_block(entry_allocator_traits::allocate(alloc_, block_size(slots)), slots);
+		clear_index();
+		try {
+			for (const entry *it = src.entries_, *end = src.entries_ + src.used_; it != end; ++it) {
+				if (it->hash_ != 0)
+					append(it->hash_, it->first, it->second);
+			}
+		}
+		catch (...) {
+			release_block();
+			throw;
+		}
+	}
+
+	template<typename Key, typename Value>
+	void append(size_t hash, Key &&key, Value &&value) {
+		entry_allocator_traits::construct(alloc_, entries_ + used_, hash, std::forward<Key>(key), std::forward<Value>(value));
+		++used_;
+		++live_;
+		index_[find_empty_slot(hash)] = static_cast<index_type>(used_);
+	}
+
+	/// placeholder of rebuild without new entry
+	struct no_entry {
+		void operator()(entry_allocator_type &, entry *) const {}
+	};
+
+	/// moves live entries to a new block with a given number of slots,
+	/// optional new entry with a given hash is constructed first by (*add)(allocator, place),
+	/// so that its value can refer to an existing item; if anything throws, the list is not changed.
+	template<typename AddEntry>
+	void rebuild(size_t slots, size_t hash, AddEntry *add) {
+		if (capacity_for(slots) > static_cast<index_type>(-1))
+			throw std::length_error("property_list too long");
+
+		Allocator alloc(alloc_);
+		property_list_storage fresh(alloc);
+		fresh.set_block(entry_allocator_traits::allocate(fresh.alloc_, block_size(slots)), slots);
+		fresh.clear_index();
+
+		entry *added = nullptr;
+		if (add != nullptr) {
+			added = fresh.entries_ + live_;
+			(*add)(fresh.alloc_, added);
+		}
+
+		try {
+			transfer_entries(fresh, std::integral_constant<bool,
+				std::is_nothrow_move_constructible<KeyType>::value && std::is_nothrow_move_constructible<ValueType>::value>());
+		}
+		catch (...) {
+			if (added != nullptr)
+				entry_allocator_traits::destroy(fresh.alloc_, added);
+			throw;
+		}
+
+		if (added != nullptr) {
+			++fresh.used_;
+			++fresh.live_;
+			fresh.index_[fresh.find_empty_slot(hash)] = static_cast<index_type>(fresh.used_);
+		}
+
+		release_block();
+		take_block(fresh);
+	}
+
+	/// moves live entries to empty dest, entries of this list stay moved-from until block is released
+	void transfer_entries(property_list_storage &dest, std::true_type /* nothrow move */) {
+		for (entry *it = entries_, *end = entries_ + used_; it != end; ++it) {
+			if (it->hash_ != 0)
+				dest.append(it->hash_, std::move(it->first), std::move(it->second));
+		}
+	}
+
+	/// entries of dest are built with copied keys and empty values before any value is moved,
+	/// so when a copy throws this list is not changed yet
+	void transfer_entries(property_list_storage &dest, std::false_type /* nothrow move */) {
+		for (const entry *it = entries_, *end = entries_ + used_; it != end; ++it) {
+			if (it->hash_ != 0)
+				dest.append(it->hash_, it->first, ValueType());
+		}
+		transfer_values(dest, std::is_nothrow_move_assignable<ValueType>());
+	}
+
+	/// moves values to entries of dest, which has the same keys in the same order
+	void transfer_values(property_list_storage &dest, std::true_type /* nothrow move */) {
+		entry *target = dest.entries_;
+		for (value_iterator it = values_begin(), end = values_end(); it != end; ++it, ++target)
+			target->second = std::move(it->second);
+	}
+
+	/// copies values, when assignment throws values of this list are not changed yet
+	void transfer_values(property_list_storage &dest, std::false_type /* nothrow move */) {
+		entry *target = dest.entries_;
+		for (value_iterator it = values_begin(), end = values_end(); it != end; ++it, ++target)
+			target->second = it->second;
+	}
+
+	entry_allocator_type alloc_;
+	entry *entries_;
+	index_type *index_;
+	size_t capacity_;  // number of entries which fit in block
+	size_t used_;      // number of constructed entries, including tombstones
+	size_t live_;      // number of items
+	size_t mask_;      // number of index slots - 1
+	unsigned int shift_;
+};
+
+#endif
@@ -0,0 +1,420 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_frozen.h
+// Purpose:     Storage of property_list: immutable entries + minimal perfect hash
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_FROZEN_H__
+#define __PROP_LIST_FROZEN_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "property_list_storage.h"
+#include "property_list_flat.h"
+
+/// Read-only layout built once from another list (see property_list::freeze): entries in insertion order,
+/// followed by displacement table (one per bucket of 2 keys on average) and slot table (entry numbers),
+/// all in a single block.
+///
+/// Perfect hash with displacement: bucket of key selects displacement, key hash mixed with displacement
+/// selects slot, slot holds number of entry. Displacements are chosen when list is built, so that each key
+/// has its own slot and every slot holds a key, lookup is: 2 table reads + 1 key comparison, without probing.
+/// Keys with equal 64-bit hashes cannot be separated, then all but first are found by linear scan.
+///
+/// There are no put / remove / clear, so calling them on frozen list does not compile. Values can be
+/// updated in place through non-const access. Concurrent reads need no synchronization.
+template<typename KeyType, typename ValueType, typename Allocator>
+class property_list_storage<KeyType, ValueType, Allocator, property_list_frozen_storage> {
+public:
+	typedef property_list_entry<KeyType, ValueType> entry;
+
+private:
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<entry> entry_allocator_type;
+	typedef std::allocator_traits<entry_allocator_type> entry_allocator_traits;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<KeyType> key_allocator_type;
+	typedef std::uint32_t index_type;
+
+	enum { max_displacement = 1 << 16 };
+
+public:
+	typedef std::vector<KeyType, key_allocator_type> key_list_type;
+	typedef property_list_entry_iterator<entry, const KeyType> key_iterator;
+	typedef property_list_entry_iterator<const entry, const KeyType> key_const_iterator;
+	typedef property_list_entry_iterator<entry, property_list_item<KeyType, ValueType> > value_iterator;
+	typedef property_list_entry_iterator<const entry, property_list_item<KeyType, const ValueType> > value_const_iterator;
+
+	property_list_storage() {
+		init_empty();
+	}
+
+	explicit property_list_storage(const Allocator &alloc) : alloc_(entry_allocator_type(alloc)) {
+		init_empty();
+	}
+
+	property_list_storage(const property_list_storage &src) :
+		alloc_(entry_allocator_traits::select_on_container_copy_construction(src.alloc_))
+	{
+		init_empty();
+		copy_block(src);
+	}
+
+	property_list_storage(property_list_storage &&src) : alloc_(src.alloc_) {
+		init_empty();
+		take_block(src);
+	}
+
+	~property_list_storage() {
+		release_block();
+	}
+
+	property_list_storage &operator=(const property_list_storage &rhs) {
+		if (this != &rhs) {
+			release_block();
+			copy_block(rhs);
+		}
+		return *this;
+	}
+
+	property_list_storage &operator=(property_list_storage &&rhs) {
+		if (this != &rhs) {
+			release_block();
+			if (alloc_ == rhs.alloc_)
+				take_block(rhs);
+			else
+				copy_block(rhs);
+		}
+		return *this;
+	}
+
+	/// lists are equal if they have the same items in the same order
+	bool operator==(const property_list_storage &rhs) const {
+		if (size_ != rhs.size_)
+			return false;
+		for (size_t i = 0; i < size_; ++i) {
+			if (!(entries_[i].first == rhs.entries_[i].first) || !(entries_[i].second == rhs.entries_[i].second))
+				return false;
+		}
+		return true;
+	}
+
+	/// replaces items with items of another storage (any policy), in order of insertion
+	template<typename SourceStorage>
+	void assign(const SourceStorage &src) {
+		std::vector<size_t> hashes;
+		hashes.reserve(src.size());
+		src.for_each(hash_collector(hashes));
+
+		std::vector<index_type> displacements, slots;
+		bool collisions = build_hash(hashes, displacements, slots);
+
+		const Allocator alloc(alloc_);
+		property_list_storage fresh(alloc);
+		fresh.set_block(entry_allocator_traits::allocate(fresh.alloc_, block_size(hashes.size(), displacements.size(), slots.size())),
+			hashes.size(), displacements.size(), slots.size());
+		fresh.collisions_ = collisions;
+		std::copy(displacements.begin(), displacements.end(), fresh.displacements_);
+		std::copy(slots.begin(), slots.end(), fresh.slots_);
+		src.for_each(entry_builder(fresh, hashes));
+
+		release_block();
+		take_block(fresh);
+	}
+
+	template<typename Lookup>
+	ValueType *find(const Lookup &key) {
+		entry *found = find_entry(key, property_list_entry_hash(key));
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	template<typename Lookup>
+	const ValueType *find(const Lookup &key) const {
+		entry *found = find_entry(key, property_list_entry_hash(key));
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	ValueType *find(const property_list_key_handle<KeyType> &key) {
+		entry *found = find_entry(key.key(), key.hash());
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	const ValueType *find(const property_list_key_handle<KeyType> &key) const {
+		entry *found = find_entry(key.key(), key.hash());
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	bool needs_reorg() const {
+		return false;
+	}
+
+	void reorg() {
+	}
+
+	/// fills helper with keys, returns reference to helper
+	const key_list_type &get_keys(key_list_type &helper) const {
+		helper.clear();
+		helper.reserve(size_);
+		for (size_t i = 0; i < size_; ++i)
+			helper.push_back(entries_[i].first);
+		return helper;
+	}
+
+	/// calls func(key, value) for each item in order of insertion
+	template<typename Func>
+	void for_each(Func func) const {
+		for (size_t i = 0; i < size_; ++i)
+			func(entries_[i].first, entries_[i].second);
+	}
+
+	template<typename Func>
+	void for_each(Func func) {
+		for (value_iterator it = values_begin(), end = values_end(); it != end; ++it)
+			func(it->first, it->second);
+	}
+
+	key_iterator keys_begin() {
+		return key_iterator(entries_, entries_ + size_);
+	}
+
+	key_iterator keys_end() {
+		return key_iterator(entries_ + size_, entries_ + size_);
+	}
+
+	key_const_iterator keys_cbegin() const {
+		return key_const_iterator(entries_, entries_ + size_);
+	}
+
+	key_const_iterator keys_cend() const {
+		return key_const_iterator(entries_ + size_, entries_ + size_);
+	}
+
+	value_iterator values_begin() {
+		return value_iterator(entries_, entries_ + size_);
+	}
+
+	value_iterator values_end() {
+		return value_iterator(entries_ + size_, entries_ + size_);
+	}
+
+	value_const_iterator values_cbegin() const {
+		return value_const_iterator(entries_, entries_ + size_);
+	}
+
+	value_const_iterator values_cend() const {
+		return value_const_iterator(entries_ + size_, entries_ + size_);
+	}
+
+	/// number of slots of perfect hash, equal to size unless hash had to be enlarged
+	size_t slot_count() const {
+		return slot_count_;
+	}
+
+private:
+	struct hash_collector {
+		explicit hash_collector(std::vector<size_t> &hashes) : hashes_(hashes) {}
+
+		void operator()(const KeyType &key, const ValueType &) const {
+			hashes_.push_back(property_list_entry_hash(key));
+		}
+
+		std::vector<size_t> &hashes_;
+	};
+
+	struct entry_builder {
+		entry_builder(property_list_storage &target, const std::vector<size_t> &hashes) : target_(target), hashes_(hashes) {}
+
+		void operator()(const KeyType &key, const ValueType &value) const {
+			size_t i = target_.size_;
+			entry_allocator_traits::construct(target_.alloc_, target_.entries_ + i, hashes_[i], key, value);
+			++target_.size_;
+		}
+
+		property_list_storage &target_;
+		const std::vector<size_t> &hashes_;
+	};
+
+	static size_t bucket_of(size_t hash, size_t buckets) {
+		uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(((mixed >> 32) * buckets) >> 32);
+	}
+
+	static size_t slot_of(size_t hash, index_type displacement, size_t slots) {
+		uint64_t mixed = (static_cast<uint64_t>(hash) ^ (displacement * 0xC2B2AE3D27D4EB4Full)) * 0xff51afd7ed558ccdull;
+		return static_cast<size_t>(((mixed >> 32) * slots) >> 32);
+	}
+
+	/// finds displacement of each bucket, largest buckets first, slot table grows if search fails;
+	/// returns true if some keys have equal hashes
+	static bool build_hash(const std::vector<size_t> &hashes, std::vector<index_type> &displacements, std::vector<index_type> &slots) {
+		size_t count = hashes.size();
+		size_t bucket_count = count / 2 + 1;
+
+		// keys with equal hashes after the first one are left for linear scan
+		std::vector<std::pair<size_t, size_t> > sorted;
+		sorted.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+			sorted.push_back(std::make_pair(hashes[i], i));
+		std::sort(sorted.begin(), sorted.end());
+		std::vector<std::vector<index_type> > buckets(bucket_count);
+		bool collisions = false;
+		for (size_t i = 0; i < count; ++i) {
+			if (i > 0 && sorted[i].first == sorted[i - 1].first) {
+				collisions = true;
+				continue;
+			}
+			buckets[bucket_of(sorted[i].first, bucket_count)].push_back(static_cast<index_type>(sorted[i].second));
+		}
+
+		std::vector<size_t> order(bucket_count);
+		for (size_t i = 0; i < bucket_count; ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+			return buckets[a].size() > buckets[b].size();
+		});
+
+		size_t slot_count = (count > 0) ? count : 1;
+		std::vector<size_t> positions;
+		for (;;) {
+			displacements.assign(bucket_count, 0);
+			slots.assign(slot_count, 0);
+			std::vector<bool> taken(slot_count, false);
+			bool placed = true;
+			for (size_t b = 0; b < bucket_count && placed; ++b) {
+				const std::vector<index_type> &bucket = buckets[order[b]];
+				if (bucket.empty())
+					break;
+				placed = false;
+				for (index_type d = 0; d < max_displacement && !placed; ++d) {
+					positions.clear();
+					placed = true;
+					for (size_t k = 0; k < bucket.size() && placed; ++k) {
+						size_t pos = slot_of(hashes[bucket[k]], d, slot_count);
+						placed = !taken[pos] && std::find(positions.begin(), positions.end(), pos) == positions.end();
+						positions.push_back(pos);
+					}
+					if (placed) {
+						displacements[order[b]] = d;
+						for (size_t k = 0; k < bucket.size(); ++k) {
+							taken[positions[k]] = true;
+							slots[positions[k]] = bucket[k];
+						}
+					}
+				}
+			}
+			if (placed)
+				return collisions;
+			slot_count += slot_count / 8 + 1;
+		}
+	}
+
+	/// free slots hold entry 0, which does not match other keys
+	template<typename Lookup>
+	entry *find_entry(const Lookup &key, size_t hash) const {
+		if (size_ == 0)
+			return nullptr;
+		entry *found = entries_ + slots_[slot_of(hash, displacements_[bucket_of(hash, bucket_count_)], slot_count_)];
+		if (found->hash_ == hash && found->first == key)
+			return found;
+		return collisions_ ? find_linear(key, hash) : nullptr;
+	}
+
+	template<typename Lookup>
+	entry *find_linear(const Lookup &key, size_t hash) const {
+		for (size_t i = 0; i < size_; ++i) {
+			if (entries_[i].hash_ == hash && entries_[i].first == key)
+				return entries_ + i;
+		}
+		return nullptr;
+	}
+
+	/// number of entries allocated for entries + displacements + slots
+	static size_t block_size(size_t count, size_t buckets, size_t slots) {
+		return count + ((buckets + slots) * sizeof(index_type) + sizeof(entry) - 1) / sizeof(entry);
+	}
+
+	void init_empty() {
+		entries_ = nullptr;
+		displacements_ = slots_ = nullptr;
+		capacity_ = size_ = bucket_count_ = slot_count_ = 0;
+		collisions_ = false;
+	}
+
+	void set_block(entry *block, size_t count, size_t buckets, size_t slots) {
+		entries_ = block;
+		capacity_ = count;
+		displacements_ = reinterpret_cast<index_type *>(block + count);
+		slots_ = displacements_ + buckets;
+		bucket_count_ = buckets;
+		slot_count_ = slots;
+	}
+
+	void release_block() {
+		if (entries_ == nullptr)
+			return;
+		for (size_t i = 0; i < size_; ++i)
+			entry_allocator_traits::destroy(alloc_, entries_ + i);
+		entry_allocator_traits::deallocate(alloc_, entries_, block_size(capacity_, bucket_count_, slot_count_));
+		init_empty();
+	}
+
+	void take_block(property_list_storage &src) {
+		entries_ = src.entries_;
+		displacements_ = src.displacements_;
+		slots_ = src.slots_;
+		capacity_ = src.capacity_;
+		size_ = src.size_;
+		bucket_count_ = src.bucket_count_;
+		slot_count_ = src.slot_count_;
+		collisions_ = src.collisions_;
+		src.init_empty();
+	}
+
+	void copy_block(const property_list_storage &src) {
+		if (src.entries_ == nullptr)
+			return;
+		set_block(entry_allocator_traits::allocate(alloc_, block_size(src.capacity_, src.bucket_count_, src.slot_count_)),
+			src.capacity_, src.bucket_count_, src.slot_count_);
+		std::memcpy(displacements_, src.displacements_, (bucket_count_ + slot_count_) * sizeof(index_type));
+		collisions_ = src.collisions_;
+		try {
+			for (; size_ < src.size_; ++size_)
+				entry_allocator_traits::construct(alloc_, entries_ + size_, src.entries_[size_].hash_,
+					src.entries_[size_].first, src.entries_[size_].second);
+		}
+		catch (...) {
+			release_block();
+			throw;
+		}
+	}
+
+	entry_allocator_type alloc_;
+	entry *entries_;
+	index_type *displacements_;
+	index_type *slots_;
+	size_t capacity_;      // number of entries which fit in block
+	size_t size_;          // number of constructed entries
+	size_t bucket_count_;
+	size_t slot_count_;
+	bool collisions_;      // true if some keys have equal hashes
+};
+
+/// frozen list is built at once from items of source list
+template<typename KeyType, typename ValueType, typename Allocator, typename SourceStorage>
+inline void property_list_copy_items(property_list_storage<KeyType, ValueType, Allocator, property_list_frozen_storage> &target,
+	const SourceStorage &src)
+{
+	target.assign(src);
+}
+
+#endif
@@ -0,0 +1,216 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_hash.h
+// Purpose:     Storage of property_list: key vector + node-based hash map
+// Author:      Piotr Likus
+// Created:     01/09/2015
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_HASH_H__
+#define __PROP_LIST_HASH_H__
+
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <tuple>
+
+#include "property_list_storage.h"
+
+/// storage with keys in vector and values in unordered_map, removed keys stay in vector until reorg
+template<typename KeyType, typename ValueType, typename Allocator>
+class property_list_storage<KeyType, ValueType, Allocator, property_list_hash_storage> {
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<KeyType> key_allocator_type;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const KeyType, ValueType> > value_allocator_type;
+	typedef std::vector<KeyType, key_allocator_type> key_container_type;
+	typedef std::unordered_map<KeyType, ValueType, std::hash<KeyType>, std::equal_to<KeyType>, value_allocator_type> value_container_type;
+public:
+	typedef key_container_type key_list_type;
+	typedef typename key_container_type::iterator key_iterator;
+	typedef typename key_container_type::const_iterator key_const_iterator;
+	typedef typename value_container_type::iterator value_iterator;
+	typedef typename value_container_type::const_iterator value_const_iterator;
+
+	property_list_storage() : dirty_keys_(false) {}
+
+	explicit property_list_storage(const Allocator &alloc) :
+		dirty_keys_(false),
+		keys_(key_allocator_type(alloc)),
+		values_(value_allocator_type(alloc))
+	{
+	}
+
+	bool operator==(const property_list_storage &rhs) const {
+		return (values_ == rhs.values_) && (keys_ == rhs.keys_);
+	}
+
+	/// sets value of key from args (see property_list_assign), returns true if item was already there
+	template<typename Key, typename... Args>
+	bool put(Key &&key, Args &&... args) {
+		typename value_container_type::iterator found = values_.find(key);
+		if (found != values_.end()) {
+			property_list_assign(found->second, std::forward<Args>(args)...);
+			return true;
+		}
+		keys_.push_back(key);
+		try {
+			values_.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+		catch (...) {
+			keys_.pop_back();
+			throw;
+		}
+		return false;
+	}
+
+	/// prepares storage for a given number of items
+	void reserve(size_t count) {
+		keys_.reserve(count);
+		values_.reserve(count);
+	}
+
+	ValueType *find(const KeyType &key) {
+		typename value_container_type::iterator found = values_.find(key);
+		return (found != values_.end()) ? &(found->second) : nullptr;
+	}
+
+	const ValueType *find(const KeyType &key) const {
+		typename value_container_type::const_iterator found = values_.find(key);
+		return (found != values_.end()) ? &(found->second) : nullptr;
+	}
+
+	/// std::unordered_map calculates its own hash
+	ValueType *find(const property_list_key_handle<KeyType> &key) {
+		return find(key.key());
+	}
+
+	const ValueType *find(const property_list_key_handle<KeyType> &key) const {
+		return find(key.key());
+	}
+
+	/// std::unordered_map needs a key for lookup
+	ValueType *find(const property_list_key_ref &key) {
+		return find(KeyType(key.data(), key.size()));
+	}
+
+	const ValueType *find(const property_list_key_ref &key) const {
+		return find(KeyType(key.data(), key.size()));
+	}
+
+	/// returns true if item was removed
+	bool remove(const KeyType &key) {
+		typename value_container_type::iterator found = values_.find(key);
+		if (found == values_.end())
+			return false;
+		values_.erase(found);
+		dirty_keys_ = true;
+		return true;
+	}
+
+	bool remove(const property_list_key_ref &key) {
+		return remove(KeyType(key.data(), key.size()));
+	}
+
+	void clear() {
+		values_.clear();
+		keys_.clear();
+		dirty_keys_ = false;
+	}
+
+	size_t size() const {
+		return values_.size();
+	}
+
+	bool needs_reorg() const {
+		return dirty_keys_;
+	}
+
+	void reorg() {
+		if (dirty_keys_)
+			purge_keys();
+	}
+
+	/// returns reference to key storage, helper is not used
+	const key_list_type &get_keys(key_list_type &/* helper */) const {
+		if (dirty_keys_)
+			purge_keys();
+		return keys_;
+	}
+
+	/// calls func(key, value) for each item in order of insertion
+	template<typename Func>
+	void for_each(Func func) const {
+		if (dirty_keys_)
+			purge_keys();
+		for (const KeyType &key : keys_)
+			func(key, values_.find(key)->second);
+	}
+
+	template<typename Func>
+	void for_each(Func func) {
+		if (dirty_keys_)
+			purge_keys();
+		for (const KeyType &key : keys_)
+			func(key, values_.find(key)->second);
+	}
+
+	key_iterator keys_begin() {
+		if (dirty_keys_)
+			purge_keys();
+		return keys_.begin();
+	}
+
+	key_iterator keys_end() {
+		return keys_.end();
+	}
+
+	key_const_iterator keys_cbegin() const {
+		if (dirty_keys_)
+			purge_keys();
+		return keys_.cbegin();
+	}
+
+	key_const_iterator keys_cend() const {
+		return keys_.cend();
+	}
+
+	value_iterator values_begin() {
+		return values_.begin();
+	}
+
+	value_iterator values_end() {
+		return values_.end();
+	}
+
+	value_const_iterator values_cbegin() const {
+		return values_.cbegin();
+	}
+
+	value_const_iterator values_cend() const {
+		return values_.cend();
+	}
+
+protected:
+	void purge_keys() const {
+		key_container_type new_keys(keys_.get_allocator());
+		for (const KeyType& key : keys_) {
+			if (values_.find(key) != values_.end())
+				new_keys.push_back(key);
+		}
+		// Cast away const to update the member variables
+		// This is safe because we're maintaining logical constness
+		key_container_type& keys_nonconst = const_cast<key_container_type&>(keys_);
+		bool& dirty_keys_nonconst = const_cast<bool&>(dirty_keys_);
+
+		keys_nonconst = std::move(new_keys);
+		dirty_keys_nonconst = false;
+	}
+
+private:
+	bool dirty_keys_;
+	key_container_type keys_;
+	value_container_type values_;
+};
+
+#endif
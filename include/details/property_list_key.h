@@ -0,0 +1,176 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_key.h
+// Purpose:     Hashing of property_list keys & lookup by text without key construction
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_KEY_H__
+#define __PROP_LIST_KEY_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <functional>
+#include <type_traits>
+#include <atomic>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+/// text used to find item of list with std::string keys, without constructing a key (pointer + length)
+class property_list_key_ref {
+public:
+	property_list_key_ref(const char *text, size_t length) : text_(text), length_(length) {}
+
+	property_list_key_ref(const char *text) : text_(text), length_(std::strlen(text)) {}
+
+	property_list_key_ref(const std::string &text) : text_(text.data()), length_(text.size()) {}
+
+#if __cplusplus >= 201703L
+	property_list_key_ref(std::string_view text) : text_(text.data()), length_(text.size()) {}
+#endif
+
+	const char *data() const {
+		return text_;
+	}
+
+	size_t size() const {
+		return length_;
+	}
+
+	std::string str() const {
+		return std::string(text_, length_);
+	}
+
+private:
+	const char *text_;
+	size_t length_;
+};
+
+inline bool operator==(const std::string &key, const property_list_key_ref &text) {
+	return key.size() == text.size() && std::memcmp(key.data(), text.data(), text.size()) == 0;
+}
+
+inline bool operator==(const property_list_key_ref &text, const std::string &key) {
+	return key == text;
+}
+
+/// reads up to 7 bytes of text with fixed-size loads, overlapping bytes are fine as length is hashed too
+inline uint64_t property_list_read_tail(const char *text, size_t length) {
+	if (length >= 4) {
+		uint32_t low, high;
+		std::memcpy(&low, text, 4);
+		std::memcpy(&high, text + length - 4, 4);
+		return (static_cast<uint64_t>(high) << 32) | low;
+	}
+	if (length > 0) {
+		return (static_cast<uint64_t>(static_cast<unsigned char>(text[0])) << 16) |
+			(static_cast<uint64_t>(static_cast<unsigned char>(text[length >> 1])) << 8) |
+			static_cast<unsigned char>(text[length - 1]);
+	}
+	return 0;
+}
+
+/// hash of text, reads 8 bytes at a time
+inline size_t property_list_hash_text(const char *text, size_t length) {
+	uint64_t hash = 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(length) * 0xff51afd7ed558ccdull);
+	for (; length >= 8; text += 8, length -= 8) {
+		uint64_t word;
+		std::memcpy(&word, text, 8);
+		hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+		hash ^= hash >> 32;
+	}
+	hash = (hash ^ property_list_read_tail(text, length)) * 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	return static_cast<size_t>(hash ^ (hash >> 33));
+}
+
+/// hash of key used by flat, small & shape storages, text keys and their references give equal hashes
+inline size_t property_list_key_hash(const std::string &key) {
+	return property_list_hash_text(key.data(), key.size());
+}
+
+inline size_t property_list_key_hash(const property_list_key_ref &key) {
+	return property_list_hash_text(key.data(), key.size());
+}
+
+template<typename KeyType>
+inline size_t property_list_key_hash(const KeyType &key) {
+	return std::hash<KeyType>()(key);
+}
+
+/// hash kept in entries, lowest bit is set so that 0 can mark removed entry
+template<typename Lookup>
+inline size_t property_list_entry_hash(const Lookup &key) {
+	return property_list_key_hash(key) | 1u;
+}
+
+/// key with hash calculated once, for repeated lookups of the same key in many lists (property_list::key_handle).
+/// Storages with layout shared between lists (shapes) also remember slot of key in the last layout seen,
+/// cache is a single atomic word, so handle can be used by many threads.
+template<typename KeyType>
+class property_list_key_handle {
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	explicit property_list_key_handle(const KeyType &key) :
+		key_(key), hash_(property_list_entry_hash(key)), cache_(0)
+	{
+	}
+
+	property_list_key_handle(const property_list_key_handle &src) :
+		key_(src.key_), hash_(src.hash_), cache_(src.cache_.load(std::memory_order_relaxed))
+	{
+	}
+
+	property_list_key_handle &operator=(const property_list_key_handle &rhs) {
+		key_ = rhs.key_;
+		hash_ = rhs.hash_;
+		cache_.store(rhs.cache_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	const KeyType &key() const {
+		return key_;
+	}
+
+	/// hash as calculated by property_list_entry_hash
+	size_t hash() const {
+		return hash_;
+	}
+
+	/// returns slot remembered for layout with a given id or npos, id 0 is never matched;
+	/// slot is only a hint, storage must check that the key is there
+	size_t cached_slot(uint32_t layout) const {
+		uint64_t cache = cache_.load(std::memory_order_relaxed);
+		return (layout != 0 && static_cast<uint32_t>(cache >> 32) == layout) ? static_cast<size_t>(static_cast<uint32_t>(cache)) : npos;
+	}
+
+	void cache_slot(uint32_t layout, size_t slot) const {
+		cache_.store((static_cast<uint64_t>(layout) << 32) | static_cast<uint32_t>(slot), std::memory_order_relaxed);
+	}
+
+private:
+	KeyType key_;
+	size_t hash_;
+	mutable std::atomic<uint64_t> cache_; // layout id << 32 | slot, 0 = empty
+};
+
+template<typename KeyType>
+const size_t property_list_key_handle<KeyType>::npos;
+
+/// type of Result if Text can be used to find item of list with KeyType keys without constructing key
+/// (const char *, char array, std::string_view and property_list_key_ref for std::string keys)
+template<typename KeyType, typename Text, typename Result>
+struct property_list_text_lookup :
+	std::enable_if<std::is_same<KeyType, std::string>::value && !std::is_same<Text, std::string>::value &&
+		std::is_convertible<const Text &, property_list_key_ref>::value, Result>
+{
+};
+
+#endif
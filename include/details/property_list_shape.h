@@ -0,0 +1,704 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_shape.h
+// Purpose:     Storage of property_list: shared key layout (shape) + dense value vector
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_SHAPE_H__
+#define __PROP_LIST_SHAPE_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <iterator>
+#include <memory>
+
+#include "property_list_storage.h"
+#include "property_list_flat.h"
+
+/// Keys of a chain of shapes: shape with n keys uses the first n keys of its layout, so a child which adds
+/// the next key extends layout of its parent in place. Layout is copied with doubled capacity when it is full
+/// or when another child already extended it, so building a shape with n keys costs amortized O(n).
+/// Published keys are never changed, other threads can read them while layout is extended.
+/// Large layouts have open addressing index, its entries are atomic as they are added while being read.
+template<typename KeyType>
+class property_list_shape_layout {
+	enum { min_capacity = 4, linear_find_limit = 8 };
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	/// layout with a copy of the first size keys of src (src can be null for empty layout)
+	property_list_shape_layout(const property_list_shape_layout *src, size_t size) :
+		capacity_(capacity_for(size + 1)), keys_(key_allocator().allocate(capacity_)),
+		hashes_(new size_t[capacity_]), claimed_(0), shift_(0), mask_(0)
+	{
+		if (capacity_ > linear_find_limit) {
+			size_t slots = capacity_ * 2, bits = 0;
+			for (size_t i = slots; i > 1; i /= 2)
+				++bits;
+			index_.reset(new std::atomic<uint32_t>[slots]);
+			for (size_t i = 0; i < slots; ++i)
+				index_[i].store(0, std::memory_order_relaxed);
+			shift_ = 64 - bits;
+			mask_ = slots - 1;
+		}
+		try {
+			for (size_t i = 0; i < size; ++i)
+				append(i, src->keys_[i], src->hashes_[i]);
+		}
+		catch (...) {
+			destroy_keys();
+			throw;
+		}
+		claimed_.store(size, std::memory_order_relaxed);
+	}
+
+	~property_list_shape_layout() {
+		destroy_keys();
+	}
+
+	const KeyType *keys() const {
+		return keys_;
+	}
+
+	/// adds key at position size if it is the next free position, returns false if layout has to be copied
+	bool try_append(size_t size, const KeyType &key, size_t hash) {
+		if (size >= capacity_)
+			return false;
+		size_t expected = size;
+		if (!claimed_.compare_exchange_strong(expected, size + 1, std::memory_order_relaxed))
+			return false;
+		try {
+			append(size, key, hash);
+		}
+		catch (...) {
+			// position is not visible to any shape yet
+			claimed_.store(size, std::memory_order_relaxed);
+			throw;
+		}
+		return true;
+	}
+
+	/// true if key with a given hash is at position pos among the first size keys
+	template<typename Lookup>
+	bool holds(size_t pos, const Lookup &key, size_t hash, size_t size) const {
+		return pos < size && hashes_[pos] == hash && keys_[pos] == key;
+	}
+
+	/// returns position of key among the first size keys or npos
+	template<typename Lookup>
+	size_t find(const Lookup &key, size_t hash, size_t size) const {
+		if (!index_) {
+			for (size_t i = 0; i < size; ++i) {
+				if (hashes_[i] == hash && keys_[i] == key)
+					return i;
+			}
+			return npos;
+		}
+		for (size_t pos = home_slot(hash);; pos = (pos + 1) & mask_) {
+			uint32_t entry = index_[pos].load(std::memory_order_relaxed);
+			if (entry == 0)
+				return npos;
+			// entries of longer shapes are skipped, their keys can be written right now
+			size_t i = entry - 1;
+			if (i < size && hashes_[i] == hash && keys_[i] == key)
+				return i;
+		}
+	}
+
+private:
+	typedef std::allocator<KeyType> key_allocator;
+
+	property_list_shape_layout(const property_list_shape_layout &);
+	property_list_shape_layout &operator=(const property_list_shape_layout &);
+
+	static size_t capacity_for(size_t count) {
+		size_t capacity = min_capacity;
+		while (capacity < count)
+			capacity *= 2;
+		return capacity;
+	}
+
+	size_t home_slot(size_t hash) const {
+		return static_cast<size_t>((static_cast<unsigned long long>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+	}
+
+	void append(size_t pos, const KeyType &key, size_t hash) {
+		key_allocator alloc;
+		std::allocator_traits<key_allocator>::construct(alloc, keys_ + pos, key);
+		hashes_[pos] = hash;
+		if (index_) {
+			size_t slot = home_slot(hash);
+			while (index_[slot].load(std::memory_order_relaxed) != 0)
+				slot = (slot + 1) & mask_;
+			index_[slot].store(static_cast<uint32_t>(pos + 1), std::memory_order_release);
+		}
+	}
+
+	void destroy_keys() {
+		key_allocator alloc;
+		size_t count = claimed_.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < count; ++i)
+			std::allocator_traits<key_allocator>::destroy(alloc, keys_ + i);
+		alloc.deallocate(keys_, capacity_);
+	}
+
+	size_t capacity_;
+	KeyType *keys_;
+	std::unique_ptr<size_t[]> hashes_;
+	std::atomic<size_t> claimed_;  // number of positions taken by shapes
+	std::unique_ptr<std::atomic<uint32_t>[]> index_;
+	unsigned shift_;
+	size_t mask_;
+};
+
+template<typename KeyType>
+const size_t property_list_shape_layout<KeyType>::npos;
+
+/// Immutable list of keys shared by all objects with the same keys in the same order (hidden class).
+/// Shapes form a tree: child shape has one key more than its parent, transitions from parent to children
+/// are kept, so objects built in the same way end with the same shape.
+/// Shape holds its parent, last key and position of the key in shared layout, so a shape with n keys
+/// takes O(1) memory and all its ancestors O(n).
+///
+/// Transitions are append-only lists published with release / acquire, so finding an existing transition
+/// does not lock; a mutex (from a shared pool) is taken only to create a new shape. Removing a key is
+/// remembered as a transition too. Shapes stay in the tree when objects using them are destroyed, so
+/// records created & discarded in a loop reuse their shapes; trim() destroys shapes which are not used.
+/// Shapes are allocated from the heap regardless of allocator of objects.
+template<typename KeyType>
+class property_list_shape {
+	typedef property_list_shape_layout<KeyType> layout_type;
+	enum { expected_size_depth = 64, mutex_count = 16 };
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	/// shape without keys, it is never destroyed
+	static const property_list_shape *root() {
+		static const property_list_shape *shape = new property_list_shape();
+		return shape;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	/// returns array of size() keys in order of insertion
+	const KeyType *keys() const {
+		return layout_ ? layout_->keys() : nullptr;
+	}
+
+	/// returns number of keys of the largest shape created from this one, used to reserve space for values
+	size_t expected_size() const {
+		return expected_size_.load(std::memory_order_relaxed);
+	}
+
+	/// unique number of shape, never 0
+	uint32_t id() const {
+		return id_;
+	}
+
+	/// returns slot number of key or npos
+	template<typename Lookup>
+	size_t find(const Lookup &key) const {
+		return find_hashed(key, property_list_entry_hash(key));
+	}
+
+	/// returns slot number of key handle or npos, slot is remembered in handle for this shape;
+	/// remembered slot is checked against key, as ids of shapes repeat after counter wraps
+	size_t find(const property_list_key_handle<KeyType> &key) const {
+		size_t slot = key.cached_slot(id_);
+		if (slot == npos || !layout_ || !layout_->holds(slot, key.key(), key.hash(), size_)) {
+			slot = find_hashed(key.key(), key.hash());
+			if (slot != npos)
+				key.cache_slot(id_, slot);
+		}
+		return slot;
+	}
+
+	/// returns slot number of key with hash calculated by property_list_entry_hash or npos
+	template<typename Lookup>
+	size_t find_hashed(const Lookup &key, size_t hash) const {
+		return layout_ ? layout_->find(key, hash, size_) : npos;
+	}
+
+	/// returns shape with key added at the end, key must not be in this shape
+	const property_list_shape *add(const KeyType &key) const {
+		size_t hash = property_list_entry_hash(key);
+		const property_list_shape *child = find_child(key, hash);
+		if (child != nullptr)
+			return child;
+
+		std::lock_guard<std::mutex> lock(transition_mutex(this));
+		child = find_child(key, hash);
+		if (child != nullptr)
+			return child;
+		property_list_shape *created = new property_list_shape(this, key, hash);
+		created->next_sibling_ = first_child_.load(std::memory_order_relaxed);
+		first_child_.store(created, std::memory_order_release);
+
+		const property_list_shape *shape = this;
+		for (int depth = 0; shape != nullptr && depth < expected_size_depth; shape = shape->parent_, ++depth) {
+			if (!shape->update_expected_size(created->size()))
+				break;
+		}
+		return created;
+	}
+
+	/// returns shape with key of a given slot removed
+	const property_list_shape *remove(size_t slot) const {
+		for (const removal *item = first_removal_.load(std::memory_order_acquire); item != nullptr; item = item->next_) {
+			if (item->slot_ == slot)
+				return item->target_;
+		}
+
+		const property_list_shape *result = root();
+		const KeyType *keys = this->keys();
+		for (size_t i = 0; i < size_; ++i) {
+			if (i != slot)
+				result = result->add(keys[i]);
+		}
+
+		std::lock_guard<std::mutex> lock(transition_mutex(this));
+		removal *first = first_removal_.load(std::memory_order_relaxed);
+		for (const removal *item = first; item != nullptr; item = item->next_) {
+			if (item->slot_ == slot)
+				return item->target_;
+		}
+		first_removal_.store(new removal(slot, result, first), std::memory_order_release);
+		return result;
+	}
+
+	/// counts object using shape, shapes used by objects are kept by trim(); root is not counted
+	static void acquire(const property_list_shape *shape) {
+		if (shape->parent_ != nullptr)
+			shape->refs_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void release(const property_list_shape *shape) {
+		if (shape->parent_ != nullptr)
+			shape->refs_.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/// destroys shapes which are not used by objects and have no used descendants, remembered removals
+	/// are forgotten; returns number of destroyed shapes.
+	/// Transitions are read without locks, so no other thread can add or remove keys of shaped objects
+	/// (of this key type) while trim() runs.
+	static size_t trim() {
+		std::unique_lock<std::mutex> locks[mutex_count];
+		for (int i = 0; i < mutex_count; ++i)
+			locks[i] = std::unique_lock<std::mutex>(mutexes()[i]);
+
+		// parents are listed before children, so shapes are checked from leaves up
+		std::vector<const property_list_shape *> shapes(1, root());
+		for (size_t i = 0; i < shapes.size(); ++i) {
+			shapes[i]->clear_removals();
+			for (const property_list_shape *child = shapes[i]->first_child_.load(std::memory_order_relaxed); child != nullptr; child = child->next_sibling_)
+				shapes.push_back(child);
+		}
+
+		size_t count = 0;
+		for (size_t i = shapes.size(); i-- > 1; ) {
+			const property_list_shape *shape = shapes[i];
+			if (shape->refs_.load(std::memory_order_relaxed) != 0 || shape->first_child_.load(std::memory_order_relaxed) != nullptr)
+				continue;
+			shape->parent_->unlink_child(shape);
+			delete shape;
+			++count;
+		}
+		return count;
+	}
+
+private:
+	/// remembered result of remove(slot)
+	struct removal {
+		removal(size_t slot, const property_list_shape *target, removal *next) : slot_(slot), target_(target), next_(next) {}
+
+		size_t slot_;
+		const property_list_shape *target_;
+		removal *next_;
+	};
+
+	property_list_shape() :
+		parent_(nullptr), size_(0), hash_(0), id_(next_id()), refs_(0), expected_size_(0),
+		first_child_(nullptr), next_sibling_(nullptr), first_removal_(nullptr)
+	{
+	}
+
+	/// layout of parent is extended if possible
+	property_list_shape(const property_list_shape *parent, const KeyType &key, size_t hash) :
+		parent_(parent), size_(parent->size_ + 1), hash_(hash), id_(next_id()), refs_(0), expected_size_(size_),
+		first_child_(nullptr), next_sibling_(nullptr), first_removal_(nullptr)
+	{
+		if (!parent->layout_ || !parent->layout_->try_append(parent->size_, key, hash)) {
+			layout_ = std::make_shared<layout_type>(parent->layout_.get(), parent->size_);
+			if (!layout_->try_append(parent->size_, key, hash))
+				throw std::logic_error("property_list_shape: new layout is full");
+		} else {
+			layout_ = parent->layout_;
+		}
+	}
+
+	~property_list_shape() {
+		clear_removals();
+	}
+
+	property_list_shape(const property_list_shape &);
+	property_list_shape &operator=(const property_list_shape &);
+
+	/// 0 marks empty cache of key handles, so it is skipped when counter wraps
+	static uint32_t next_id() {
+		static std::atomic<uint32_t> counter(0);
+		uint32_t id;
+		do {
+			id = counter.fetch_add(1, std::memory_order_relaxed) + 1;
+		} while (id == 0);
+		return id;
+	}
+
+	/// pool of mutexes which guard creation of transitions, it is never destroyed,
+	/// as objects destroyed at exit can still use shapes
+	static std::mutex *mutexes() {
+		static std::mutex *pool = new std::mutex[mutex_count];
+		return pool;
+	}
+
+	static std::mutex &transition_mutex(const property_list_shape *shape) {
+		return mutexes()[(reinterpret_cast<uintptr_t>(shape) / sizeof(property_list_shape)) % mutex_count];
+	}
+
+	const KeyType &last_key() const {
+		return layout_->keys()[size_ - 1];
+	}
+
+	const property_list_shape *find_child(const KeyType &key, size_t hash) const {
+		for (const property_list_shape *child = first_child_.load(std::memory_order_acquire); child != nullptr; child = child->next_sibling_) {
+			if (child->hash_ == hash && child->last_key() == key)
+				return child;
+		}
+		return nullptr;
+	}
+
+	void unlink_child(const property_list_shape *child) const {
+		const property_list_shape *first = first_child_.load(std::memory_order_relaxed);
+		if (first == child) {
+			first_child_.store(child->next_sibling_, std::memory_order_relaxed);
+			return;
+		}
+		for (const property_list_shape *prev = first; prev != nullptr; prev = prev->next_sibling_) {
+			if (prev->next_sibling_ == child) {
+				const_cast<property_list_shape *>(prev)->next_sibling_ = child->next_sibling_;
+				return;
+			}
+		}
+	}
+
+	void clear_removals() const {
+		removal *item = first_removal_.load(std::memory_order_relaxed);
+		first_removal_.store(nullptr, std::memory_order_relaxed);
+		while (item != nullptr) {
+			removal *next = item->next_;
+			delete item;
+			item = next;
+		}
+	}
+
+	/// returns false if expected size was already at least size
+	bool update_expected_size(size_t size) const {
+		size_t current = expected_size_.load(std::memory_order_relaxed);
+		while (current < size) {
+			if (expected_size_.compare_exchange_weak(current, size, std::memory_order_relaxed))
+				return true;
+		}
+		return false;
+	}
+
+	const property_list_shape *parent_;
+	size_t size_;
+	size_t hash_;  // hash of last key
+	uint32_t id_;
+	std::shared_ptr<layout_type> layout_;
+	mutable std::atomic<size_t> refs_;                            // number of objects using shape
+	mutable std::atomic<size_t> expected_size_;
+	mutable std::atomic<const property_list_shape *> first_child_; // transitions which add a key
+	const property_list_shape *next_sibling_;                      // next child of parent, set before child is published
+	mutable std::atomic<removal *> first_removal_;                 // transitions which remove a key
+};
+
+template<typename KeyType>
+const size_t property_list_shape<KeyType>::npos;
+
+/// iterator over keys of shape and values of object, dereference returns item with references
+template<typename KeyType, typename ValueType>
+class property_list_shape_iterator {
+public:
+	typedef property_list_item<KeyType, ValueType> item_type;
+	typedef std::input_iterator_tag iterator_category;
+	typedef item_type value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef item_type reference;
+	typedef property_list_item_pointer<KeyType, ValueType> pointer;
+
+	property_list_shape_iterator() : key_(nullptr), value_(nullptr) {}
+
+	property_list_shape_iterator(const KeyType *key, ValueType *value) : key_(key), value_(value) {}
+
+	reference operator*() const {
+		item_type result = { *key_, *value_ };
+		return result;
+	}
+
+	pointer operator->() const {
+		return pointer(**this);
+	}
+
+	property_list_shape_iterator &operator++() {
+		++key_;
+		++value_;
+		return *this;
+	}
+
+	property_list_shape_iterator operator++(int) {
+		property_list_shape_iterator result(*this);
+		++(*this);
+		return result;
+	}
+
+	bool operator==(const property_list_shape_iterator &rhs) const {
+		return value_ == rhs.value_;
+	}
+
+	bool operator!=(const property_list_shape_iterator &rhs) const {
+		return value_ != rhs.value_;
+	}
+
+private:
+	const KeyType *key_;
+	ValueType *value_;
+};
+
+/// Object holds a counted reference to shape and values in order of keys of shape.
+/// Adding a key moves object to a child shape, removing a key moves it to a shape without the key,
+/// so there are no tombstones and reorg is never needed.
+template<typename KeyType, typename ValueType, typename Allocator>
+class property_list_storage<KeyType, ValueType, Allocator, property_list_shape_storage> {
+	typedef property_list_shape<KeyType> shape_type;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<ValueType> value_allocator_type;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<KeyType> key_allocator_type;
+	typedef std::vector<ValueType, value_allocator_type> value_container_type;
+public:
+	typedef std::vector<KeyType, key_allocator_type> key_list_type;
+	typedef const KeyType *key_iterator;
+	typedef const KeyType *key_const_iterator;
+	typedef property_list_shape_iterator<KeyType, ValueType> value_iterator;
+	typedef property_list_shape_iterator<KeyType, const ValueType> value_const_iterator;
+
+	property_list_storage() : shape_(shape_type::root()) {}
+
+	explicit property_list_storage(const Allocator &alloc) :
+		shape_(shape_type::root()), values_(value_allocator_type(alloc))
+	{
+	}
+
+	property_list_storage(const property_list_storage &src) :
+		shape_(src.shape_), values_(src.values_)
+	{
+		shape_type::acquire(shape_);
+	}
+
+	property_list_storage(property_list_storage &&src) :
+		shape_(src.shape_), values_(std::move(src.values_))
+	{
+		src.shape_ = shape_type::root();
+		src.values_.clear();
+	}
+
+	~property_list_storage() {
+		shape_type::release(shape_);
+	}
+
+	property_list_storage &operator=(const property_list_storage &rhs) {
+		if (this != &rhs) {
+			values_ = rhs.values_;
+			set_shape(rhs.shape_);
+		}
+		return *this;
+	}
+
+	property_list_storage &operator=(property_list_storage &&rhs) {
+		if (this != &rhs) {
+			values_ = std::move(rhs.values_);
+			shape_type::release(shape_);
+			shape_ = rhs.shape_;
+			rhs.values_.clear();
+			rhs.shape_ = shape_type::root();
+		}
+		return *this;
+	}
+
+	/// lists are equal if they have the same items in the same order
+	bool operator==(const property_list_storage &rhs) const {
+		if (values_.size() != rhs.values_.size())
+			return false;
+		if (shape_ != rhs.shape_ && !std::equal(keys_cbegin(), keys_cend(), rhs.keys_cbegin()))
+			return false;
+		for (size_t i = 0; i < values_.size(); ++i) {
+			if (!(values_[i] == rhs.values_[i]))
+				return false;
+		}
+		return true;
+	}
+
+	/// sets value of key from args (see property_list_assign), returns true if item was already there
+	template<typename Key, typename... Args>
+	bool put(Key &&key, Args &&... args) {
+		size_t slot = shape_->find(key);
+		if (slot != shape_type::npos) {
+			property_list_assign(values_[slot], std::forward<Args>(args)...);
+			return true;
+		}
+		if (values_.size() == values_.capacity() && shape_->expected_size() > values_.size()) {
+			// args can refer to item of this list
+			ValueType added(std::forward<Args>(args)...);
+			values_.reserve(shape_->expected_size());
+			values_.push_back(std::move(added));
+		} else {
+			values_.emplace_back(std::forward<Args>(args)...);
+		}
+		try {
+			const shape_type *next = shape_->add(key);
+			shape_type::acquire(next);
+			shape_type::release(shape_);
+			shape_ = next;
+		}
+		catch (...) {
+			values_.pop_back();
+			throw;
+		}
+		return false;
+	}
+
+	/// prepares storage for a given number of values
+	void reserve(size_t count) {
+		values_.reserve(count);
+	}
+
+	template<typename Lookup>
+	ValueType *find(const Lookup &key) {
+		size_t slot = shape_->find(key);
+		return (slot != shape_type::npos) ? &values_[slot] : nullptr;
+	}
+
+	template<typename Lookup>
+	const ValueType *find(const Lookup &key) const {
+		size_t slot = shape_->find(key);
+		return (slot != shape_type::npos) ? &values_[slot] : nullptr;
+	}
+
+	/// returns true if item was removed
+	template<typename Lookup>
+	bool remove(const Lookup &key) {
+		size_t slot = shape_->find(key);
+		if (slot == shape_type::npos)
+			return false;
+		const shape_type *next = shape_->remove(slot);
+		values_.erase(values_.begin() + static_cast<std::ptrdiff_t>(slot));
+		shape_type::acquire(next);
+		shape_type::release(shape_);
+		shape_ = next;
+		return true;
+	}
+
+	void clear() {
+		values_.clear();
+		set_shape(shape_type::root());
+	}
+
+	size_t size() const {
+		return values_.size();
+	}
+
+	bool needs_reorg() const {
+		return false;
+	}
+
+	void reorg() {
+	}
+
+	/// fills helper with keys of shape, returns reference to helper
+	const key_list_type &get_keys(key_list_type &helper) const {
+		helper.assign(keys_cbegin(), keys_cend());
+		return helper;
+	}
+
+	/// calls func(key, value) for each item in order of insertion
+	template<typename Func>
+	void for_each(Func func) const {
+		const KeyType *keys = shape_->keys();
+		for (size_t i = 0; i < values_.size(); ++i)
+			func(keys[i], values_[i]);
+	}
+
+	template<typename Func>
+	void for_each(Func func) {
+		const KeyType *keys = shape_->keys();
+		for (size_t i = 0; i < values_.size(); ++i)
+			func(keys[i], values_[i]);
+	}
+
+	key_iterator keys_begin() {
+		return shape_->keys();
+	}
+
+	key_iterator keys_end() {
+		return shape_->keys() + values_.size();
+	}
+
+	key_const_iterator keys_cbegin() const {
+		return shape_->keys();
+	}
+
+	key_const_iterator keys_cend() const {
+		return shape_->keys() + values_.size();
+	}
+
+	value_iterator values_begin() {
+		return value_iterator(shape_->keys(), values_.data());
+	}
+
+	value_iterator values_end() {
+		return value_iterator(shape_->keys() + values_.size(), values_.data() + values_.size());
+	}
+
+	value_const_iterator values_cbegin() const {
+		return value_const_iterator(shape_->keys(), values_.data());
+	}
+
+	value_const_iterator values_cend() const {
+		return value_const_iterator(shape_->keys() + values_.size(), values_.data() + values_.size());
+	}
+
+	/// returns shape of object, objects with the same keys in the same order share shape
+	const shape_type *shape() const {
+		return shape_;
+	}
+
+private:
+	void set_shape(const shape_type *shape) {
+		shape_type::acquire(shape);
+		shape_type::release(shape_);
+		shape_ = shape;
+	}
+
+	const shape_type *shape_;
+	value_container_type values_;
+};
+
+#endif
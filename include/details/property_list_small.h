@@ -0,0 +1,444 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_small.h
+// Purpose:     Storage of property_list: inline entries with linear scan, promoted to flat storage
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_SMALL_H__
+#define __PROP_LIST_SMALL_H__
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "property_list_storage.h"
+#include "property_list_flat.h"
+
+/// Up to InlineCount entries are kept in an array inside of the list, without allocation and without index.
+/// Lookup compares cached hashes of entries one by one, which for a few entries is faster than probing.
+/// When an item which does not fit is added, all entries are moved to property_list_flat_storage
+/// and the list stays promoted (also after clear), copies of small promoted lists are inline again.
+/// Inline entries and flat storage are members of a union selected by promoted(), so promoted list
+/// does not keep the unused inline array.
+template<typename KeyType, typename ValueType, typename Allocator, size_t InlineCount>
+class property_list_storage<KeyType, ValueType, Allocator, property_list_small_storage<InlineCount> > {
+	static_assert(InlineCount > 0, "inline count must be positive");
+
+	typedef property_list_storage<KeyType, ValueType, Allocator, property_list_flat_storage> large_storage_type;
+public:
+	typedef typename large_storage_type::entry entry;
+	typedef typename large_storage_type::key_list_type key_list_type;
+	typedef typename large_storage_type::key_iterator key_iterator;
+	typedef typename large_storage_type::key_const_iterator key_const_iterator;
+	typedef typename large_storage_type::value_iterator value_iterator;
+	typedef typename large_storage_type::value_const_iterator value_const_iterator;
+
+	property_list_storage() : inline_(Allocator()), used_(0), live_(0), promoted_(false) {}
+
+	explicit property_list_storage(const Allocator &alloc) :
+		inline_(alloc), used_(0), live_(0), promoted_(false)
+	{
+	}
+
+	property_list_storage(const property_list_storage &src) :
+		inline_(std::allocator_traits<Allocator>::select_on_container_copy_construction(src.get_allocator())),
+		used_(0), live_(0), promoted_(false)
+	{
+		try {
+			copy_items(src);
+		}
+		catch (...) {
+			destroy_layout();
+			throw;
+		}
+	}
+
+	property_list_storage(property_list_storage &&src) : used_(0), live_(0), promoted_(src.promoted_) {
+		if (promoted_) {
+			new (&large_) large_storage_type(std::move(src.large_));
+			src.use_inline_layout();
+		}
+		else {
+			new (&inline_) inline_items(src.get_allocator());
+			move_items(src);
+		}
+	}
+
+	~property_list_storage() {
+		destroy_layout();
+	}
+
+	property_list_storage &operator=(const property_list_storage &rhs) {
+		if (this != &rhs)
+			copy_items(rhs);
+		return *this;
+	}
+
+	property_list_storage &operator=(property_list_storage &&rhs) {
+		if (this != &rhs) {
+			if (rhs.promoted_) {
+				use_large_layout();
+				large_ = std::move(rhs.large_);
+				rhs.use_inline_layout();
+			}
+			else {
+				use_inline_layout();
+				move_items(rhs);
+			}
+		}
+		return *this;
+	}
+
+	Allocator get_allocator() const {
+		return promoted_ ? large_.get_allocator() : Allocator(inline_);
+	}
+
+	/// lists are equal if they have the same items in the same order
+	bool operator==(const property_list_storage &rhs) const {
+		if (size() != rhs.size())
+			return false;
+		value_const_iterator it = values_cbegin(), rit = rhs.values_cbegin(), end = values_cend();
+		for (; it != end; ++it, ++rit) {
+			if (!(it->first == rit->first) || !(it->second == rit->second))
+				return false;
+		}
+		return true;
+	}
+
+	/// sets value of key from args (see property_list_assign), returns true if item was already there
+	template<typename Key, typename... Args>
+	bool put(Key &&key, Args &&... args) {
+		if (promoted_)
+			return large_.put(std::forward<Key>(key), std::forward<Args>(args)...);
+
+		size_t hash = property_list_entry_hash(key);
+		entry *found = find_inline(key, hash);
+		if (found != nullptr) {
+			property_list_assign(found->second, std::forward<Args>(args)...);
+			return true;
+		}
+
+		if (used_ == InlineCount) {
+			if (live_ == used_) {
+				// args can refer to inline item which is moved during promotion
+				ValueType added(std::forward<Args>(args)...);
+				promote(InlineCount * 2);
+				large_.put_hashed(std::forward<Key>(key), hash, std::move(added));
+				return false;
+			}
+			compact();
+		}
+
+		append(hash, std::forward<Key>(key), std::forward<Args>(args)...);
+		return false;
+	}
+
+	/// prepares storage for a given number of items, items are moved to flat storage if they do not fit inline
+	void reserve(size_t count) {
+		if (promoted_)
+			large_.reserve(count);
+		else if (count > InlineCount)
+			promote(count);
+	}
+
+	template<typename Lookup>
+	ValueType *find(const Lookup &key) {
+		if (promoted_)
+			return large_.find(key);
+		entry *found = find_inline(key, property_list_entry_hash(key));
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	template<typename Lookup>
+	const ValueType *find(const Lookup &key) const {
+		if (promoted_)
+			return large_.find(key);
+		entry *found = find_inline(key, property_list_entry_hash(key));
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	ValueType *find(const property_list_key_handle<KeyType> &key) {
+		if (promoted_)
+			return large_.find(key);
+		entry *found = find_inline(key.key(), key.hash());
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	const ValueType *find(const property_list_key_handle<KeyType> &key) const {
+		if (promoted_)
+			return large_.find(key);
+		entry *found = find_inline(key.key(), key.hash());
+		return (found != nullptr) ? &(found->second) : nullptr;
+	}
+
+	/// returns true if item was removed
+	template<typename Lookup>
+	bool remove(const Lookup &key) {
+		if (promoted_)
+			return large_.remove(key);
+
+		entry *found = find_inline(key, property_list_entry_hash(key));
+		if (found == nullptr)
+			return false;
+		// entry stays as tombstone, so that iterators of items which follow it are valid
+		found->hash_ = 0;
+		found->second = ValueType();
+		--live_;
+		return true;
+	}
+
+	void clear() {
+		if (promoted_)
+			large_.clear();
+		else
+			destroy_items();
+	}
+
+	size_t size() const {
+		return promoted_ ? large_.size() : live_;
+	}
+
+	bool needs_reorg() const {
+		return promoted_ ? large_.needs_reorg() : (used_ != live_);
+	}
+
+	void reorg() {
+		if (promoted_)
+			large_.reorg();
+		else if (used_ != live_)
+			compact();
+	}
+
+	/// fills helper with keys, returns reference to helper
+	const key_list_type &get_keys(key_list_type &helper) const {
+		if (promoted_)
+			return large_.get_keys(helper);
+		helper.clear();
+		helper.reserve(live_);
+		for (key_const_iterator it = keys_cbegin(), end = keys_cend(); it != end; ++it)
+			helper.push_back(*it);
+		return helper;
+	}
+
+	/// calls func(key, value) for each item in order of insertion
+	template<typename Func>
+	void for_each(Func func) const {
+		for (value_const_iterator it = values_cbegin(), end = values_cend(); it != end; ++it)
+			func(it->first, it->second);
+	}
+
+	template<typename Func>
+	void for_each(Func func) {
+		for (value_iterator it = values_begin(), end = values_end(); it != end; ++it)
+			func(it->first, it->second);
+	}
+
+	/// inline entries are compacted before iteration, promoted ones only above tombstone threshold;
+	/// iterators skip tombstones, so keys_end does not change entries and items can be removed while iterating
+	key_iterator keys_begin() {
+		if (needs_reorg())
+			reorg();
+		return promoted_ ? large_.keys_begin() : key_iterator(items(), items() + used_);
+	}
+
+	key_iterator keys_end() {
+		return promoted_ ? large_.keys_end() : key_iterator(items() + used_, items() + used_);
+	}
+
+	key_const_iterator keys_cbegin() const {
+		return promoted_ ? large_.keys_cbegin() : key_const_iterator(items(), items() + used_);
+	}
+
+	key_const_iterator keys_cend() const {
+		return promoted_ ? large_.keys_cend() : key_const_iterator(items() + used_, items() + used_);
+	}
+
+	value_iterator values_begin() {
+		return promoted_ ? large_.values_begin() : value_iterator(items(), items() + used_);
+	}
+
+	value_iterator values_end() {
+		return promoted_ ? large_.values_end() : value_iterator(items() + used_, items() + used_);
+	}
+
+	value_const_iterator values_cbegin() const {
+		return promoted_ ? large_.values_cbegin() : value_const_iterator(items(), items() + used_);
+	}
+
+	value_const_iterator values_cend() const {
+		return promoted_ ? large_.values_cend() : value_const_iterator(items() + used_, items() + used_);
+	}
+
+	/// returns true if items are stored in flat storage
+	bool promoted() const {
+		return promoted_;
+	}
+
+private:
+	/// inline entries, allocator is kept for promotion and takes no space when it is empty
+	struct inline_items : Allocator {
+		explicit inline_items(const Allocator &alloc) : Allocator(alloc) {}
+
+		alignas(entry) unsigned char buffer_[sizeof(entry) * InlineCount];
+	};
+
+	entry *items() const {
+		return reinterpret_cast<entry *>(const_cast<unsigned char *>(inline_.buffer_));
+	}
+
+	template<typename Lookup>
+	entry *find_inline(const Lookup &key, size_t hash) const {
+		entry *item = items();
+		for (entry *end = item + used_; item != end; ++item) {
+			if (item->hash_ == hash && item->first == key)
+				return item;
+		}
+		return nullptr;
+	}
+
+	template<typename Key, typename... Args>
+	void append(size_t hash, Key &&key, Args &&... args) {
+		new (static_cast<void *>(items() + used_)) entry(hash, std::forward<Key>(key), std::forward<Args>(args)...);
+		++used_;
+		++live_;
+	}
+
+	static void destroy(entry *item) {
+		item->~entry();
+	}
+
+	void destroy_items() {
+		for (size_t i = 0; i < used_; ++i)
+			destroy(items() + i);
+		used_ = live_ = 0;
+	}
+
+	/// moves live entries to the beginning of array,
+	/// if key copy fails entries which were not moved yet are dropped
+	void compact() {
+		entry *base = items();
+		size_t write = 0, i = 0;
+		try {
+			for (; i < used_; ++i) {
+				entry &item = base[i];
+				if (item.hash_ != 0 && write != i)
+					new (static_cast<void *>(base + write)) entry(item.hash_, std::move_if_noexcept(item.first), std::move(item.second));
+				if (item.hash_ != 0)
+					++write;
+				if (item.hash_ == 0 || write <= i)
+					destroy(&item);
+			}
+		}
+		catch (...) {
+			for (; i < used_; ++i)
+				destroy(base + i);
+			used_ = live_ = write;
+			throw;
+		}
+		used_ = live_ = write;
+	}
+
+	/// destroys active member of layout union
+	void destroy_layout() {
+		if (promoted_) {
+			large_.~large_storage_type();
+		}
+		else {
+			destroy_items();
+			inline_.~inline_items();
+		}
+	}
+
+	/// switches list to empty inline entries, flat storage is released
+	void use_inline_layout() {
+		if (!promoted_) {
+			destroy_items();
+			return;
+		}
+		Allocator alloc(get_allocator());
+		large_.~large_storage_type();
+		new (&inline_) inline_items(alloc);
+		promoted_ = false;
+	}
+
+	/// switches list to empty flat storage, inline entries are removed
+	void use_large_layout() {
+		if (promoted_) {
+			large_.clear();
+			return;
+		}
+		Allocator alloc(get_allocator());
+		destroy_layout();
+		new (&large_) large_storage_type(alloc);
+		promoted_ = true;
+	}
+
+	/// moves items to flat storage prepared for a given number of items
+	void promote(size_t count) {
+		large_storage_type large(get_allocator());
+		large.reserve(count);
+		for (entry *item = items(), *end = items() + used_; item != end; ++item) {
+			if (item->hash_ != 0)
+				large.put_hashed(std::move_if_noexcept(item->first), item->hash_, std::move(item->second));
+		}
+		destroy_layout();
+		new (&large_) large_storage_type(std::move(large));
+		promoted_ = true;
+	}
+
+	/// replaces items with copies of items of src, small lists are stored inline
+	void copy_items(const property_list_storage &src) {
+		if (src.size() > InlineCount) {
+			use_large_layout();
+			large_ = src.large_;
+			return;
+		}
+		use_inline_layout();
+		try {
+			if (src.promoted_) {
+				for (value_const_iterator it = src.values_cbegin(), end = src.values_cend(); it != end; ++it)
+					append(property_list_entry_hash(it->first), it->first, it->second);
+			}
+			else {
+				for (const entry *item = src.items(), *end = src.items() + src.used_; item != end; ++item) {
+					if (item->hash_ != 0)
+						append(item->hash_, item->first, item->second);
+				}
+			}
+		}
+		catch (...) {
+			destroy_items();
+			throw;
+		}
+	}
+
+	/// moves inline items of src to empty inline storage, src is left empty
+	void move_items(property_list_storage &src) {
+		try {
+			for (size_t i = 0; i < src.used_; ++i) {
+				entry &item = src.items()[i];
+				if (item.hash_ != 0)
+					append(item.hash_, std::move_if_noexcept(item.first), std::move(item.second));
+			}
+		}
+		catch (...) {
+			destroy_items();
+			src.destroy_items();
+			throw;
+		}
+		src.destroy_items();
+	}
+
+	// only one layout is constructed
+	union {
+		inline_items inline_;       // used if promoted_ is false
+		large_storage_type large_;  // used if promoted_ is true
+	};
+	size_t used_;  // number of constructed inline entries, including tombstones
+	size_t live_;  // number of inline items
+	bool promoted_;
+};
+
+#endif
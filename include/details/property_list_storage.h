@@ -0,0 +1,107 @@
+//----------------------------------------------------------------------------------
+// Name:        property_list_storage.h
+// Purpose:     Storage policies of property_list
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __PROP_LIST_STORAGE_H__
+#define __PROP_LIST_STORAGE_H__
+
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "property_list_key.h"
+
+/// storage policy of property_list: keys in a vector (insertion order) + values in std::unordered_map,
+/// one node allocation per item, each key is stored twice
+struct property_list_hash_storage {};
+
+/// storage policy of property_list: dense insertion-ordered entry array + open addressing index,
+/// see property_list_flat.h
+struct property_list_flat_storage {};
+
+/// storage policy of property_list: up to InlineCount items are stored inside of the list and found with
+/// linear scan, larger lists are promoted to property_list_flat_storage, see property_list_small.h
+template<size_t InlineCount>
+struct property_list_small_storage {};
+
+/// storage policy of property_list: keys are kept in a shape shared by lists with the same keys in the same order,
+/// list holds only values, see property_list_shape.h
+struct property_list_shape_storage {};
+
+/// storage policy of property_list: immutable layout with perfect hash, built from another list by
+/// property_list::freeze(), see property_list_frozen.h
+struct property_list_frozen_storage {};
+
+/// storage of property_list items, specialized for each storage policy
+/// find & remove accept also property_list_key_ref when KeyType is std::string
+template<typename KeyType, typename ValueType, typename Allocator, typename StoragePolicy>
+class property_list_storage;
+
+template<typename ValueType, typename Arg>
+inline void property_list_assign_one(ValueType &target, Arg &&arg, std::true_type) {
+	target = std::forward<Arg>(arg);
+}
+
+template<typename ValueType, typename Arg>
+inline void property_list_assign_one(ValueType &target, Arg &&arg, std::false_type) {
+	target = ValueType(std::forward<Arg>(arg));
+}
+
+/// sets value of existing item from arguments of put: assignable argument is assigned, others construct new value
+template<typename ValueType, typename Arg>
+inline void property_list_assign(ValueType &target, Arg &&arg) {
+	property_list_assign_one(target, std::forward<Arg>(arg), typename std::is_assignable<ValueType &, Arg &&>::type());
+}
+
+template<typename ValueType, typename... Args>
+inline void property_list_assign(ValueType &target, Args &&... args) {
+	target = ValueType(std::forward<Args>(args)...);
+}
+
+/// key & value of storage item, returned by value iterators of storages which do not keep std::pair;
+/// key is const here, so it cannot be changed through iterator
+template<typename KeyType, typename ValueType>
+struct property_list_item {
+	const KeyType &first;
+	ValueType &second;
+};
+
+/// result of operator-> of iterators which return property_list_item, keeps item alive for member access
+template<typename KeyType, typename ValueType>
+class property_list_item_pointer {
+public:
+	typedef property_list_item<KeyType, ValueType> item_type;
+
+	explicit property_list_item_pointer(const item_type &item) : item_(item) {}
+
+	const item_type *operator->() const {
+		return &item_;
+	}
+private:
+	item_type item_;
+};
+
+template<typename TargetStorage>
+struct property_list_item_copier {
+	explicit property_list_item_copier(TargetStorage &target) : target_(target) {}
+
+	template<typename KeyType, typename ValueType>
+	void operator()(const KeyType &key, const ValueType &value) const {
+		target_.put(key, value);
+	}
+
+	TargetStorage &target_;
+};
+
+/// adds items of src (storage with any policy) to target in order of insertion
+template<typename TargetStorage, typename SourceStorage>
+inline void property_list_copy_items(TargetStorage &target, const SourceStorage &src) {
+	target.reserve(target.size() + src.size());
+	src.for_each(property_list_item_copier<TargetStorage>(target));
+}
+
+#endif
@@ -0,0 +1,217 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_packed.h
+// Purpose:     Packed storage of xarray elements with the same scalar type
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XARRAY_PACKED_H__
+#define __XARRAY_PACKED_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include "xnode.h"
+#include "xarray_small_vector.h"
+
+/// calls visitor(static_cast<T *>(nullptr)) for scalar type T with a given type code,
+/// returns false if values with this code can't be packed
+template<typename Visitor>
+inline bool xarray_packed_visit(int code, Visitor &visitor) {
+	switch (code) {
+	case xnode_type_code<bool>::value: visitor(static_cast<bool *>(nullptr)); return true;
+	case xnode_type_code<float>::value: visitor(static_cast<float *>(nullptr)); return true;
+	case xnode_type_code<double>::value: visitor(static_cast<double *>(nullptr)); return true;
+	case xnode_type_code<char>::value: visitor(static_cast<char *>(nullptr)); return true;
+	case xnode_type_code<short>::value: visitor(static_cast<short *>(nullptr)); return true;
+	case xnode_type_code<int>::value: visitor(static_cast<int *>(nullptr)); return true;
+	case xnode_type_code<long>::value: visitor(static_cast<long *>(nullptr)); return true;
+	case xnode_type_code<long long>::value: visitor(static_cast<long long *>(nullptr)); return true;
+	case xnode_type_code<unsigned char>::value: visitor(static_cast<unsigned char *>(nullptr)); return true;
+	case xnode_type_code<unsigned short>::value: visitor(static_cast<unsigned short *>(nullptr)); return true;
+	case xnode_type_code<unsigned int>::value: visitor(static_cast<unsigned int *>(nullptr)); return true;
+	case xnode_type_code<unsigned long>::value: visitor(static_cast<unsigned long *>(nullptr)); return true;
+	case xnode_type_code<unsigned long long>::value: visitor(static_cast<unsigned long long *>(nullptr)); return true;
+	default: return false;
+	}
+}
+
+struct xarray_packed_size_visitor {
+	xarray_packed_size_visitor() : size(0) {}
+
+	template<typename T>
+	void operator()(T *) {
+		size = sizeof(T);
+	}
+
+	size_t size;
+};
+
+/// size of packed element with a given type code, 0 if values of this type are not packed
+inline size_t xarray_packed_size(int code) {
+	xarray_packed_size_visitor visitor;
+	xarray_packed_visit(code, visitor);
+	return visitor.size;
+}
+
+/// Elements of a single scalar type (selected by type code) stored densely in 64-bit words,
+/// element i of type T is at data() + i * sizeof(T). Up to InlineWords words are kept inside of the buffer.
+template<typename Allocator, size_t InlineWords = 0>
+class xarray_packed_buffer {
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint64_t> word_allocator_type;
+	typedef xarray_small_vector<uint64_t, InlineWords, word_allocator_type> word_list;
+public:
+	xarray_packed_buffer() : size_(0), code_(0), element_size_(0) {}
+
+	explicit xarray_packed_buffer(const Allocator &alloc) :
+		words_(word_allocator_type(alloc)), size_(0), code_(0), element_size_(0)
+	{
+	}
+
+	/// allocator of words, rebound from allocator of array
+	word_allocator_type get_allocator() const {
+		return words_.get_allocator();
+	}
+
+	/// type code of elements, 0 if buffer is not used
+	int code() const {
+		return code_;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	size_t element_size() const {
+		return element_size_;
+	}
+
+	const void *data() const {
+		return words_.data();
+	}
+
+	/// starts buffer for elements with a given code, memory is kept
+	void reset(int code) {
+		words_.clear();
+		size_ = 0;
+		code_ = code;
+		element_size_ = xarray_packed_size(code);
+	}
+
+	/// removes elements, memory is kept
+	void clear() {
+		reset(0);
+	}
+
+	/// removes elements and frees memory
+	void release() {
+		word_list(words_.get_allocator()).swap(words_);
+		reset(0);
+	}
+
+	void reserve(size_t count) {
+		words_.reserve(words_for(count));
+	}
+
+	size_t capacity() const {
+		return (element_size_ > 0) ? words_.capacity() * sizeof(uint64_t) / element_size_ : 0;
+	}
+
+	template<typename T>
+	T get(size_t pos) const {
+		T value;
+		std::memcpy(&value, bytes() + pos * sizeof(T), sizeof(T));
+		return value;
+	}
+
+	template<typename T>
+	void push_back(T value) {
+		size_t needed = words_for(size_ + 1);
+		if (words_.size() < needed)
+			words_.push_back(0);
+		std::memcpy(bytes() + size_ * sizeof(T), &value, sizeof(T));
+		++size_;
+	}
+
+	/// removes elements from a given position to the end
+	void truncate(size_t count) {
+		if (count < size_) {
+			size_ = count;
+			words_.resize(words_for(count));
+		}
+	}
+
+	/// compares elements by bits, like xnode does for values stored inline
+	bool operator==(const xarray_packed_buffer &rhs) const {
+		return code_ == rhs.code_ && size_ == rhs.size_ &&
+			(size_ == 0 || std::memcmp(data(), rhs.data(), size_ * element_size_) == 0);
+	}
+
+private:
+	size_t words_for(size_t count) const {
+		return (count * element_size_ + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	}
+
+	const unsigned char *bytes() const {
+		return reinterpret_cast<const unsigned char *>(words_.data());
+	}
+
+	unsigned char *bytes() {
+		return reinterpret_cast<unsigned char *>(words_.data());
+	}
+
+	word_list words_;
+	size_t size_;
+	int code_;
+	size_t element_size_;
+};
+
+/// appends value of node to buffer
+template<typename NodeType, typename Buffer>
+struct xarray_pack_visitor {
+	xarray_pack_visitor(Buffer &buffer, const NodeType &node) : buffer_(buffer), node_(node) {}
+
+	template<typename T>
+	void operator()(T *) {
+		buffer_.push_back(node_.template get_as<T>());
+	}
+
+	Buffer &buffer_;
+	const NodeType &node_;
+};
+
+/// creates node from packed element
+template<typename NodeType, typename Buffer>
+struct xarray_unpack_visitor {
+	xarray_unpack_visitor(const Buffer &buffer, size_t pos) : buffer_(buffer), pos_(pos) {}
+
+	template<typename T>
+	void operator()(T *) {
+		node_ = NodeType::value_of(buffer_.template get<T>(pos_));
+	}
+
+	const Buffer &buffer_;
+	size_t pos_;
+	NodeType node_;
+};
+
+/// appends nodes created from all packed elements to container
+template<typename Container, typename Buffer>
+struct xarray_unpack_all_visitor {
+	xarray_unpack_all_visitor(const Buffer &buffer, Container &output) : buffer_(buffer), output_(output) {}
+
+	template<typename T>
+	void operator()(T *) {
+		typedef typename Container::value_type node_type;
+		output_.reserve(output_.size() + buffer_.size());
+		for (size_t i = 0, count = buffer_.size(); i < count; ++i)
+			output_.push_back(node_type::value_of(buffer_.template get<T>(i)));
+	}
+
+	const Buffer &buffer_;
+	Container &output_;
+};
+
+#endif
@@ -0,0 +1,492 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_simd.h
+// Purpose:     Vectorized loops over raw numbers for xarray reductions
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XARRAY_SIMD_H__
+#define __XARRAY_SIMD_H__
+
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include <limits>
+
+// SSE2 and AVX2 loops are compiled with target attributes and selected at run time,
+// define XNODE_NO_SIMD to use scalar loops only
+#if !defined(XNODE_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define XNODE_SIMD_X86
+#include <immintrin.h>
+#define XNODE_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+/// instruction sets used by kernels
+enum xarray_simd_level_type {
+	xarray_simd_scalar = 0,
+	xarray_simd_sse2 = 1,
+	xarray_simd_avx2 = 2
+};
+
+/// layout of values processed by kernels
+enum xarray_simd_kind_type {
+	xarray_simd_kind_none = 0,
+	xarray_simd_kind_i32,
+	xarray_simd_kind_i64,
+	xarray_simd_kind_f32,
+	xarray_simd_kind_f64
+};
+
+/// kernel layout for scalar type T
+template<typename T>
+struct xarray_simd_kind {
+	enum { value = xarray_simd_kind_none };
+};
+
+template<typename T, int Size = sizeof(T)>
+struct xarray_simd_int_kind {
+	enum { value = xarray_simd_kind_none };
+};
+
+template<typename T>
+struct xarray_simd_int_kind<T, 4> {
+	enum { value = xarray_simd_kind_i32 };
+};
+
+template<typename T>
+struct xarray_simd_int_kind<T, 8> {
+	enum { value = xarray_simd_kind_i64 };
+};
+
+template<>
+struct xarray_simd_kind<int> : xarray_simd_int_kind<int> {};
+
+template<>
+struct xarray_simd_kind<long> : xarray_simd_int_kind<long> {};
+
+template<>
+struct xarray_simd_kind<long long> : xarray_simd_int_kind<long long> {};
+
+template<>
+struct xarray_simd_kind<float> {
+	enum { value = xarray_simd_kind_f32 };
+};
+
+template<>
+struct xarray_simd_kind<double> {
+	enum { value = xarray_simd_kind_f64 };
+};
+
+/// best instruction set supported by CPU
+inline int xarray_simd_detect() {
+#ifdef XNODE_SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return xarray_simd_avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return xarray_simd_sse2;
+#endif
+	return xarray_simd_scalar;
+}
+
+inline int &xarray_simd_level_ref() {
+	static int level = xarray_simd_detect();
+	return level;
+}
+
+/// instruction set used by kernels, detected on first use
+inline int xarray_simd_level() {
+	return xarray_simd_level_ref();
+}
+
+/// limits instruction set used by kernels (for tests & measurements, not synchronized with running kernels),
+/// returns previous level
+inline int xarray_simd_set_level(int level) {
+	int previous = xarray_simd_level_ref();
+	int best = xarray_simd_detect();
+	xarray_simd_level_ref() = (level < best) ? level : best;
+	return previous;
+}
+
+/// sum, min & max of integers, sum wraps around and sets overflow flag
+struct xarray_int_stats {
+	xarray_int_stats() : sum(0), min(LLONG_MAX), max(LLONG_MIN), overflow(false) {}
+
+	void add_sum(long long value) {
+		long long result = static_cast<long long>(static_cast<unsigned long long>(sum) + static_cast<unsigned long long>(value));
+		if (((sum ^ result) & (value ^ result)) < 0)
+			overflow = true;
+		sum = result;
+	}
+
+	void add(long long value) {
+		add_sum(value);
+		if (value < min)
+			min = value;
+		if (value > max)
+			max = value;
+	}
+
+	long long sum;
+	long long min;
+	long long max;
+	bool overflow;
+};
+
+/// sum, min & max of floating point numbers, NaN is included in sum and skipped by min & max
+struct xarray_real_stats {
+	xarray_real_stats() : sum(0.0), min(std::numeric_limits<double>::infinity()), max(-std::numeric_limits<double>::infinity()) {}
+
+	void add(double value) {
+		sum += value;
+		if (value < min)
+			min = value;
+		if (value > max)
+			max = value;
+	}
+
+	/// false if there were no values or all of them were NaN
+	bool has_range() const {
+		return min <= max;
+	}
+
+	double sum;
+	double min;
+	double max;
+};
+
+template<typename T>
+inline T xarray_simd_load(const void *values, size_t pos) {
+	T value;
+	std::memcpy(&value, static_cast<const char *>(values) + pos * sizeof(T), sizeof(T));
+	return value;
+}
+
+// ----------------------------------------------------------------
+// -- SCALAR
+// ----------------------------------------------------------------
+template<typename T>
+inline void xarray_simd_scan_int_scalar(const void *values, size_t begin, size_t count, xarray_int_stats &stats) {
+	for (size_t i = begin; i < count; ++i)
+		stats.add(xarray_simd_load<T>(values, i));
+}
+
+template<typename T>
+inline void xarray_simd_scan_real_scalar(const void *values, size_t begin, size_t count, xarray_real_stats &stats) {
+	for (size_t i = begin; i < count; ++i)
+		stats.add(xarray_simd_load<T>(values, i));
+}
+
+inline double xarray_simd_dot_scalar(const void *lhs, const void *rhs, size_t begin, size_t count, double sum) {
+	for (size_t i = begin; i < count; ++i)
+		sum += xarray_simd_load<double>(lhs, i) * xarray_simd_load<double>(rhs, i);
+	return sum;
+}
+
+#ifdef XNODE_SIMD_X86
+// ----------------------------------------------------------------
+// -- SSE2
+// ----------------------------------------------------------------
+XNODE_SIMD_TARGET("sse2")
+inline __m128i xarray_simd_select_sse2(__m128i mask, __m128i yes, __m128i no) {
+	return _mm_or_si128(_mm_and_si128(mask, yes), _mm_andnot_si128(mask, no));
+}
+
+XNODE_SIMD_TARGET("sse2")
+inline void xarray_simd_scan_i32_sse2(const void *values, size_t count, xarray_int_stats &stats) {
+	const char *data = static_cast<const char *>(values);
+	__m128i sum = _mm_setzero_si128();
+	__m128i min = _mm_set1_epi32(INT_MAX);
+	__m128i max = _mm_set1_epi32(INT_MIN);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4));
+		__m128i sign = _mm_cmpgt_epi32(_mm_setzero_si128(), v);
+		sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(v, sign), _mm_unpackhi_epi32(v, sign)));
+		min = xarray_simd_select_sse2(_mm_cmpgt_epi32(min, v), v, min);
+		max = xarray_simd_select_sse2(_mm_cmpgt_epi32(v, max), v, max);
+	}
+	long long sums[2];
+	int mins[4], maxs[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(sums), sum);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(mins), min);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(maxs), max);
+	if (i > 0) {
+		stats.add_sum(sums[0]);
+		stats.add_sum(sums[1]);
+		for (int lane = 0; lane < 4; ++lane) {
+			if (mins[lane] < stats.min)
+				stats.min = mins[lane];
+			if (maxs[lane] > stats.max)
+				stats.max = maxs[lane];
+		}
+	}
+	xarray_simd_scan_int_scalar<int>(values, i, count, stats);
+}
+
+XNODE_SIMD_TARGET("sse2")
+inline void xarray_simd_merge_real_sse2(__m128d sum, __m128d min, __m128d max, xarray_real_stats &stats) {
+	double sums[2], mins[2], maxs[2];
+	_mm_storeu_pd(sums, sum);
+	_mm_storeu_pd(mins, min);
+	_mm_storeu_pd(maxs, max);
+	stats.sum += sums[0] + sums[1];
+	for (int lane = 0; lane < 2; ++lane) {
+		if (mins[lane] < stats.min)
+			stats.min = mins[lane];
+		if (maxs[lane] > stats.max)
+			stats.max = maxs[lane];
+	}
+}
+
+// min/max keep accumulator when value is NaN: _mm_min_pd(v, acc) returns second operand for unordered values
+XNODE_SIMD_TARGET("sse2")
+inline void xarray_simd_scan_f64_sse2(const void *values, size_t count, xarray_real_stats &stats) {
+	const double *data = static_cast<const double *>(values);
+	__m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+	__m128d min = _mm_set1_pd(std::numeric_limits<double>::infinity());
+	__m128d max = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128d v0 = _mm_loadu_pd(data + i);
+		__m128d v1 = _mm_loadu_pd(data + i + 2);
+		sum0 = _mm_add_pd(sum0, v0);
+		sum1 = _mm_add_pd(sum1, v1);
+		min = _mm_min_pd(v1, _mm_min_pd(v0, min));
+		max = _mm_max_pd(v1, _mm_max_pd(v0, max));
+	}
+	xarray_simd_merge_real_sse2(_mm_add_pd(sum0, sum1), min, max, stats);
+	xarray_simd_scan_real_scalar<double>(values, i, count, stats);
+}
+
+XNODE_SIMD_TARGET("sse2")
+inline void xarray_simd_scan_f32_sse2(const void *values, size_t count, xarray_real_stats &stats) {
+	const float *data = static_cast<const float *>(values);
+	__m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+	__m128d min = _mm_set1_pd(std::numeric_limits<double>::infinity());
+	__m128d max = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 v = _mm_loadu_ps(data + i);
+		__m128d v0 = _mm_cvtps_pd(v);
+		__m128d v1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+		sum0 = _mm_add_pd(sum0, v0);
+		sum1 = _mm_add_pd(sum1, v1);
+		min = _mm_min_pd(v1, _mm_min_pd(v0, min));
+		max = _mm_max_pd(v1, _mm_max_pd(v0, max));
+	}
+	xarray_simd_merge_real_sse2(_mm_add_pd(sum0, sum1), min, max, stats);
+	xarray_simd_scan_real_scalar<float>(values, i, count, stats);
+}
+
+XNODE_SIMD_TARGET("sse2")
+inline double xarray_simd_dot_sse2(const void *lhs_values, const void *rhs_values, size_t count) {
+	const double *lhs = static_cast<const double *>(lhs_values);
+	const double *rhs = static_cast<const double *>(rhs_values);
+	__m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i)));
+		sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(lhs + i + 2), _mm_loadu_pd(rhs + i + 2)));
+	}
+	double sums[2];
+	_mm_storeu_pd(sums, _mm_add_pd(sum0, sum1));
+	return xarray_simd_dot_scalar(lhs, rhs, i, count, sums[0] + sums[1]);
+}
+
+// ----------------------------------------------------------------
+// -- AVX2
+// ----------------------------------------------------------------
+XNODE_SIMD_TARGET("avx2")
+inline void xarray_simd_scan_i32_avx2(const void *values, size_t count, xarray_int_stats &stats) {
+	const char *data = static_cast<const char *>(values);
+	__m256i sum = _mm256_setzero_si256();
+	__m256i min = _mm256_set1_epi32(INT_MAX);
+	__m256i max = _mm256_set1_epi32(INT_MIN);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * 4));
+		sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+		sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+		min = _mm256_min_epi32(min, v);
+		max = _mm256_max_epi32(max, v);
+	}
+	long long sums[4];
+	int mins[8], maxs[8];
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(sums), sum);
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(mins), min);
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(maxs), max);
+	if (i > 0) {
+		for (int lane = 0; lane < 4; ++lane)
+			stats.add_sum(sums[lane]);
+		for (int lane = 0; lane < 8; ++lane) {
+			if (mins[lane] < stats.min)
+				stats.min = mins[lane];
+			if (maxs[lane] > stats.max)
+				stats.max = maxs[lane];
+		}
+	}
+	xarray_simd_scan_int_scalar<int>(values, i, count, stats);
+}
+
+// lanes wrap around on overflow, sign of (sum ^ result) & (value ^ result) marks lanes which overflowed
+XNODE_SIMD_TARGET("avx2")
+inline void xarray_simd_scan_i64_avx2(const void *values, size_t count, xarray_int_stats &stats) {
+	const char *data = static_cast<const char *>(values);
+	__m256i sum = _mm256_setzero_si256();
+	__m256i overflow = _mm256_setzero_si256();
+	__m256i min = _mm256_set1_epi64x(LLONG_MAX);
+	__m256i max = _mm256_set1_epi64x(LLONG_MIN);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * 8));
+		__m256i result = _mm256_add_epi64(sum, v);
+		overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(sum, result), _mm256_xor_si256(v, result)));
+		sum = result;
+		min = _mm256_blendv_epi8(min, v, _mm256_cmpgt_epi64(min, v));
+		max = _mm256_blendv_epi8(max, v, _mm256_cmpgt_epi64(v, max));
+	}
+	if (i > 0) {
+		long long sums[4], mins[4], maxs[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(sums), sum);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(mins), min);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(maxs), max);
+		if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0)
+			stats.overflow = true;
+		for (int lane = 0; lane < 4; ++lane) {
+			stats.add_sum(sums[lane]);
+			if (mins[lane] < stats.min)
+				stats.min = mins[lane];
+			if (maxs[lane] > stats.max)
+				stats.max = maxs[lane];
+		}
+	}
+	xarray_simd_scan_int_scalar<long long>(values, i, count, stats);
+}
+
+XNODE_SIMD_TARGET("avx2")
+inline void xarray_simd_merge_real_avx2(__m256d sum, __m256d min, __m256d max, xarray_real_stats &stats) {
+	double sums[4], mins[4], maxs[4];
+	_mm256_storeu_pd(sums, sum);
+	_mm256_storeu_pd(mins, min);
+	_mm256_storeu_pd(maxs, max);
+	stats.sum += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+	for (int lane = 0; lane < 4; ++lane) {
+		if (mins[lane] < stats.min)
+			stats.min = mins[lane];
+		if (maxs[lane] > stats.max)
+			stats.max = maxs[lane];
+	}
+}
+
+XNODE_SIMD_TARGET("avx2")
+inline void xarray_simd_scan_f64_avx2(const void *values, size_t count, xarray_real_stats &stats) {
+	const double *data = static_cast<const double *>(values);
+	__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+	__m256d min = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+	__m256d max = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256d v0 = _mm256_loadu_pd(data + i);
+		__m256d v1 = _mm256_loadu_pd(data + i + 4);
+		sum0 = _mm256_add_pd(sum0, v0);
+		sum1 = _mm256_add_pd(sum1, v1);
+		min = _mm256_min_pd(v1, _mm256_min_pd(v0, min));
+		max = _mm256_max_pd(v1, _mm256_max_pd(v0, max));
+	}
+	xarray_simd_merge_real_avx2(_mm256_add_pd(sum0, sum1), min, max, stats);
+	xarray_simd_scan_real_scalar<double>(values, i, count, stats);
+}
+
+XNODE_SIMD_TARGET("avx2")
+inline void xarray_simd_scan_f32_avx2(const void *values, size_t count, xarray_real_stats &stats) {
+	const float *data = static_cast<const float *>(values);
+	__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+	__m256d min = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+	__m256d max = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256d v0 = _mm256_cvtps_pd(_mm_loadu_ps(data + i));
+		__m256d v1 = _mm256_cvtps_pd(_mm_loadu_ps(data + i + 4));
+		sum0 = _mm256_add_pd(sum0, v0);
+		sum1 = _mm256_add_pd(sum1, v1);
+		min = _mm256_min_pd(v1, _mm256_min_pd(v0, min));
+		max = _mm256_max_pd(v1, _mm256_max_pd(v0, max));
+	}
+	xarray_simd_merge_real_avx2(_mm256_add_pd(sum0, sum1), min, max, stats);
+	xarray_simd_scan_real_scalar<float>(values, i, count, stats);
+}
+
+XNODE_SIMD_TARGET("avx2")
+inline double xarray_simd_dot_avx2(const void *lhs_values, const void *rhs_values, size_t count) {
+	const double *lhs = static_cast<const double *>(lhs_values);
+	const double *rhs = static_cast<const double *>(rhs_values);
+	__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i)));
+		sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(lhs + i + 4), _mm256_loadu_pd(rhs + i + 4)));
+	}
+	double sums[4];
+	_mm256_storeu_pd(sums, _mm256_add_pd(sum0, sum1));
+	return xarray_simd_dot_scalar(lhs, rhs, i, count, (sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+#endif
+
+// ----------------------------------------------------------------
+// -- DISPATCH
+// ----------------------------------------------------------------
+
+/// sum, min & max of integers with a given layout (xarray_simd_kind_i32 or xarray_simd_kind_i64)
+inline void xarray_simd_scan_int(int kind, const void *values, size_t count, xarray_int_stats &stats) {
+	if (kind == xarray_simd_kind_i32) {
+		// int64 lanes cannot overflow for sums of less than 2^32 values
+		const size_t block = size_t(1) << 30;
+		if (count > block) {
+			for (size_t pos = 0; pos < count; pos += block)
+				xarray_simd_scan_int(kind, static_cast<const char *>(values) + pos * 4, (count - pos < block) ? count - pos : block, stats);
+			return;
+		}
+#ifdef XNODE_SIMD_X86
+		if (xarray_simd_level() >= xarray_simd_avx2)
+			return xarray_simd_scan_i32_avx2(values, count, stats);
+		if (xarray_simd_level() >= xarray_simd_sse2)
+			return xarray_simd_scan_i32_sse2(values, count, stats);
+#endif
+		return xarray_simd_scan_int_scalar<int>(values, 0, count, stats);
+	}
+#ifdef XNODE_SIMD_X86
+	// 64-bit compare requires SSE4.2, SSE2 level uses scalar loop
+	if (xarray_simd_level() >= xarray_simd_avx2)
+		return xarray_simd_scan_i64_avx2(values, count, stats);
+#endif
+	xarray_simd_scan_int_scalar<long long>(values, 0, count, stats);
+}
+
+/// sum, min & max of floating point numbers with a given layout (xarray_simd_kind_f32 or xarray_simd_kind_f64)
+inline void xarray_simd_scan_real(int kind, const void *values, size_t count, xarray_real_stats &stats) {
+#ifdef XNODE_SIMD_X86
+	if (xarray_simd_level() >= xarray_simd_avx2)
+		return (kind == xarray_simd_kind_f32) ? xarray_simd_scan_f32_avx2(values, count, stats) : xarray_simd_scan_f64_avx2(values, count, stats);
+	if (xarray_simd_level() >= xarray_simd_sse2)
+		return (kind == xarray_simd_kind_f32) ? xarray_simd_scan_f32_sse2(values, count, stats) : xarray_simd_scan_f64_sse2(values, count, stats);
+#endif
+	if (kind == xarray_simd_kind_f32)
+		xarray_simd_scan_real_scalar<float>(values, 0, count, stats);
+	else
+		xarray_simd_scan_real_scalar<double>(values, 0, count, stats);
+}
+
+/// sum of lhs[i] * rhs[i] for arrays of doubles
+inline double xarray_simd_dot(const void *lhs, const void *rhs, size_t count) {
+#ifdef XNODE_SIMD_X86
+	if (xarray_simd_level() >= xarray_simd_avx2)
+		return xarray_simd_dot_avx2(lhs, rhs, count);
+	if (xarray_simd_level() >= xarray_simd_sse2)
+		return xarray_simd_dot_sse2(lhs, rhs, count);
+#endif
+	return xarray_simd_dot_scalar(lhs, rhs, 0, count, 0.0);
+}
+
+#endif
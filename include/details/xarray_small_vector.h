@@ -0,0 +1,309 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_small_vector.h
+// Purpose:     Vector with inline storage for a few elements, used by xarray
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XARRAY_SMALL_VECTOR_H__
+#define __XARRAY_SMALL_VECTOR_H__
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/// Subset of std::vector interface, up to InlineCount elements are kept in a buffer inside of the vector
+/// and larger vectors use memory from allocator. Iterators are pointers to elements.
+/// With InlineCount = 0 all elements are allocated like in std::vector.
+template<typename T, size_t InlineCount, typename Allocator = std::allocator<T> >
+class xarray_small_vector {
+	typedef std::allocator_traits<Allocator> alloc_traits;
+public:
+	typedef T value_type;
+	typedef Allocator allocator_type;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+	typedef size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	xarray_small_vector() : begin_(inline_items()), size_(0), capacity_(InlineCount) {}
+
+	explicit xarray_small_vector(const Allocator &alloc) :
+		alloc_(alloc), begin_(inline_items()), size_(0), capacity_(InlineCount)
+	{
+	}
+
+	xarray_small_vector(const xarray_small_vector &src) :
+		alloc_(alloc_traits::select_on_container_copy_construction(src.alloc_)), begin_(inline_items()), size_(0), capacity_(InlineCount)
+	{
+		reserve(src.size_);
+		for (const_iterator it = src.begin(), end = src.end(); it != end; ++it)
+			push_back(*it);
+	}
+
+	xarray_small_vector(xarray_small_vector &&src) noexcept(std::is_nothrow_move_constructible<T>::value) :
+		alloc_(src.alloc_), begin_(inline_items()), size_(0), capacity_(InlineCount)
+	{
+		take(src);
+	}
+
+	~xarray_small_vector() {
+		clear();
+		release();
+	}
+
+	xarray_small_vector &operator=(const xarray_small_vector &rhs) {
+		if (this != &rhs) {
+			clear();
+			reserve(rhs.size_);
+			for (const_iterator it = rhs.begin(), end = rhs.end(); it != end; ++it)
+				push_back(*it);
+		}
+		return *this;
+	}
+
+	/// allocator is kept, elements allocated with other allocator are moved one by one,
+	/// stateless allocators are always equal, so then it does not throw
+	xarray_small_vector &operator=(xarray_small_vector &&rhs)
+		noexcept(std::is_nothrow_move_constructible<T>::value && std::is_empty<Allocator>::value)
+	{
+		if (this != &rhs) {
+			clear();
+			if (rhs.is_inline() || alloc_ == rhs.alloc_) {
+				release();
+				take(rhs);
+			} else {
+				reserve(rhs.size_);
+				for (iterator it = rhs.begin(), end = rhs.end(); it != end; ++it)
+					push_back(std::move(*it));
+				rhs.clear();
+			}
+		}
+		return *this;
+	}
+
+	allocator_type get_allocator() const { return alloc_; }
+
+	bool empty() const { return size_ == 0; }
+	size_type size() const { return size_; }
+	size_type capacity() const { return capacity_; }
+
+	/// true if elements are kept in inline buffer
+	bool is_inline() const { return begin_ == inline_items(); }
+
+	T *data() { return begin_; }
+	const T *data() const { return begin_; }
+
+	iterator begin() { return begin_; }
+	const_iterator begin() const { return begin_; }
+	const_iterator cbegin() const { return begin_; }
+	iterator end() { return begin_ + size_; }
+	const_iterator end() const { return begin_ + size_; }
+	const_iterator cend() const { return begin_ + size_; }
+
+	reference operator[](size_type pos) { return begin_[pos]; }
+	const_reference operator[](size_type pos) const { return begin_[pos]; }
+
+	reference at(size_type pos) {
+		check_index(pos);
+		return begin_[pos];
+	}
+
+	const_reference at(size_type pos) const {
+		check_index(pos);
+		return begin_[pos];
+	}
+
+	reference front() { return begin_[0]; }
+	const_reference front() const { return begin_[0]; }
+	reference back() { return begin_[size_ - 1]; }
+	const_reference back() const { return begin_[size_ - 1]; }
+
+	void reserve(size_type count) {
+		if (count > capacity_)
+			grow(count);
+	}
+
+	void clear() {
+		for (size_type i = 0; i < size_; ++i)
+			alloc_traits::destroy(alloc_, begin_ + i);
+		size_ = 0;
+	}
+
+	void push_back(const T &value) { emplace_back(value); }
+	void push_back(T &&value) { emplace_back(std::move(value)); }
+
+	template<typename... Args>
+	reference emplace_back(Args &&...args) {
+		if (size_ == capacity_) {
+			// new element is constructed before old ones are moved, arguments can refer to elements
+			size_type new_capacity = next_capacity(size_ + 1);
+			T *items = alloc_traits::allocate(alloc_, new_capacity);
+			try {
+				alloc_traits::construct(alloc_, items + size_, std::forward<Args>(args)...);
+			}
+			catch (...) {
+				alloc_traits::deallocate(alloc_, items, new_capacity);
+				throw;
+			}
+			try {
+				relocate(items, new_capacity);
+			}
+			catch (...) {
+				alloc_traits::destroy(alloc_, items + size_);
+				alloc_traits::deallocate(alloc_, items, new_capacity);
+				throw;
+			}
+		} else {
+			alloc_traits::construct(alloc_, begin_ + size_, std::forward<Args>(args)...);
+		}
+		return begin_[size_++];
+	}
+
+	void pop_back() {
+		alloc_traits::destroy(alloc_, begin_ + --size_);
+	}
+
+	iterator insert(const_iterator pos, const T &value) {
+		return insert(pos, T(value));
+	}
+
+	iterator insert(const_iterator pos, T &&value) {
+		difference_type index = pos - begin_;
+		emplace_back(std::move(value));
+		std::rotate(begin_ + index, end() - 1, end());
+		return begin_ + index;
+	}
+
+	iterator erase(const_iterator pos) {
+		iterator target = begin_ + (pos - begin_);
+		std::move(target + 1, end(), target);
+		pop_back();
+		return target;
+	}
+
+	void resize(size_type count, const T &value = T()) {
+		if (count > capacity_) {
+			// value can refer to element, so it is copied before elements are moved
+			T copy(value);
+			reserve(count);
+			while (size_ < count)
+				push_back(copy);
+		} else if (count > size_) {
+			while (size_ < count)
+				push_back(value);
+		} else {
+			while (size_ > count)
+				pop_back();
+		}
+	}
+
+	void swap(xarray_small_vector &other) {
+		xarray_small_vector temp(std::move(other));
+		other = std::move(*this);
+		*this = std::move(temp);
+	}
+
+	bool operator==(const xarray_small_vector &rhs) const {
+		return size_ == rhs.size_ && std::equal(begin(), end(), rhs.begin());
+	}
+
+	bool operator!=(const xarray_small_vector &rhs) const {
+		return !(*this == rhs);
+	}
+
+	bool operator<(const xarray_small_vector &rhs) const {
+		return std::lexicographical_compare(begin(), end(), rhs.begin(), rhs.end());
+	}
+
+private:
+	void check_index(size_type pos) const {
+		if (pos >= size_)
+			throw std::out_of_range("xarray: index out of range");
+	}
+
+	T *inline_items() {
+		return reinterpret_cast<T *>(buffer_);
+	}
+
+	const T *inline_items() const {
+		return reinterpret_cast<const T *>(buffer_);
+	}
+
+	size_type next_capacity(size_type count) const {
+		return std::max(count, std::max(capacity_ * 2, size_type(InlineCount + 1)));
+	}
+
+	void grow(size_type count) {
+		T *items = alloc_traits::allocate(alloc_, count);
+		try {
+			relocate(items, count);
+		}
+		catch (...) {
+			alloc_traits::deallocate(alloc_, items, count);
+			throw;
+		}
+	}
+
+	/// moves elements to allocated buffer, old buffer is released, elements are copied if move can throw
+	void relocate(T *items, size_type new_capacity) {
+		size_type moved = 0;
+		try {
+			for (; moved < size_; ++moved)
+				alloc_traits::construct(alloc_, items + moved, std::move_if_noexcept(begin_[moved]));
+		}
+		catch (...) {
+			for (size_type i = 0; i < moved; ++i)
+				alloc_traits::destroy(alloc_, items + i);
+			throw;
+		}
+		for (size_type i = 0; i < size_; ++i)
+			alloc_traits::destroy(alloc_, begin_ + i);
+		release();
+		begin_ = items;
+		capacity_ = new_capacity;
+	}
+
+	/// frees allocated buffer, elements must be destroyed
+	void release() {
+		if (!is_inline())
+			alloc_traits::deallocate(alloc_, begin_, capacity_);
+		begin_ = inline_items();
+		capacity_ = InlineCount;
+	}
+
+	/// takes elements of other vector, which is left empty
+	void take(xarray_small_vector &src) {
+		if (src.is_inline()) {
+			for (size_type i = 0; i < src.size_; ++i) {
+				alloc_traits::construct(alloc_, begin_ + i, std::move(src.begin_[i]));
+				++size_;
+			}
+			src.clear();
+		} else {
+			begin_ = src.begin_;
+			size_ = src.size_;
+			capacity_ = src.capacity_;
+			src.begin_ = src.inline_items();
+			src.size_ = 0;
+			src.capacity_ = InlineCount;
+		}
+	}
+
+	Allocator alloc_;
+	T *begin_;
+	size_type size_;
+	size_type capacity_;
+	alignas(T) unsigned char buffer_[sizeof(T) * (InlineCount > 0 ? InlineCount : 1)];
+};
+
+#endif
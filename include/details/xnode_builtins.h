@@ -37,6 +37,11 @@ struct xnode_cast_policy_type_codes<xnode_def_value_policy>
     };
 };
 
+template <>
+struct xnode_cast_policy_type_codes<xnode_def_cast_policy> : xnode_cast_policy_type_codes<xnode_def_value_policy>
+{
+};
+
 template <>
 struct xnode_type_code<xnode_null_value>
 {
@@ -172,6 +177,29 @@ struct xnode_type_code<unsigned long long>
     };
 };
 
+/// types with conversion rows, ordered by type code from null_code
+template <>
+struct xnode_cast_policy_types<xnode_def_cast_policy>
+{
+    typedef xnode_type_list<
+        void,               // null
+        void,               // def_code
+        bool,
+        float,
+        double,
+        std::string,
+        char,
+        short,
+        int,
+        long,
+        long long,
+        unsigned char,
+        unsigned short,
+        unsigned int,
+        unsigned long,
+        unsigned long long> type;
+};
+
 template <bool Parameter>
 struct xnode_bool_to_str
 {
@@ -209,6 +237,7 @@ T assert_is_positive(T value)
 {
     if (value < 0)
     {
+        XNODE_STATS(count_error(xseOutOfRange));
         throw std::runtime_error("Cannot convert negative value to unsigned type");
     }
     return value;
@@ -236,6 +265,7 @@ TargetType ranged_cast(SourceType value)
 
     if (!in_range)
     {
+        XNODE_STATS(count_error(xseOutOfRange));
         throw std::runtime_error("Value out of range for target type");
     }
 
@@ -249,324 +279,106 @@ bool cast_string_to_number(T &output, const std::string &input)
     return from_string<T>(output, input);
 }
 
-// Specialization for float with overflow checking
-template <>
-bool cast_string_to_number<float>(float &output, const std::string &input)
-{
-    if (input.find_first_not_of("-0123456789.eE") != std::string::npos)
-    {
-        return from_string<float>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        double intermediate = std::stod(input, &pos);
-        if (std::abs(intermediate) > std::numeric_limits<float>::max())
-        {
-            throw std::overflow_error("Numeric overflow when converting string to float");
-        }
-        if (pos != input.length())
-        {
-            throw std::runtime_error("Invalid format for float conversion");
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to float");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
-    }
-
-    return from_string<float>(output, input);
-}
-
-// Specialization for double with overflow checking
-template <>
-bool cast_string_to_number<double>(double &output, const std::string &input)
-{
-    if (input.find_first_not_of("-0123456789.eE") != std::string::npos)
-    {
-        return from_string<double>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        std::stod(input, &pos);
-        if (pos != input.length())
-        {
-            throw std::runtime_error("Invalid format for double conversion");
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to double");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
-    }
-
-    return from_string<double>(output, input);
-}
-
-// Specialization for int with range checking
-template <>
-bool cast_string_to_number<int>(int &output, const std::string &input)
-{
-    if (input.find_first_not_of("-0123456789") != std::string::npos)
-    {
-        return from_string<int>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        long long intermediate = std::stoll(input, &pos);
-        if (intermediate > std::numeric_limits<int>::max() ||
-            intermediate < std::numeric_limits<int>::min())
-        {
-            throw std::overflow_error("Numeric overflow when converting string to int");
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to int");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
-    }
-
-    return from_string<int>(output, input);
-}
-
-// Specialization for long with range checking
-template <>
-bool cast_string_to_number<long>(long &output, const std::string &input)
-{
-    if (input.find_first_not_of("-0123456789") != std::string::npos)
-    {
-        return from_string<long>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        long long intermediate = std::stoll(input, &pos);
-        if (sizeof(long) < sizeof(long long))
-        {
-            if (intermediate > static_cast<long long>(std::numeric_limits<long>::max()) ||
-                intermediate < static_cast<long long>(std::numeric_limits<long>::min()))
-            {
-                throw std::overflow_error("Numeric overflow when converting string to long");
-            }
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to long");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
-    }
-
-    return from_string<long>(output, input);
-}
-
-// Specialization for long long with range validation
-template <>
-bool cast_string_to_number<long long>(long long &output, const std::string &input)
-{
-    return from_string<long long>(output, input);
-}
-
-// Specialization for short with range checking
-template <>
-bool cast_string_to_number<short>(short &output, const std::string &input)
+template <typename T>
+inline const char *number_type_name();
+
+template <> inline const char *number_type_name<short>() { return "short"; }
+template <> inline const char *number_type_name<int>() { return "int"; }
+template <> inline const char *number_type_name<long>() { return "long"; }
+template <> inline const char *number_type_name<long long>() { return "long long"; }
+template <> inline const char *number_type_name<unsigned short>() { return "unsigned short"; }
+template <> inline const char *number_type_name<unsigned int>() { return "unsigned int"; }
+template <> inline const char *number_type_name<unsigned long>() { return "unsigned long"; }
+template <> inline const char *number_type_name<unsigned long long>() { return "unsigned long long"; }
+template <> inline const char *number_type_name<float>() { return "float"; }
+template <> inline const char *number_type_name<double>() { return "double"; }
+
+// Throws if text built only from characters of number is not fully parsed as floating-point value (e.g. "1.2.3"),
+// other texts are converted from their beginning
+template <typename T>
+void check_real_number_format(const std::string &input, const char *end)
 {
-    if (input.find_first_not_of("-0123456789") != std::string::npos)
-    {
-        return from_string<short>(output, input);
-    }
-
-    try
+    if (std::is_floating_point<T>::value && end != input.data() + input.size() &&
+        input.find_first_not_of("-0123456789.eE") == std::string::npos)
     {
-        size_t pos = 0;
-        long long intermediate = std::stoll(input, &pos);
-        if (intermediate > std::numeric_limits<short>::max() ||
-            intermediate < std::numeric_limits<short>::min())
-        {
-            throw std::overflow_error("Numeric overflow when converting string to short");
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to short");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
+        throw std::runtime_error(std::string("Invalid format for ") + number_type_name<T>() + " conversion");
     }
-
-    return from_string<short>(output, input);
 }
 
-// Specialization for unsigned int with range checking and negative value detection
-template <>
-bool cast_string_to_number<unsigned int>(unsigned int &output, const std::string &input)
+// Parses number in a single pass, throws overflow_error if value does not fit in T
+// and underflow_error for negative value converted to unsigned type
+template <typename T>
+bool cast_string_to_number_checked(T &output, const std::string &input)
 {
-    if (input.find('-') != std::string::npos)
-    {
-        throw std::underflow_error("Cannot convert negative value to unsigned int");
-    }
+    const char *first = input.data();
+    const char *last = first + input.size();
+    const char *end;
 
-    if (input.find_first_not_of("0123456789") != std::string::npos)
+    if (!std::numeric_limits<T>::is_signed)
     {
-        return from_string<unsigned int>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        unsigned long long intermediate = std::stoull(input, &pos);
-        if (intermediate > std::numeric_limits<unsigned int>::max())
+        const char *sign = XN_NUMBER::skip_space(first, last);
+        if (sign != last && *sign == '-')
         {
-            throw std::overflow_error("Numeric overflow when converting string to unsigned int");
+            throw std::underflow_error(std::string("Cannot convert negative value to ") + number_type_name<T>());
         }
     }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to unsigned int");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
-    }
-
-    return from_string<unsigned int>(output, input);
-}
 
-// Specialization for unsigned long with range checking and negative value detection
-template <>
-bool cast_string_to_number<unsigned long>(unsigned long &output, const std::string &input)
-{
-    if (input.find('-') != std::string::npos)
-    {
-        throw std::underflow_error("Cannot convert negative value to unsigned long");
-    }
-
-    if (input.find_first_not_of("0123456789") != std::string::npos)
+    switch (xn_parse_number(first, last, output, end))
     {
-        return from_string<unsigned long>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        unsigned long long intermediate = std::stoull(input, &pos);
-        if (sizeof(unsigned long) < sizeof(unsigned long long) &&
-            intermediate > std::numeric_limits<unsigned long>::max())
-        {
-            throw std::overflow_error("Numeric overflow when converting string to unsigned long");
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to unsigned long");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
-    }
-
-    return from_string<unsigned long>(output, input);
-}
-
-// Specialization for unsigned short with range checking and negative value detection
-template <>
-bool cast_string_to_number<unsigned short>(unsigned short &output, const std::string &input)
-{
-    if (input.find('-') != std::string::npos)
-    {
-        throw std::underflow_error("Cannot convert negative value to unsigned short");
-    }
-
-    if (input.find_first_not_of("0123456789") != std::string::npos)
-    {
-        return from_string<unsigned short>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        unsigned long long intermediate = std::stoull(input, &pos);
-        if (intermediate > std::numeric_limits<unsigned short>::max())
-        {
-            throw std::overflow_error("Numeric overflow when converting string to unsigned short");
-        }
-    }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to unsigned short");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
+    case xnsOk:
+        check_real_number_format<T>(input, end);
+        return true;
+    case xnsOutOfRange:
+        throw std::overflow_error(std::string("Numeric overflow when converting string to ") + number_type_name<T>());
+    default:
+        return false;
     }
-
-    return from_string<unsigned short>(output, input);
 }
 
-// Specialization for unsigned long long with range checking and negative value detection
+template <> inline bool cast_string_to_number<short>(short &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<int>(int &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<long>(long &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<long long>(long long &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<unsigned short>(unsigned short &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<unsigned int>(unsigned int &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<unsigned long>(unsigned long &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<unsigned long long>(unsigned long long &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+template <> inline bool cast_string_to_number<double>(double &output, const std::string &input) { return cast_string_to_number_checked(output, input); }
+
+// Specialization for float: values below float range are not convertable, values above throw overflow_error
 template <>
-bool cast_string_to_number<unsigned long long>(unsigned long long &output, const std::string &input)
+inline bool cast_string_to_number<float>(float &output, const std::string &input)
 {
-    if (input.find('-') != std::string::npos)
+    const char *end;
+    switch (xn_parse_number(input.data(), input.data() + input.size(), output, end))
     {
-        throw std::underflow_error("Cannot convert negative value to unsigned long long");
-    }
-
-    if (input.find_first_not_of("0123456789") != std::string::npos)
+    case xnsOk:
+        check_real_number_format<float>(input, end);
+        return true;
+    case xnsOutOfRange:
     {
-        return from_string<unsigned long long>(output, input);
-    }
-
-    try
-    {
-        size_t pos = 0;
-        std::stoull(input, &pos);
-        if (pos != input.length())
+        double wide;
+        if (xn_parse_number(input, wide) != xnsOk || std::abs(wide) > std::numeric_limits<float>::max())
         {
-            throw std::runtime_error("Invalid format for unsigned long long conversion");
+            throw std::overflow_error("Numeric overflow when converting string to float");
         }
+        return false;
     }
-    catch (const std::out_of_range &)
-    {
-        throw std::overflow_error("Numeric overflow when converting string to unsigned long long");
-    }
-    catch (const std::invalid_argument &)
-    {
-        // Let the from_string function handle invalid format
+    default:
+        return false;
     }
-
-    return from_string<unsigned long long>(output, input);
 }
 
 // Specialization for char that extracts a single character from string
 template <>
-bool cast_string_to_number<char>(char &output, const std::string &input)
+inline bool cast_string_to_number<char>(char &output, const std::string &input)
 {
     return extract_char_from_string(output, input);
 }
 
 // Specialization for unsigned char that extracts a single character from string
 template <>
-bool cast_string_to_number<unsigned char>(unsigned char &output, const std::string &input)
+inline bool cast_string_to_number<unsigned char>(unsigned char &output, const std::string &input)
 {
     return extract_char_from_string(output, input);
 }
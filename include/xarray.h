@@ -13,98 +13,287 @@
 #include <vector>
 #include <initializer_list>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
 #include "xnode.h"
+#include "details/xarray_small_vector.h"
+#include "details/xarray_packed.h"
+
+/// number of elements stored inside of xarray, larger arrays allocate element buffer (see details/xarray_small_vector.h)
+enum { xarray_inline_elements = 4 };
 
 // Forward declaration
-class xarray;
+template <typename NodeType, typename Allocator, size_t InlineCapacity>
+class basic_xarray;
+
+/// number of inline words of packed buffer for which packed layout of xarray (buffer + pointer to nodes
+/// created for const access) is not larger than BoxedType, so both layouts share one inline buffer
+template <typename BoxedType, typename Allocator>
+struct xarray_packed_inline_words {
+    enum { packed_layout_size = sizeof(xarray_packed_buffer<Allocator, 1>) + sizeof(void *) };
+    enum { value = (sizeof(BoxedType) >= packed_layout_size) ? (sizeof(BoxedType) - packed_layout_size) / sizeof(uint64_t) + 1 : 0 };
+};
 
 // Type code registration for xarray
-template<>
-struct xnode_type_code<xarray> {
+template<typename NodeType, typename Allocator, size_t InlineCapacity>
+struct xnode_type_code<basic_xarray<NodeType, Allocator, InlineCapacity> > {
     enum { value = 16 }; // Ensure this doesn't conflict with other type codes
 };
 
 /**
  * Custom array class for xnode objects.
  * Provides a limited array interface with static initializer "of" that accepts variable number of xnode objects.
+ * Allocator is used for element storage, see xarray_pmr for arena-allocated arrays.
+ *
+ * Elements with the same scalar type (all int, all double...) are packed: only their values are stored,
+ * like in xarray_of<T> (see details/xarray_packed.h). The first element of other type, insert, erase or
+ * non-const access by reference unpacks array to xnode elements, array is packed again only when it is empty.
+ * Const access by reference keeps packed elements and creates xnode elements once, which is safe when
+ * const array is read by many threads. node_at() reads element without unpacking.
+ *
+ * Up to InlineCapacity xnode elements are kept inside of the array object, so short arrays do not allocate
+ * element buffer. Packed values use the same inline buffer (layouts are members of a union selected by packed()),
+ * xnode elements created for const access of packed array are always allocated.
  */
-class xarray {
+template <typename NodeType = xnode, typename Allocator = std::allocator<NodeType>, size_t InlineCapacity = xarray_inline_elements>
+class basic_xarray {
 public:
     // Type definitions
-    using value_type = xnode;
-    using container_type = std::vector<value_type>;
-    using reference = container_type::reference;
-    using const_reference = container_type::const_reference;
-    using iterator = container_type::iterator;
-    using const_iterator = container_type::const_iterator;
-    using size_type = container_type::size_type;
-    using difference_type = container_type::difference_type;
+    using this_type = basic_xarray<NodeType, Allocator, InlineCapacity>;
+    using value_type = NodeType;
+    using allocator_type = Allocator;
+    using container_type = xarray_small_vector<value_type, InlineCapacity, allocator_type>;
+    using reference = typename container_type::reference;
+    using const_reference = typename container_type::const_reference;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+    using packed_type = xarray_packed_buffer<allocator_type, xarray_packed_inline_words<container_type, allocator_type>::value>;
 
     // Constructors
-    xarray() = default;
+    basic_xarray() : data_(), packed_layout_(false), boxed_state_(boxed_ready), reserved_(0) {}
+
+    explicit basic_xarray(const allocator_type& alloc) : data_(alloc), packed_layout_(false), boxed_state_(boxed_ready), reserved_(0) {}
     
-    // Copy constructor
-    xarray(const xarray& other) = default;
+    // Copy constructor, only elements in current layout are copied
+    basic_xarray(const basic_xarray& other) :
+        packed_layout_(other.packed()), boxed_state_(other.packed() ? boxed_none : boxed_ready), reserved_(0)
+    {
+        if (other.packed())
+            new (&packed_) packed_elements(other.packed_.buffer_);
+        else
+            new (&data_) container_type(other.data_);
+    }
     
     // Move constructor
-    xarray(xarray&& other) noexcept = default;
+    basic_xarray(basic_xarray&& other) noexcept :
+        packed_layout_(other.packed()), boxed_state_(other.boxed_state_.load(std::memory_order_relaxed)), reserved_(other.reserved_)
+    {
+        if (other.packed())
+            new (&packed_) packed_elements(std::move(other.packed_));
+        else
+            new (&data_) container_type(std::move(other.data_));
+        other.reset_layout();
+    }
     
     // Construct from initializer list of xnodes
-    xarray(std::initializer_list<value_type> init) : data_(init) {}
+    basic_xarray(std::initializer_list<value_type> init) :
+        data_(), packed_layout_(false), boxed_state_(boxed_ready), reserved_(init.size())
+    {
+        for (const value_type& value : init)
+            push_back(value);
+    }
+
+    ~basic_xarray() {
+        destroy_layout();
+    }
     
     // Assignment operators
-    xarray& operator=(const xarray& other) = default;
-    xarray& operator=(xarray&& other) noexcept = default;
+    basic_xarray& operator=(const basic_xarray& other) {
+        if (this != &other) {
+            if (other.packed()) {
+                use_packed_layout();
+                packed_.buffer_ = other.packed_.buffer_;
+            } else {
+                use_boxed_layout();
+                data_ = other.data_;
+            }
+            reserved_ = 0;
+        }
+        return *this;
+    }
+
+    /// does not throw unless elements have to be moved between unequal (stateful) allocators
+    basic_xarray& operator=(basic_xarray&& other) noexcept(std::is_empty<allocator_type>::value) {
+        if (this != &other) {
+            if (other.packed()) {
+                use_packed_layout();
+                packed_.buffer_ = std::move(other.packed_.buffer_);
+            } else {
+                use_boxed_layout();
+                data_ = std::move(other.data_);
+            }
+            reserved_ = other.reserved_;
+            other.reset_layout();
+        }
+        return *this;
+    }
     
     // Basic functions
-    bool empty() const { return data_.empty(); }
-    size_type size() const { return data_.size(); }
+    bool empty() const { return size() == 0; }
+    size_type size() const { return packed() ? packed_.buffer_.size() : data_.size(); }
     
     // Element access
-    reference at(size_type pos) { return data_.at(pos); }
-    const_reference at(size_type pos) const { return data_.at(pos); }
+    reference at(size_type pos) { return boxed().at(pos); }
+
+    const_reference at(size_type pos) const {
+        if (pos >= size())
+            throw std::out_of_range("xarray: index out of range");
+        return elements()[pos];
+    }
     
-    reference operator[](size_type pos) { return data_[pos]; }
-    const_reference operator[](size_type pos) const { return data_[pos]; }
+    reference operator[](size_type pos) { return boxed()[pos]; }
+    const_reference operator[](size_type pos) const { return elements()[pos]; }
+
+    /// returns copy of element, packed array is not unpacked
+    value_type node_at(size_type pos) const {
+        if (!packed())
+            return data_.at(pos);
+        if (pos >= packed_.buffer_.size())
+            throw std::out_of_range("xarray: index out of range");
+        xarray_unpack_visitor<value_type, packed_type> visitor(packed_.buffer_, pos);
+        xarray_packed_visit(packed_.buffer_.code(), visitor);
+        return visitor.node_;
+    }
     
     // Iterators
-    iterator begin() { return data_.begin(); }
-    const_iterator begin() const { return data_.begin(); }
-    const_iterator cbegin() const { return data_.cbegin(); }
+    iterator begin() { return boxed().begin(); }
+    const_iterator begin() const { return elements(); }
+    const_iterator cbegin() const { return elements(); }
     
-    iterator end() { return data_.end(); }
-    const_iterator end() const { return data_.end(); }
-    const_iterator cend() const { return data_.cend(); }
+    iterator end() { return boxed().end(); }
+    const_iterator end() const { return elements() + size(); }
+    const_iterator cend() const { return elements() + size(); }
     
     // Capacity manipulation
-    void reserve(size_type new_cap) { data_.reserve(new_cap); }
-    size_type capacity() const { return data_.capacity(); }
+    void reserve(size_type new_cap) {
+        if (packed())
+            packed_.buffer_.reserve(new_cap);
+        else if (data_.empty())
+            reserved_ = std::max(reserved_, new_cap);
+        else
+            data_.reserve(new_cap);
+    }
+
+    size_type capacity() const {
+        if (packed())
+            return packed_.buffer_.capacity();
+        return std::max(data_.capacity(), data_.empty() ? reserved_ : size_type(0));
+    }
     
     // Modifiers
-    void clear() { data_.clear(); }
-    void push_back(const value_type& value) { data_.push_back(value); }
-    void push_back(value_type&& value) { data_.push_back(std::move(value)); }
-    iterator insert(const_iterator pos, const value_type& value) { return data_.insert(pos, value); }
-    iterator insert(const_iterator pos, value_type&& value) { return data_.insert(pos, std::move(value)); }
-    iterator erase(const_iterator pos) { return data_.erase(pos); }
-    void resize(size_type count, const value_type& value = value_type()) { data_.resize(count, value); }
+    void clear() {
+        use_boxed_layout();
+        data_.clear();
+    }
+
+    void push_back(const value_type& value) {
+        if (is_boxed_element(value)) {
+            push_back(value_type(value));
+            return;
+        }
+        if (!pack(value))
+            data_.push_back(value);
+    }
+
+    void push_back(value_type&& value) {
+        if (!pack(value))
+            data_.push_back(std::move(value));
+    }
+
+    iterator insert(const_iterator pos, const value_type& value) {
+        if (is_boxed_element(value))
+            return insert(pos, value_type(value));
+        difference_type index = pos - element_data();
+        unpack();
+        return data_.insert(data_.begin() + index, value);
+    }
+
+    iterator insert(const_iterator pos, value_type&& value) {
+        difference_type index = pos - element_data();
+        unpack();
+        return data_.insert(data_.begin() + index, std::move(value));
+    }
+
+    iterator erase(const_iterator pos) {
+        difference_type index = pos - element_data();
+        unpack();
+        return data_.erase(data_.begin() + index);
+    }
+
+    void resize(size_type count, const value_type& value = value_type()) {
+        if (is_boxed_element(value)) {
+            resize(count, value_type(value));
+            return;
+        }
+        if (count < size() && packed()) {
+            drop_boxed();
+            packed_.buffer_.truncate(count);
+            return;
+        }
+        while (size() < count && (packed() || empty()) && pack(value))
+            ;
+        if (count != size()) {
+            unpack();
+            data_.resize(count, value);
+        }
+    }
+
+    /// true if elements are stored packed
+    bool packed() const { return packed_layout_; }
+
+    /// packed elements, valid if packed() is true
+    const packed_type& packed_data() const { return packed_.buffer_; }
+
+    /// converts packed elements to xnode elements, nodes created for const access are reused
+    void unpack() {
+        if (!packed())
+            return;
+        container_type nodes(allocator());
+        nodes.reserve(packed_.buffer_.size());
+        if (packed_.boxed_ != nullptr && boxed_state_.load(std::memory_order_relaxed) == boxed_ready) {
+            for (size_type i = 0, count = packed_.buffer_.size(); i < count; ++i)
+                nodes.push_back(std::move(packed_.boxed_[i]));
+        } else {
+            xarray_unpack_all_visitor<container_type, packed_type> visitor(packed_.buffer_, nodes);
+            xarray_packed_visit(packed_.buffer_.code(), visitor);
+        }
+        destroy_layout();
+        new (&data_) container_type(std::move(nodes));
+        packed_layout_ = false;
+        boxed_state_.store(boxed_ready, std::memory_order_relaxed);
+    }
       // C++17 and above: Static factory function that accepts variable number of arguments
     // and converts them directly to xnode objects    
-    
     #if __cplusplus >= 201703L
     // C++17 version that auto-converts values to xnode objects
     template <typename... Args>
-    static xarray of(Args&&... args) {
-        xarray result;
+    static this_type of(Args&&... args) {
+        this_type result;
         result.reserve(sizeof...(args));
-        (result.push_back(xnode::value_of(std::forward<Args>(args))), ...); // Fold expression (C++17)
+        (result.push_back(element_of(std::forward<Args>(args))), ...); // Fold expression (C++17)
         return result;
     }
     
     // C++17 version for direct xnode objects (to avoid unnecessary conversion)
     template <typename... Args>
-    static xarray of_nodes(const xnode& first, Args&&... args) {
-        xarray result;
+    static this_type of_nodes(const value_type& first, Args&&... args) {
+        this_type result;
         result.reserve(sizeof...(args) + 1);
         result.push_back(first);
         (result.push_back(std::forward<Args>(args)), ...); // Fold expression (C++17)
@@ -112,20 +301,31 @@ public:
     }
     
     // Specialization for empty array
-    static xarray of_nodes() {
-        return xarray();
+    static this_type of_nodes() {
+        return this_type();
+    }
+
+    // Helper function for C++17 implementation, nodes are added as they are
+    private:
+    template <typename Arg>
+    static value_type element_of(Arg&& arg) {
+        if constexpr (std::is_same<typename std::decay<Arg>::type, value_type>::value)
+            return std::forward<Arg>(arg);
+        else
+            return value_type::value_of(std::forward<Arg>(arg));
     }
+    public:
     #else
     // Pre-C++17: Recursive variadic template implementations
     
     // Version that requires explicit xnode arguments
-    static xarray of() {
-        return xarray();
+    static this_type of() {
+        return this_type();
     }
 
     template <typename... Args>
-    static xarray of(const xnode& first, const Args&... rest) {
-        xarray result;
+    static this_type of(const value_type& first, const Args&... rest) {
+        this_type result;
         result.reserve(sizeof...(rest) + 1);
         result.push_back(first);
         appendToArray(result, rest...);
@@ -133,23 +333,23 @@ public:
     }
 
     // Alias for consistency with the C++17 version
-    static xarray of_nodes() {
-        return xarray();
+    static this_type of_nodes() {
+        return this_type();
     }
 
     template <typename... Args>
-    static xarray of_nodes(const xnode& first, const Args&... rest) {
+    static this_type of_nodes(const value_type& first, const Args&... rest) {
         return of(first, rest...);
     }
 
     // Helper function for pre-C++17 implementation
     private:
-    static void appendToArray(xarray& /* array */) {
+    static void appendToArray(this_type& /* array */) {
         // Base case: no more elements to add
     }
 
     template <typename... Args>
-    static void appendToArray(xarray& array, const xnode& first, const Args&... rest) {
+    static void appendToArray(this_type& array, const value_type& first, const Args&... rest) {
         array.push_back(first);
         appendToArray(array, rest...);
     }
@@ -157,13 +357,255 @@ public:
     #endif
 
     // Compatibility with algorithms that expect STL containers
-    bool operator==(const xarray& other) const { return data_ == other.data_; }
-    bool operator!=(const xarray& other) const { return data_ != other.data_; }
-    bool operator<(const xarray& other) const { return data_ < other.data_; }
+    bool operator==(const this_type& other) const {
+        if (!packed() && !other.packed())
+            return data_ == other.data_;
+        if (packed() && other.packed() && packed_.buffer_.code() == other.packed_.buffer_.code())
+            return packed_.buffer_ == other.packed_.buffer_;
+        if (size() != other.size())
+            return false;
+        for (size_type i = 0; i < size(); ++i) {
+            if (!(node_at(i) == other.node_at(i)))
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const this_type& other) const { return !(*this == other); }
+
+    bool operator<(const this_type& other) const {
+        if (!packed() && !other.packed())
+            return data_ < other.data_;
+        size_type count = std::min(size(), other.size());
+        for (size_type i = 0; i < count; ++i) {
+            value_type lhs = node_at(i), rhs = other.node_at(i);
+            if (lhs < rhs)
+                return true;
+            if (rhs < lhs)
+                return false;
+        }
+        return size() < other.size();
+    }
 
 private:
-    container_type data_;
+    // state of data_ when elements are packed
+    enum { boxed_none, boxed_building, boxed_ready };
+
+    /// packed elements with xnode elements created from them for const access
+    struct packed_elements {
+        explicit packed_elements(const packed_type& buffer) : buffer_(buffer), boxed_(nullptr) {}
+
+        explicit packed_elements(const allocator_type& alloc) : buffer_(alloc), boxed_(nullptr) {}
+
+        packed_elements(packed_elements&& src) noexcept : buffer_(std::move(src.buffer_)), boxed_(src.boxed_) {
+            src.boxed_ = nullptr;
+        }
+
+        packed_type buffer_;
+        mutable value_type *boxed_; // buffer_.size() nodes allocated by materialize(), valid if boxed_state_ is boxed_ready
+    };
+
+    /// array of nodes filled by xarray_unpack_all_visitor, nodes are destroyed unless they are released
+    class node_builder {
+    public:
+        typedef NodeType value_type;
+
+        explicit node_builder(const allocator_type& alloc) : alloc_(alloc), items_(nullptr), size_(0), capacity_(0) {}
+
+        ~node_builder() {
+            destroy_nodes(alloc_, items_, size_, capacity_);
+        }
+
+        size_type size() const { return size_; }
+
+        void reserve(size_type count) {
+            if (count > 0) {
+                items_ = alloc_traits::allocate(alloc_, count);
+                capacity_ = count;
+            }
+        }
+
+        void push_back(value_type&& node) {
+            alloc_traits::construct(alloc_, items_ + size_, std::move(node));
+            ++size_;
+        }
+
+        value_type *release() {
+            value_type *result = items_;
+            items_ = nullptr;
+            size_ = capacity_ = 0;
+            return result;
+        }
+
+    private:
+        node_builder(const node_builder&);
+        node_builder& operator=(const node_builder&);
+
+        allocator_type alloc_;
+        value_type *items_;
+        size_type size_;
+        size_type capacity_;
+    };
+
+    typedef std::allocator_traits<allocator_type> alloc_traits;
+
+    static void destroy_nodes(allocator_type& alloc, value_type *items, size_type count, size_type capacity) {
+        if (items == nullptr)
+            return;
+        for (size_type i = 0; i < count; ++i)
+            alloc_traits::destroy(alloc, items + i);
+        alloc_traits::deallocate(alloc, items, capacity);
+    }
+
+    /// appends value to packed elements if possible, starts packing in empty array
+    bool pack(const value_type& value) {
+        int code = value.get_type_code();
+        if (packed()) {
+            if (code != packed_.buffer_.code()) {
+                unpack();
+                return false;
+            }
+            drop_boxed();
+        } else {
+            if (!data_.empty())
+                return false;
+            if (xarray_packed_size(code) == 0) {
+                data_.reserve(reserved_);
+                reserved_ = 0;
+                return false;
+            }
+            use_packed_layout();
+            packed_.buffer_.reset(code);
+            packed_.buffer_.reserve(reserved_);
+            reserved_ = 0;
+        }
+        xarray_pack_visitor<value_type, packed_type> visitor(packed_.buffer_, value);
+        xarray_packed_visit(code, visitor);
+        return true;
+    }
+
+    /// returns xnode elements, packed array is unpacked
+    container_type& boxed() {
+        unpack();
+        return data_;
+    }
+
+    /// returns xnode elements, which are created once for packed array
+    const value_type *elements() const {
+        if (!packed())
+            return data_.data();
+        materialize();
+        return packed_.boxed_;
+    }
+
+    /// true if value is a node created for const access of packed array, such nodes are removed
+    /// when the array is changed, so value has to be copied first
+    bool is_boxed_element(const value_type& value) const {
+        return packed() && packed_.boxed_ != nullptr &&
+            std::less_equal<const value_type *>()(packed_.boxed_, &value) &&
+            std::less<const value_type *>()(&value, packed_.boxed_ + packed_.buffer_.size());
+    }
+
+    /// returns xnode elements without creating them, used to find position of iterator
+    const value_type *element_data() const {
+        return packed() ? packed_.boxed_ : data_.data();
+    }
+
+    allocator_type allocator() const {
+        return packed() ? allocator_type(packed_.buffer_.get_allocator()) : data_.get_allocator();
+    }
+
+    /// creates xnode elements of packed array if they do not exist, other threads wait until they are ready
+    void materialize() const {
+        for (;;) {
+            int state = boxed_state_.load(std::memory_order_acquire);
+            if (state == boxed_ready)
+                return;
+            if (state == boxed_none && boxed_state_.compare_exchange_weak(state, boxed_building, std::memory_order_acquire)) {
+                try {
+                    node_builder nodes(allocator());
+                    xarray_unpack_all_visitor<node_builder, packed_type> visitor(packed_.buffer_, nodes);
+                    xarray_packed_visit(packed_.buffer_.code(), visitor);
+                    packed_.boxed_ = nodes.release();
+                }
+                catch (...) {
+                    boxed_state_.store(boxed_none, std::memory_order_release);
+                    throw;
+                }
+                boxed_state_.store(boxed_ready, std::memory_order_release);
+                return;
+            }
+            if (state == boxed_building)
+                std::this_thread::yield();
+        }
+    }
+
+    /// removes xnode elements created for const access before packed elements are changed
+    void drop_boxed() {
+        if (packed_.boxed_ != nullptr) {
+            allocator_type alloc(allocator());
+            size_type count = packed_.buffer_.size();
+            destroy_nodes(alloc, packed_.boxed_, count, count);
+            packed_.boxed_ = nullptr;
+        }
+        boxed_state_.store(boxed_none, std::memory_order_relaxed);
+    }
+
+    /// destroys active member of layout union
+    void destroy_layout() {
+        if (packed()) {
+            drop_boxed();
+            packed_.~packed_elements();
+        } else {
+            data_.~container_type();
+        }
+    }
+
+    /// switches empty or packed array to xnode elements, packed elements are removed
+    void use_boxed_layout() {
+        if (!packed())
+            return;
+        allocator_type alloc(allocator());
+        destroy_layout();
+        new (&data_) container_type(alloc);
+        packed_layout_ = false;
+        boxed_state_.store(boxed_ready, std::memory_order_relaxed);
+    }
+
+    /// switches array to packed elements, xnode elements are removed
+    void use_packed_layout() {
+        if (packed()) {
+            drop_boxed();
+            return;
+        }
+        allocator_type alloc(allocator());
+        destroy_layout();
+        new (&packed_) packed_elements(alloc);
+        packed_layout_ = true;
+        boxed_state_.store(boxed_none, std::memory_order_relaxed);
+    }
+
+    /// leaves moved-from array empty
+    void reset_layout() {
+        use_boxed_layout();
+        data_.clear();
+        reserved_ = 0;
+    }
+
+    // both layouts use inline buffer, so only one of them is constructed
+    union {
+        container_type data_;              // xnode elements, used if packed() is false
+        packed_elements packed_;           // packed elements, used if packed() is true
+    };
+    bool packed_layout_;
+    mutable std::atomic<int> boxed_state_; // boxed_ready if nodes of packed array are created
+    size_type reserved_;                   // capacity requested before layout of empty array is known
 };
 
+typedef basic_xarray<> xarray;
+
+/// array of arena-capable nodes, elements are allocated from current default memory resource
+typedef basic_xarray<xnode_pmr, xnode_polymorphic_allocator<xnode_pmr> > xarray_pmr;
+
 #endif // __XNODE_ARRAY_H__
 
@@ -0,0 +1,364 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_reduce.h
+// Purpose:     Sum, min, max, mean and dot product over numeric xarray elements
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XNODE_ARRAY_REDUCE_H__
+#define __XNODE_ARRAY_REDUCE_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "xnode.h"
+#include "xarray.h"
+#include "details/xarray_simd.h"
+
+/// \file xarray_reduce.h
+/// Reductions over xarray elements: xarray_sum, xarray_min, xarray_max, xarray_mean, xarray_count_if_non_null
+/// and xarray_dot. Elements are processed in runs of the same type code: packed arrays (see xarray.h) are a single
+/// run, runs of int, long, long long, float and double nodes are copied to a block of raw values. Runs are scanned
+/// with SSE2/AVX2 loops selected at run time (see details/xarray_simd.h), other elements are read with get_as<T>().
+///
+/// Results follow conversion rules of get_as<T>(): element which does not fit in T throws like ranged_cast does,
+/// element which cannot be converted (e.g. text which is not a number) throws as well. Null elements are skipped.
+/// Integer sums are calculated in long long (unsigned long long for unsigned T), floating point sums in double,
+/// sum which overflows throws. Floating point sums are added in several lanes, so the last bits of result can differ
+/// from sum of elements in order. NaN is included in sum & mean, min & max skip it.
+///
+///     double total = xarray_sum(values);
+///     long long largest = xarray_max<long long>(values);
+
+/// number of raw values copied from nodes before they are scanned
+enum { xarray_reduce_block = 256 };
+
+inline void xarray_reduce_out_of_range() {
+    XNODE_STATS(count_error(xseOutOfRange));
+    throw std::runtime_error("Value out of range for target type");
+}
+
+inline void xarray_reduce_add(long long &sum, long long value) {
+    if ((value > 0 && sum > LLONG_MAX - value) || (value < 0 && sum < LLONG_MIN - value))
+        xarray_reduce_out_of_range();
+    sum += value;
+}
+
+inline void xarray_reduce_add(unsigned long long &sum, unsigned long long value) {
+    if (sum > ULLONG_MAX - value)
+        xarray_reduce_out_of_range();
+    sum += value;
+}
+
+inline void xarray_reduce_add(double &sum, double value) {
+    sum += value;
+}
+
+/// kernel layout for values of a given type code
+inline int xarray_reduce_kind(int code) {
+    switch (code) {
+    case xnode_type_code<int>::value: return xarray_simd_kind<int>::value;
+    case xnode_type_code<long>::value: return xarray_simd_kind<long>::value;
+    case xnode_type_code<long long>::value: return xarray_simd_kind<long long>::value;
+    case xnode_type_code<float>::value: return xarray_simd_kind<float>::value;
+    case xnode_type_code<double>::value: return xarray_simd_kind<double>::value;
+    default: return xarray_simd_kind_none;
+    }
+}
+
+/// copies raw values of consecutive nodes with the same type to block
+template<typename NodeType>
+struct xarray_reduce_gather_visitor {
+    xarray_reduce_gather_visitor(const NodeType *nodes, size_t count, uint64_t *block) :
+        nodes_(nodes), count_(count), block_(block), gathered_(0) {}
+
+    template<typename T>
+    void operator()(T *) {
+        size_t limit = (count_ < size_t(xarray_reduce_block)) ? count_ : size_t(xarray_reduce_block);
+        while (gathered_ < limit) {
+            const T *value = nodes_[gathered_].template get_ptr<T>();
+            if (value == nullptr)
+                break;
+            std::memcpy(reinterpret_cast<char *>(block_) + gathered_ * sizeof(T), value, sizeof(T));
+            ++gathered_;
+        }
+    }
+
+    const NodeType *nodes_;
+    size_t count_;
+    uint64_t *block_;
+    size_t gathered_;
+};
+
+/// passes elements of array to visitor: runs of raw values to run(kind, values, count), other non-null elements
+/// to node(element)
+template<typename NodeType, typename Allocator, size_t InlineCapacity, typename Visitor>
+void xarray_reduce_walk(const basic_xarray<NodeType, Allocator, InlineCapacity> &array, Visitor &visitor) {
+    if (array.packed()) {
+        int kind = xarray_reduce_kind(array.packed_data().code());
+        if (kind != xarray_simd_kind_none) {
+            visitor.run(kind, array.packed_data().data(), array.size());
+        } else {
+            for (size_t i = 0, count = array.size(); i < count; ++i)
+                visitor.node(array.node_at(i));
+        }
+        return;
+    }
+
+    uint64_t block[xarray_reduce_block];
+    const NodeType *nodes = array.empty() ? nullptr : &array[0];
+    size_t count = array.size();
+    size_t pos = 0;
+    while (pos < count) {
+        const NodeType &node = nodes[pos];
+        int kind = xarray_reduce_kind(node.get_type_code());
+        if (kind != xarray_simd_kind_none) {
+            xarray_reduce_gather_visitor<NodeType> gather(nodes + pos, count - pos, block);
+            xarray_packed_visit(node.get_type_code(), gather);
+            if (gather.gathered_ > 0) {
+                visitor.run(kind, block, gather.gathered_);
+                pos += gather.gathered_;
+                continue;
+            }
+        }
+        if (!node.is_null())
+            visitor.node(node);
+        ++pos;
+    }
+}
+
+/// converts value with the same rules as node of type NodeType, throws if value does not fit in T
+template<typename T, typename NodeType, typename ValueType>
+inline T xarray_reduce_convert(ValueType value) {
+    return NodeType::value_of(value).template get_as<T>();
+}
+
+/// accumulator of xarray_sum<T>
+template<typename T, bool Integral = std::is_integral<T>::value>
+struct xarray_reduce_sum_type {
+    typedef double type;
+};
+
+template<typename T>
+struct xarray_reduce_sum_type<T, true> {
+    typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type type;
+};
+
+template<typename T, typename NodeType>
+struct xarray_sum_visitor {
+    typedef typename xarray_reduce_sum_type<T>::type sum_type;
+
+    xarray_sum_visitor() : sum(0), count(0) {}
+
+    void run(int kind, const void *values, size_t size) {
+        count += size;
+        if (kind == xarray_simd_kind_f32 || kind == xarray_simd_kind_f64) {
+            if (std::is_integral<T>::value) {
+                // fractions are truncated per element
+                for (size_t i = 0; i < size; ++i)
+                    add(read_real(kind, values, i));
+                return;
+            }
+            xarray_real_stats stats;
+            xarray_simd_scan_real(kind, values, size, stats);
+            if (stats.has_range()) {
+                xarray_reduce_convert<T, NodeType>(stats.min);
+                xarray_reduce_convert<T, NodeType>(stats.max);
+            }
+            xarray_reduce_add(sum, static_cast<sum_type>(stats.sum));
+            return;
+        }
+
+        xarray_int_stats stats;
+        xarray_simd_scan_int(kind, values, size, stats);
+        if (size == 0)
+            return;
+        // every element is in range of T if the lowest and the highest are
+        xarray_reduce_convert<T, NodeType>(stats.min);
+        xarray_reduce_convert<T, NodeType>(stats.max);
+        if (!stats.overflow) {
+            xarray_reduce_add(sum, static_cast<sum_type>(stats.sum));
+            return;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            long long value = (kind == xarray_simd_kind_i32) ? xarray_simd_load<int32_t>(values, i) : xarray_simd_load<long long>(values, i);
+            xarray_reduce_add(sum, static_cast<sum_type>(value));
+        }
+    }
+
+    void node(const NodeType &element) {
+        ++count;
+        xarray_reduce_add(sum, static_cast<sum_type>(element.template get_as<T>()));
+    }
+
+    T result() const {
+        return xarray_reduce_convert<T, NodeType>(sum);
+    }
+
+    void add(double value) {
+        xarray_reduce_add(sum, static_cast<sum_type>(xarray_reduce_convert<T, NodeType>(value)));
+    }
+
+    static double read_real(int kind, const void *values, size_t pos) {
+        return (kind == xarray_simd_kind_f32) ? xarray_simd_load<float>(values, pos) : xarray_simd_load<double>(values, pos);
+    }
+
+    sum_type sum;
+    size_t count;
+};
+
+template<typename T, typename NodeType, bool Max>
+struct xarray_extreme_visitor {
+    xarray_extreme_visitor() : found(false), best() {}
+
+    void run(int kind, const void *values, size_t size) {
+        if (kind == xarray_simd_kind_f32 || kind == xarray_simd_kind_f64) {
+            if (std::is_integral<T>::value) {
+                for (size_t i = 0; i < size; ++i)
+                    offer(xarray_reduce_convert<T, NodeType>(xarray_sum_visitor<T, NodeType>::read_real(kind, values, i)));
+                return;
+            }
+            xarray_real_stats stats;
+            xarray_simd_scan_real(kind, values, size, stats);
+            if (stats.has_range())
+                offer_range(xarray_reduce_convert<T, NodeType>(stats.min), xarray_reduce_convert<T, NodeType>(stats.max));
+            return;
+        }
+
+        if (size == 0)
+            return;
+        xarray_int_stats stats;
+        xarray_simd_scan_int(kind, values, size, stats);
+        offer_range(xarray_reduce_convert<T, NodeType>(stats.min), xarray_reduce_convert<T, NodeType>(stats.max));
+    }
+
+    void node(const NodeType &element) {
+        offer(element.template get_as<T>());
+    }
+
+    void offer_range(T lowest, T highest) {
+        offer(Max ? highest : lowest);
+    }
+
+    void offer(T value) {
+        if (value != value)
+            return;
+        if (!found || (Max ? (best < value) : (value < best))) {
+            best = value;
+            found = true;
+        }
+    }
+
+    T result() const {
+        if (!found)
+            throw std::runtime_error(Max ? "xarray: max of array without values" : "xarray: min of array without values");
+        return best;
+    }
+
+    bool found;
+    T best;
+};
+
+/// sum of non-null elements converted to T, 0 for array without values
+template<typename T = double, typename NodeType, typename Allocator, size_t InlineCapacity>
+T xarray_sum(const basic_xarray<NodeType, Allocator, InlineCapacity> &array) {
+    xarray_sum_visitor<T, NodeType> visitor;
+    xarray_reduce_walk(array, visitor);
+    return visitor.result();
+}
+
+/// the lowest of non-null elements converted to T, throws if there are no values (other than NaN)
+template<typename T = double, typename NodeType, typename Allocator, size_t InlineCapacity>
+T xarray_min(const basic_xarray<NodeType, Allocator, InlineCapacity> &array) {
+    xarray_extreme_visitor<T, NodeType, false> visitor;
+    xarray_reduce_walk(array, visitor);
+    return visitor.result();
+}
+
+/// the highest of non-null elements converted to T, throws if there are no values (other than NaN)
+template<typename T = double, typename NodeType, typename Allocator, size_t InlineCapacity>
+T xarray_max(const basic_xarray<NodeType, Allocator, InlineCapacity> &array) {
+    xarray_extreme_visitor<T, NodeType, true> visitor;
+    xarray_reduce_walk(array, visitor);
+    return visitor.result();
+}
+
+/// average of non-null elements, NaN for array without values
+template<typename NodeType, typename Allocator, size_t InlineCapacity>
+double xarray_mean(const basic_xarray<NodeType, Allocator, InlineCapacity> &array) {
+    xarray_sum_visitor<double, NodeType> visitor;
+    xarray_reduce_walk(array, visitor);
+    if (visitor.count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    return visitor.sum / static_cast<double>(visitor.count);
+}
+
+/// number of elements which are not null
+template<typename NodeType, typename Allocator, size_t InlineCapacity>
+size_t xarray_count_if_non_null(const basic_xarray<NodeType, Allocator, InlineCapacity> &array) {
+    if (array.packed())
+        return array.size();
+    size_t result = 0;
+    for (size_t i = 0, count = array.size(); i < count; ++i) {
+        if (!array[i].is_null())
+            ++result;
+    }
+    return result;
+}
+
+/// converts elements [pos, pos + count) to doubles, null elements are marked in present
+template<typename NodeType, typename Allocator, size_t InlineCapacity>
+void xarray_reduce_read_doubles(const basic_xarray<NodeType, Allocator, InlineCapacity> &array, size_t pos, size_t count, double *output, bool *present) {
+    int kind = array.packed() ? xarray_reduce_kind(array.packed_data().code()) : xarray_simd_kind_none;
+    for (size_t i = 0; i < count; ++i) {
+        present[i] = true;
+        switch (kind) {
+        case xarray_simd_kind_i32: output[i] = xarray_simd_load<int32_t>(array.packed_data().data(), pos + i); break;
+        case xarray_simd_kind_i64: output[i] = static_cast<double>(xarray_simd_load<long long>(array.packed_data().data(), pos + i)); break;
+        case xarray_simd_kind_f32: output[i] = xarray_simd_load<float>(array.packed_data().data(), pos + i); break;
+        case xarray_simd_kind_f64: output[i] = xarray_simd_load<double>(array.packed_data().data(), pos + i); break;
+        default:
+            if (array.packed()) {
+                output[i] = array.node_at(pos + i).template get_as<double>();
+            } else if (array[pos + i].is_null()) {
+                output[i] = 0.0;
+                present[i] = false;
+            } else {
+                output[i] = array[pos + i].template get_as<double>();
+            }
+        }
+    }
+}
+
+/// sum of products of elements with the same index converted to double, pairs with null element are skipped,
+/// throws std::invalid_argument if arrays have different sizes
+template<typename NodeType, typename Allocator, size_t InlineCapacity>
+double xarray_dot(const basic_xarray<NodeType, Allocator, InlineCapacity> &lhs, const basic_xarray<NodeType, Allocator, InlineCapacity> &rhs) {
+    if (lhs.size() != rhs.size())
+        throw std::invalid_argument("xarray: dot product of arrays with different sizes");
+    if (lhs.packed() && rhs.packed() &&
+        lhs.packed_data().code() == xnode_type_code<double>::value && rhs.packed_data().code() == xnode_type_code<double>::value)
+        return xarray_simd_dot(lhs.packed_data().data(), rhs.packed_data().data(), lhs.size());
+
+    double lhs_block[xarray_reduce_block], rhs_block[xarray_reduce_block];
+    bool lhs_present[xarray_reduce_block], rhs_present[xarray_reduce_block];
+    double result = 0.0;
+    for (size_t pos = 0, size = lhs.size(); pos < size; pos += xarray_reduce_block) {
+        size_t count = (size - pos < size_t(xarray_reduce_block)) ? size - pos : size_t(xarray_reduce_block);
+        xarray_reduce_read_doubles(lhs, pos, count, lhs_block, lhs_present);
+        xarray_reduce_read_doubles(rhs, pos, count, rhs_block, rhs_present);
+        for (size_t i = 0; i < count; ++i) {
+            if (!lhs_present[i] || !rhs_present[i])
+                lhs_block[i] = rhs_block[i] = 0.0;
+        }
+        result += xarray_simd_dot(lhs_block, rhs_block, count);
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,403 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_segmented.h
+// Purpose:     Array of nodes stored in fixed-size chunks, for large append-heavy arrays
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XNODE_ARRAY_SEGMENTED_H__
+#define __XNODE_ARRAY_SEGMENTED_H__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "xnode.h"
+#include "xarray.h"
+
+/// \file xarray_segmented.h
+/// Segmented array: elements are stored in chunks of ChunkSize nodes which are never moved, so push_back does not
+/// relocate existing elements, references to elements stay valid until element is removed and peak memory grows by
+/// one chunk at a time. Chunk which becomes empty after pop_back / pop_front is released.
+///
+///     segmented_xarray entries;
+///     entries.push_back(xnode::value_of(line));
+///     xnode node = xnode::value_of(std::move(entries));
+
+template <typename NodeType = xnode, typename Allocator = std::allocator<NodeType>, size_t ChunkSize = 1024>
+class basic_segmented_xarray;
+
+template <typename NodeType, typename Allocator, size_t ChunkSize>
+struct xnode_type_code<basic_segmented_xarray<NodeType, Allocator, ChunkSize> > {
+    enum { value = 27 };
+};
+
+/// iterator which walks elements chunk by chunk, position is recalculated only at chunk boundary
+template <typename ArrayType, typename ValueType>
+class segmented_xarray_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::remove_const<ValueType>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ValueType*;
+    using reference = ValueType&;
+    using size_type = typename ArrayType::size_type;
+
+    segmented_xarray_iterator() : owner_(nullptr), index_(0), current_(nullptr), chunk_begin_(nullptr), chunk_end_(nullptr) {}
+
+    segmented_xarray_iterator(const ArrayType *owner, size_type index) : owner_(owner), index_(index) {
+        locate();
+    }
+
+    /// conversion of iterator to const_iterator
+    template <typename OtherValue>
+    segmented_xarray_iterator(const segmented_xarray_iterator<ArrayType, OtherValue>& other) :
+        owner_(other.owner_), index_(other.index_), current_(other.current_), chunk_begin_(other.chunk_begin_), chunk_end_(other.chunk_end_) {}
+
+    reference operator*() const { return *current_; }
+    pointer operator->() const { return current_; }
+    reference operator[](difference_type offset) const { return *(*this + offset); }
+
+    segmented_xarray_iterator& operator++() {
+        ++index_;
+        if (++current_ == chunk_end_)
+            locate();
+        return *this;
+    }
+
+    segmented_xarray_iterator operator++(int) {
+        segmented_xarray_iterator result(*this);
+        ++*this;
+        return result;
+    }
+
+    segmented_xarray_iterator& operator--() {
+        --index_;
+        if (current_ == nullptr || current_ == chunk_begin_)
+            locate();
+        else
+            --current_;
+        return *this;
+    }
+
+    segmented_xarray_iterator operator--(int) {
+        segmented_xarray_iterator result(*this);
+        --*this;
+        return result;
+    }
+
+    segmented_xarray_iterator& operator+=(difference_type offset) {
+        index_ = static_cast<size_type>(static_cast<difference_type>(index_) + offset);
+        locate();
+        return *this;
+    }
+
+    segmented_xarray_iterator& operator-=(difference_type offset) { return *this += -offset; }
+
+    segmented_xarray_iterator operator+(difference_type offset) const {
+        segmented_xarray_iterator result(*this);
+        return result += offset;
+    }
+
+    segmented_xarray_iterator operator-(difference_type offset) const {
+        segmented_xarray_iterator result(*this);
+        return result -= offset;
+    }
+
+    template <typename OtherValue>
+    difference_type operator-(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+
+    template <typename OtherValue>
+    bool operator==(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const { return index_ == other.index_; }
+
+    template <typename OtherValue>
+    bool operator!=(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const { return index_ != other.index_; }
+
+    template <typename OtherValue>
+    bool operator<(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const { return index_ < other.index_; }
+
+    template <typename OtherValue>
+    bool operator>(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const { return index_ > other.index_; }
+
+    template <typename OtherValue>
+    bool operator<=(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const { return index_ <= other.index_; }
+
+    template <typename OtherValue>
+    bool operator>=(const segmented_xarray_iterator<ArrayType, OtherValue>& other) const { return index_ >= other.index_; }
+
+private:
+    template <typename OtherArray, typename OtherValue>
+    friend class segmented_xarray_iterator;
+
+    void locate() {
+        if (owner_ == nullptr || index_ >= owner_->size()) {
+            current_ = chunk_begin_ = chunk_end_ = nullptr;
+            return;
+        }
+        current_ = owner_->element_ptr(index_);
+        chunk_begin_ = current_ - owner_->chunk_offset(index_);
+        chunk_end_ = chunk_begin_ + ArrayType::chunk_size;
+    }
+
+    const ArrayType *owner_;
+    size_type index_;
+    pointer current_;
+    pointer chunk_begin_;
+    pointer chunk_end_;
+};
+
+/**
+ * Array of nodes in fixed-size chunks with interface of std::deque: O(1) push_back & pop_front without relocation
+ * of elements, chunks are allocated when needed and released when they become empty.
+ */
+template <typename NodeType, typename Allocator, size_t ChunkSize>
+class basic_segmented_xarray {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using chunk_list = std::vector<NodeType*, typename alloc_traits::template rebind_alloc<NodeType*> >;
+public:
+    using this_type = basic_segmented_xarray<NodeType, Allocator, ChunkSize>;
+    using value_type = NodeType;
+    using allocator_type = Allocator;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = segmented_xarray_iterator<this_type, value_type>;
+    using const_iterator = segmented_xarray_iterator<this_type, const value_type>;
+
+    static const size_type chunk_size = ChunkSize;
+
+    basic_segmented_xarray() : offset_(0), size_(0) {}
+
+    explicit basic_segmented_xarray(const allocator_type& alloc) :
+        alloc_(alloc), chunks_(typename chunk_list::allocator_type(alloc)), offset_(0), size_(0) {}
+
+    basic_segmented_xarray(const basic_segmented_xarray& other) :
+        alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_)), chunks_(typename chunk_list::allocator_type(alloc_)),
+        offset_(0), size_(0)
+    {
+        for (const_iterator it = other.begin(), end = other.end(); it != end; ++it)
+            push_back(*it);
+    }
+
+    basic_segmented_xarray(basic_segmented_xarray&& other) noexcept :
+        alloc_(other.alloc_), chunks_(std::move(other.chunks_)), offset_(other.offset_), size_(other.size_)
+    {
+        other.chunks_.clear();
+        other.offset_ = other.size_ = 0;
+    }
+
+    ~basic_segmented_xarray() {
+        clear();
+    }
+
+    basic_segmented_xarray& operator=(const basic_segmented_xarray& other) {
+        if (this != &other) {
+            basic_segmented_xarray copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    basic_segmented_xarray& operator=(basic_segmented_xarray&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(basic_segmented_xarray& other) noexcept {
+        std::swap(alloc_, other.alloc_);
+        chunks_.swap(other.chunks_);
+        std::swap(offset_, other.offset_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type get_allocator() const { return alloc_; }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    /// number of allocated chunks
+    size_type chunk_count() const { return chunks_.size(); }
+
+    // Element access
+    reference operator[](size_type pos) { return *element_ptr(pos); }
+    const_reference operator[](size_type pos) const { return *element_ptr(pos); }
+
+    reference at(size_type pos) {
+        check_index(pos);
+        return *element_ptr(pos);
+    }
+
+    const_reference at(size_type pos) const {
+        check_index(pos);
+        return *element_ptr(pos);
+    }
+
+    reference front() { return *element_ptr(0); }
+    const_reference front() const { return *element_ptr(0); }
+    reference back() { return *element_ptr(size_ - 1); }
+    const_reference back() const { return *element_ptr(size_ - 1); }
+
+    // Iterators
+    iterator begin() { return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return begin(); }
+
+    iterator end() { return iterator(this, size_); }
+    const_iterator end() const { return const_iterator(this, size_); }
+    const_iterator cend() const { return end(); }
+
+    // Modifiers
+    void push_back(const value_type& value) { emplace_back(value); }
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        size_type pos = offset_ + size_;
+        bool added = false;
+        if (pos == chunks_.size() * chunk_size) {
+            add_chunk();
+            added = true;
+        }
+        value_type *slot = chunks_[pos / chunk_size] + pos % chunk_size;
+        try {
+            alloc_traits::construct(alloc_, slot, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            if (added)
+                release_back_chunk();
+            throw;
+        }
+        ++size_;
+        return *slot;
+    }
+
+    /// removes the last element, releases its chunk if it becomes empty
+    void pop_back() {
+        alloc_traits::destroy(alloc_, element_ptr(size_ - 1));
+        --size_;
+        if (size_ == 0)
+            release_chunks();
+        else if ((offset_ + size_) % chunk_size == 0)
+            release_back_chunk();
+    }
+
+    /// removes the first element, releases its chunk if it becomes empty
+    void pop_front() {
+        alloc_traits::destroy(alloc_, element_ptr(0));
+        --size_;
+        if (size_ == 0) {
+            release_chunks();
+        } else if (++offset_ == chunk_size) {
+            alloc_traits::deallocate(alloc_, chunks_.front(), chunk_size);
+            chunks_.erase(chunks_.begin());
+            offset_ = 0;
+        }
+    }
+
+    /// removes all elements and releases all chunks
+    void clear() {
+        for (size_type i = 0; i < size_; ++i)
+            alloc_traits::destroy(alloc_, element_ptr(i));
+        size_ = 0;
+        release_chunks();
+    }
+
+    /// releases unused capacity of chunk list
+    void shrink_to_fit() {
+        chunks_.shrink_to_fit();
+    }
+
+    /// returns array of nodes with copies of elements
+    template <typename ArrayType = xarray>
+    ArrayType to_xarray() const {
+        ArrayType result;
+        result.reserve(size_);
+        for (const_iterator it = begin(), last = end(); it != last; ++it)
+            result.push_back(*it);
+        return result;
+    }
+
+    /// copies elements of array, packed elements are read without unpacking source
+    template <typename NodeAllocator, size_t InlineCapacity>
+    static this_type from_xarray(const basic_xarray<value_type, NodeAllocator, InlineCapacity>& src) {
+        this_type result;
+        for (size_t i = 0, count = src.size(); i < count; ++i)
+            result.push_back(src.node_at(i));
+        return result;
+    }
+
+    bool operator==(const this_type& other) const {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const this_type& other) const { return !(*this == other); }
+
+    bool operator<(const this_type& other) const {
+        return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+    }
+
+private:
+    friend iterator;
+    friend const_iterator;
+
+    value_type *element_ptr(size_type pos) const {
+        size_type absolute = offset_ + pos;
+        return chunks_[absolute / chunk_size] + absolute % chunk_size;
+    }
+
+    size_type chunk_offset(size_type pos) const {
+        return (offset_ + pos) % chunk_size;
+    }
+
+    void check_index(size_type pos) const {
+        if (pos >= size_)
+            throw std::out_of_range("segmented_xarray: index out of range");
+    }
+
+    void add_chunk() {
+        value_type *chunk = alloc_traits::allocate(alloc_, chunk_size);
+        try {
+            chunks_.push_back(chunk);
+        }
+        catch (...) {
+            alloc_traits::deallocate(alloc_, chunk, chunk_size);
+            throw;
+        }
+    }
+
+    void release_back_chunk() {
+        alloc_traits::deallocate(alloc_, chunks_.back(), chunk_size);
+        chunks_.pop_back();
+    }
+
+    void release_chunks() {
+        while (!chunks_.empty())
+            release_back_chunk();
+        offset_ = 0;
+    }
+
+    allocator_type alloc_;
+    chunk_list chunks_;
+    size_type offset_;  // position of the first element in the first chunk
+    size_type size_;
+};
+
+template <typename NodeType, typename Allocator, size_t ChunkSize>
+const typename basic_segmented_xarray<NodeType, Allocator, ChunkSize>::size_type basic_segmented_xarray<NodeType, Allocator, ChunkSize>::chunk_size;
+
+/// segmented array of nodes with chunks of 1024 elements
+typedef basic_segmented_xarray<xnode> segmented_xarray;
+
+#endif
@@ -0,0 +1,367 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_typed.h
+// Purpose:     Arrays of elements of a single type, stored without xnode per element
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XNODE_ARRAY_TYPED_H__
+#define __XNODE_ARRAY_TYPED_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+#include "xnode.h"
+#include "xarray.h"
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+/// \file xarray_typed.h
+/// Typed arrays: xarray_of<T> keeps elements in a contiguous std::vector<T>, so array of doubles takes 8 bytes
+/// per element instead of xnode, elements are read without type checks and loops over data() can be vectorized.
+/// xarray_of<bool> is bit-packed (std::vector<bool>), xarray_of<std::string> keeps texts of all elements in one
+/// character buffer.
+///
+/// Typed arrays are stored in xnode with their own type codes and can be converted to and from xarray in bulk:
+///
+///     xarray_of<double> values = xarray_of<double>::from_xarray(nodes);
+///     xnode node = xnode::value_of(std::move(values));
+///     xarray copy = node.get_ptr<xarray_of<double> >()->to_xarray();
+
+template <typename T, typename Allocator = std::allocator<T> >
+class xarray_of;
+
+template<typename Allocator>
+struct xnode_type_code<xarray_of<int64_t, Allocator> > {
+    enum { value = 22 };
+};
+
+template<typename Allocator>
+struct xnode_type_code<xarray_of<double, Allocator> > {
+    enum { value = 23 };
+};
+
+template<typename Allocator>
+struct xnode_type_code<xarray_of<bool, Allocator> > {
+    enum { value = 24 };
+};
+
+template<typename Allocator>
+struct xnode_type_code<xarray_of<std::string, Allocator> > {
+    enum { value = 25 };
+};
+
+template<typename Allocator>
+struct xnode_type_code<xarray_of<int32_t, Allocator> > {
+    enum { value = 26 };
+};
+
+/**
+ * Array of scalar values of type T, interface of std::vector + conversions to and from xnode.
+ */
+template <typename T, typename Allocator>
+class xarray_of {
+public:
+    using this_type = xarray_of<T, Allocator>;
+    using value_type = T;
+    using allocator_type = Allocator;
+    using container_type = std::vector<value_type, allocator_type>;
+    using reference = typename container_type::reference;
+    using const_reference = typename container_type::const_reference;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+
+    xarray_of() = default;
+
+    explicit xarray_of(const allocator_type& alloc) : data_(alloc) {}
+
+    explicit xarray_of(size_type count, const value_type& value = value_type()) : data_(count, value) {}
+
+    xarray_of(std::initializer_list<value_type> init) : data_(init) {}
+
+    template <typename InputIterator>
+    xarray_of(InputIterator first, InputIterator last) : data_(first, last) {}
+
+    bool empty() const { return data_.empty(); }
+    size_type size() const { return data_.size(); }
+
+    // Element access
+    reference at(size_type pos) { return data_.at(pos); }
+    const_reference at(size_type pos) const { return data_.at(pos); }
+
+    reference operator[](size_type pos) { return data_[pos]; }
+    const_reference operator[](size_type pos) const { return data_[pos]; }
+
+    /// contiguous elements, not available for bool
+    value_type *data() { return data_.data(); }
+    const value_type *data() const { return data_.data(); }
+
+    // Iterators
+    iterator begin() { return data_.begin(); }
+    const_iterator begin() const { return data_.begin(); }
+    const_iterator cbegin() const { return data_.cbegin(); }
+
+    iterator end() { return data_.end(); }
+    const_iterator end() const { return data_.end(); }
+    const_iterator cend() const { return data_.cend(); }
+
+    // Capacity manipulation
+    void reserve(size_type new_cap) { data_.reserve(new_cap); }
+    size_type capacity() const { return data_.capacity(); }
+
+    // Modifiers
+    void clear() { data_.clear(); }
+    void push_back(const value_type& value) { data_.push_back(value); }
+    void pop_back() { data_.pop_back(); }
+    iterator insert(const_iterator pos, const value_type& value) { return data_.insert(pos, value); }
+    iterator erase(const_iterator pos) { return data_.erase(pos); }
+    void resize(size_type count, const value_type& value = value_type()) { data_.resize(count, value); }
+
+    /// returns node holding copy of element
+    template <typename NodeType = xnode>
+    NodeType node_at(size_type pos) const {
+        return NodeType::value_of(static_cast<value_type>(data_.at(pos)));
+    }
+
+    /// returns array of nodes with copies of elements
+    template <typename ArrayType = xarray>
+    ArrayType to_xarray() const {
+        ArrayType result;
+        result.reserve(data_.size());
+        for (const_iterator it = data_.begin(), end = data_.end(); it != end; ++it)
+            result.push_back(ArrayType::value_type::value_of(static_cast<value_type>(*it)));
+        return result;
+    }
+
+    /// converts nodes to elements with get_as<T>, throws if any node can't be converted
+    template <typename NodeType, typename NodeAllocator, size_t InlineCapacity>
+    static this_type from_xarray(const basic_xarray<NodeType, NodeAllocator, InlineCapacity>& src) {
+        this_type result;
+        size_type count = src.size();
+        result.reserve(count);
+        if (src.packed()) {
+            // elements of packed array are read one by one, boxed nodes are not created
+            for (size_type i = 0; i < count; ++i)
+                result.data_.push_back(src.node_at(i).template get_as<value_type>());
+        } else {
+            for (size_type i = 0; i < count; ++i)
+                result.data_.push_back(src[i].template get_as<value_type>());
+        }
+        return result;
+    }
+
+    bool operator==(const this_type& other) const { return data_ == other.data_; }
+    bool operator!=(const this_type& other) const { return data_ != other.data_; }
+    bool operator<(const this_type& other) const { return data_ < other.data_; }
+
+private:
+    container_type data_;
+};
+
+/**
+ * Array of texts: characters of all elements are kept in one buffer, element is (offset, length) of its text,
+ * so elements do not allocate. Elements are read as copies (std::string) or as pointer + length.
+ */
+template <typename Allocator>
+class xarray_of<std::string, Allocator> {
+    using char_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<char>;
+    using offset_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>;
+public:
+    using this_type = xarray_of<std::string, Allocator>;
+    using value_type = std::string;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    /// random access iterator, returns elements by value
+    class const_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::string value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::string *pointer;
+        typedef std::string reference;
+
+        const_iterator() : array_(nullptr), pos_(0) {}
+        const_iterator(const this_type *array, size_type pos) : array_(array), pos_(pos) {}
+
+        std::string operator*() const { return (*array_)[pos_]; }
+        std::string operator[](difference_type n) const { return (*array_)[pos_ + n]; }
+
+        const_iterator& operator++() { ++pos_; return *this; }
+        const_iterator operator++(int) { const_iterator result(*this); ++pos_; return result; }
+        const_iterator& operator--() { --pos_; return *this; }
+        const_iterator operator--(int) { const_iterator result(*this); --pos_; return result; }
+        const_iterator& operator+=(difference_type n) { pos_ += n; return *this; }
+        const_iterator& operator-=(difference_type n) { pos_ -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(array_, pos_ + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(array_, pos_ - n); }
+        difference_type operator-(const const_iterator& rhs) const { return static_cast<difference_type>(pos_) - static_cast<difference_type>(rhs.pos_); }
+
+        bool operator==(const const_iterator& rhs) const { return pos_ == rhs.pos_; }
+        bool operator!=(const const_iterator& rhs) const { return pos_ != rhs.pos_; }
+        bool operator<(const const_iterator& rhs) const { return pos_ < rhs.pos_; }
+
+    private:
+        const this_type *array_;
+        size_type pos_;
+    };
+    using iterator = const_iterator;
+
+    xarray_of() : offsets_(1, 0) {}
+
+    explicit xarray_of(const allocator_type& alloc) :
+        chars_(char_allocator_type(alloc)), offsets_(1, 0, offset_allocator_type(alloc)) {}
+
+    xarray_of(std::initializer_list<value_type> init) : offsets_(1, 0) {
+        reserve(init.size());
+        for (const value_type& text : init)
+            push_back(text);
+    }
+
+    template <typename InputIterator>
+    xarray_of(InputIterator first, InputIterator last) : offsets_(1, 0) {
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    bool empty() const { return size() == 0; }
+    size_type size() const { return offsets_.size() - 1; }
+
+    // Element access
+    value_type at(size_type pos) const {
+        check_pos(pos);
+        return (*this)[pos];
+    }
+
+    value_type operator[](size_type pos) const { return value_type(data(pos), length(pos)); }
+
+    /// text of element, not terminated with zero
+    const char *data(size_type pos) const { return chars_.data() + offsets_[pos]; }
+
+    size_type length(size_type pos) const { return offsets_[pos + 1] - offsets_[pos]; }
+
+#if __cplusplus >= 201703L
+    std::string_view view(size_type pos) const { return std::string_view(data(pos), length(pos)); }
+#endif
+
+    // Iterators
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    const_iterator cend() const { return end(); }
+
+    /// prepares space for a given number of elements and optionally for their total length
+    void reserve(size_type new_cap, size_type char_count = 0) {
+        offsets_.reserve(new_cap + 1);
+        if (char_count > 0)
+            chars_.reserve(char_count);
+    }
+
+    size_type capacity() const { return offsets_.capacity() - 1; }
+
+    // Modifiers
+    void clear() {
+        chars_.clear();
+        offsets_.resize(1);
+    }
+
+    void push_back(const char *text, size_type length) {
+        chars_.insert(chars_.end(), text, text + length);
+        offsets_.push_back(chars_.size());
+    }
+
+    void push_back(const value_type& value) { push_back(value.data(), value.size()); }
+
+    void push_back(const char *text) { push_back(text, std::strlen(text)); }
+
+    void pop_back() {
+        offsets_.pop_back();
+        chars_.resize(offsets_.back());
+    }
+
+    /// replaces text of element, texts of following elements are moved if length changes
+    void set(size_type pos, const value_type& value) {
+        check_pos(pos);
+        size_type old_length = length(pos);
+        chars_.erase(chars_.begin() + offsets_[pos], chars_.begin() + offsets_[pos + 1]);
+        chars_.insert(chars_.begin() + offsets_[pos], value.begin(), value.end());
+        for (size_type i = pos + 1; i < offsets_.size(); ++i)
+            offsets_[i] = offsets_[i] - old_length + value.size();
+    }
+
+    /// returns node holding copy of element
+    template <typename NodeType = xnode>
+    NodeType node_at(size_type pos) const {
+        return NodeType::value_of(at(pos));
+    }
+
+    /// returns array of nodes with copies of elements
+    template <typename ArrayType = xarray>
+    ArrayType to_xarray() const {
+        ArrayType result;
+        result.reserve(size());
+        for (size_type i = 0; i < size(); ++i)
+            result.push_back(ArrayType::value_type::value_of((*this)[i]));
+        return result;
+    }
+
+    /// converts nodes to texts with get_as<std::string>, throws if any node can't be converted
+    template <typename NodeType, typename NodeAllocator, size_t InlineCapacity>
+    static this_type from_xarray(const basic_xarray<NodeType, NodeAllocator, InlineCapacity>& src) {
+        this_type result;
+        size_type count = src.size();
+        result.reserve(count);
+        if (src.packed()) {
+            for (size_type i = 0; i < count; ++i)
+                result.push_back(src.node_at(i).template get_as<value_type>());
+        } else {
+            for (size_type i = 0; i < count; ++i)
+                result.push_back(src[i].template get_as<value_type>());
+        }
+        return result;
+    }
+
+    bool operator==(const this_type& other) const { return offsets_ == other.offsets_ && chars_ == other.chars_; }
+    bool operator!=(const this_type& other) const { return !(*this == other); }
+
+    /// lexicographical order of elements, like std::vector<std::string>
+    bool operator<(const this_type& other) const {
+        size_type count = std::min(size(), other.size());
+        for (size_type i = 0; i < count; ++i) {
+            int result = compare(data(i), length(i), other.data(i), other.length(i));
+            if (result != 0)
+                return result < 0;
+        }
+        return size() < other.size();
+    }
+
+private:
+    void check_pos(size_type pos) const {
+        if (pos >= size())
+            throw std::out_of_range("xarray_of: index out of range");
+    }
+
+    static int compare(const char *lhs, size_type lhs_length, const char *rhs, size_type rhs_length) {
+        int result = std::char_traits<char>::compare(lhs, rhs, std::min(lhs_length, rhs_length));
+        if (result != 0)
+            return result;
+        return (lhs_length < rhs_length) ? -1 : ((lhs_length > rhs_length) ? 1 : 0);
+    }
+
+    std::vector<char, char_allocator_type> chars_;
+    std::vector<size_t, offset_allocator_type> offsets_; // start of each element + end of last one
+};
+
+#endif // __XNODE_ARRAY_TYPED_H__
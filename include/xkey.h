@@ -0,0 +1,278 @@
+//----------------------------------------------------------------------------------
+// Name:        xkey.h
+// Purpose:     Interned keys for property_list (xobject field names)
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XKEY_H__
+#define __XKEY_H__
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <ostream>
+#include <functional>
+#include "xnode_memory.h"
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+/// \file xkey.h
+/// Interned strings used as keys of property_list.
+///
+/// xkey is a pointer to text stored once by interner, so it is pointer-sized, keys are compared by identity
+/// and hash of text is calculated only once, when text is interned:
+///
+///     static const xkey name_key = xkey::of("name");
+///     xobject_interned obj;
+///     obj.put(name_key, xnode::value_of(std::string("item")));
+///
+/// Keys created by xkey::of() are stored in global interner, which is never destroyed. Arena-scoped interner
+/// releases its keys when it is destroyed, keys created by different interners are never equal:
+///
+///     xkey_interner interner(&arena);
+///     {
+///         xkey_interner_scope scope(&interner);
+///         xkey key = xkey::of("name"); // from interner
+///     }
+
+/// text of interned key, allocated with space for length + 1 characters
+struct xkey_data {
+	size_t hash;
+	size_t length;
+	char text[1];
+};
+
+class xkey_interner;
+
+/// interned key, null (default constructed) key has empty text
+class xkey {
+public:
+	xkey() : data_(nullptr) {}
+
+	/// returns key with a given text from interner of current scope (global by default)
+	static xkey of(const std::string &text);
+	static xkey of(const char *text);
+
+	const char *c_str() const {
+		return data_ ? data_->text : "";
+	}
+
+	size_t size() const {
+		return data_ ? data_->length : 0;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	std::string str() const {
+		return std::string(c_str(), size());
+	}
+
+	/// hash of text, equal to std::hash<std::string> of text
+	size_t hash() const {
+		return data_ ? data_->hash : 0;
+	}
+
+	bool operator==(const xkey &rhs) const {
+		return data_ == rhs.data_;
+	}
+
+	bool operator!=(const xkey &rhs) const {
+		return data_ != rhs.data_;
+	}
+
+	/// order of identity, not of text
+	bool operator<(const xkey &rhs) const {
+		return std::less<const xkey_data *>()(data_, rhs.data_);
+	}
+
+private:
+	friend class xkey_interner;
+
+	explicit xkey(const xkey_data *data) : data_(data) {}
+
+	const xkey_data *data_;
+};
+
+inline std::ostream &operator<<(std::ostream &out, const xkey &key) {
+	return out.write(key.c_str(), static_cast<std::streamsize>(key.size()));
+}
+
+namespace std {
+	template<>
+	struct hash<xkey> {
+		size_t operator()(const xkey &key) const {
+			return key.hash();
+		}
+	};
+}
+
+/// thread-safe set of interned texts, memory of texts is allocated from a given resource
+class xkey_interner {
+public:
+	explicit xkey_interner(xnode_memory_resource *resource = xnode_new_delete_resource()) :
+		resource_(resource), count_(0)
+	{
+	}
+
+	~xkey_interner() {
+		for (size_t i = 0; i < slots_.size(); ++i) {
+			if (slots_[i] != nullptr)
+				resource_->deallocate(const_cast<xkey_data *>(slots_[i]), data_size(slots_[i]->length), alignof(xkey_data));
+		}
+	}
+
+	/// returns key for text, text is added to interner if needed
+	xkey intern(const char *text, size_t length) {
+		size_t hash = hash_text(text, length);
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (2 * (count_ + 1) > slots_.size())
+			grow();
+		size_t slot = find_slot(text, length, hash);
+		if (slots_[slot] == nullptr) {
+			slots_[slot] = create(text, length, hash);
+			++count_;
+		}
+		return xkey(slots_[slot]);
+	}
+
+	xkey intern(const std::string &text) {
+		return intern(text.data(), text.size());
+	}
+
+	xkey intern(const char *text) {
+		return intern(text, std::strlen(text));
+	}
+
+	/// returns key for text if it was already interned, null key otherwise
+	xkey find(const std::string &text) const {
+		size_t hash = hash_text(text.data(), text.size());
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (slots_.empty())
+			return xkey();
+		return xkey(slots_[find_slot(text.data(), text.size(), hash)]);
+	}
+
+	/// returns number of interned texts
+	size_t size() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return count_;
+	}
+
+	/// interner used when no scope is active, never destroyed so that keys stay valid during exit
+	static xkey_interner &global() {
+		static xkey_interner *interner = new xkey_interner();
+		return *interner;
+	}
+
+	/// returns interner selected for current thread
+	static xkey_interner &current() {
+		xkey_interner *interner = current_ref();
+		return interner ? *interner : global();
+	}
+
+	/// sets interner of current thread, returns previous one (null for global)
+	static xkey_interner *set_current(xkey_interner *interner) {
+		xkey_interner *prev = current_ref();
+		current_ref() = interner;
+		return prev;
+	}
+
+	static size_t hash_text(const char *text, size_t length) {
+#if __cplusplus >= 201703L
+		return std::hash<std::string_view>()(std::string_view(text, length));
+#else
+		return std::hash<std::string>()(std::string(text, length));
+#endif
+	}
+
+private:
+	xkey_interner(const xkey_interner &);
+	xkey_interner &operator=(const xkey_interner &);
+
+	static xkey_interner *&current_ref() {
+		static thread_local xkey_interner *interner = nullptr;
+		return interner;
+	}
+
+	static size_t data_size(size_t length) {
+		return offsetof(xkey_data, text) + length + 1;
+	}
+
+	const xkey_data *create(const char *text, size_t length, size_t hash) {
+		xkey_data *data = static_cast<xkey_data *>(resource_->allocate(data_size(length), alignof(xkey_data)));
+		data->hash = hash;
+		data->length = length;
+		std::memcpy(data->text, text, length);
+		data->text[length] = '\0';
+		return data;
+	}
+
+	/// returns slot with a given text or empty slot
+	size_t find_slot(const char *text, size_t length, size_t hash) const {
+		size_t mask = slots_.size() - 1;
+		size_t slot = hash & mask;
+		for (;;) {
+			const xkey_data *data = slots_[slot];
+			if (data == nullptr || (data->hash == hash && data->length == length && std::memcmp(data->text, text, length) == 0))
+				return slot;
+			slot = (slot + 1) & mask;
+		}
+	}
+
+	void grow() {
+		std::vector<const xkey_data *> old;
+		old.swap(slots_);
+		slots_.assign(old.empty() ? 64 : old.size() * 2, nullptr);
+		size_t mask = slots_.size() - 1;
+		for (size_t i = 0; i < old.size(); ++i) {
+			if (old[i] == nullptr)
+				continue;
+			size_t slot = old[i]->hash & mask;
+			while (slots_[slot] != nullptr)
+				slot = (slot + 1) & mask;
+			slots_[slot] = old[i];
+		}
+	}
+
+	xnode_memory_resource *resource_;
+	mutable std::mutex mutex_;
+	std::vector<const xkey_data *> slots_;
+	size_t count_;
+};
+
+/// sets interner used by xkey::of() in current thread for a lifetime of scope object
+class xkey_interner_scope {
+public:
+	explicit xkey_interner_scope(xkey_interner *interner) :
+		prev_(xkey_interner::set_current(interner))
+	{
+	}
+
+	~xkey_interner_scope() {
+		xkey_interner::set_current(prev_);
+	}
+
+private:
+	xkey_interner_scope(const xkey_interner_scope &);
+	xkey_interner_scope &operator=(const xkey_interner_scope &);
+
+	xkey_interner *prev_;
+};
+
+inline xkey xkey::of(const std::string &text) {
+	return xkey_interner::current().intern(text);
+}
+
+inline xkey xkey::of(const char *text) {
+	return xkey_interner::current().intern(text);
+}
+
+#endif
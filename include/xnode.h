@@ -14,6 +14,9 @@
 #include <cassert>
 #include <string>
 #include <memory>
+#include <new>
+#include <cstddef>
+#include <atomic>
 
 /// \file xnode.h
 /// Union-like data type able to store any scalar or structure.
@@ -32,6 +35,7 @@
 /// - automatic conversion supported between bool, char, string, floating point & integer values
 /// - custom conversion methods can be implemented (defined as politics)
 /// - no dynamic allocation for scalar values
+/// - optional in-place storage of small objects (see xnode_inline_value_policy)
 /// - move semantics implemented
 //
 /// Use cases
@@ -42,6 +46,7 @@
 
 #include "xnode_type_ext.h"
 #include "xnode_utils.h"
+#include "xnode_memory.h"
 
 class xnode_null_value
 {
@@ -66,6 +71,9 @@ enum xnode_storage_type
 	xstPointer,
 	xstCasted,
 	xstOwned,
+	xstInline,
+	xstAllocated,
+	xstShared,
 	xstUndefined
 };
 
@@ -78,6 +86,16 @@ struct xnode_type_meta
 	static const bool store_as_owned = !store_as_casted && !xnode_is_null<T>::value;
 };
 
+/// checks if owned value can be stored directly in node storage of a given capacity
+template <typename T, size_t InlineCapacity>
+struct xnode_inline_meta
+{
+	static const bool value = xnode_type_meta<T>::store_as_owned && !xnode_type_meta<T>::store_as_pointer &&
+							  (sizeof(T) <= InlineCapacity) && (alignof(T) <= alignof(void *)) &&
+							  std::is_nothrow_move_constructible<T>::value;
+};
+
+/// storage type as seen by casters, owned values are always referenced by pointer held in storage
 template <typename T>
 struct xnode_storage_meta
 {
@@ -90,14 +108,101 @@ struct xnode_storage_meta<xnode_null_value>
 	static const int storage_type = xstNull;
 };
 
+/// storage type used by node with a given value policy
+template <typename T, typename ValuePolicy>
+struct xnode_node_storage_meta
+{
+	static const bool owned = (xnode_storage_meta<T>::storage_type == xstOwned);
+	static const int storage_type = xnode_inline_meta<T, xnode_value_policy_traits<ValuePolicy>::inline_capacity>::value ? xstInline : ((xnode_value_policy_traits<ValuePolicy>::has_memory_resource && owned) ? xstAllocated : ((xnode_value_policy_traits<ValuePolicy>::shared_values && owned) ? xstShared : xnode_storage_meta<T>::storage_type));
+};
+
+/// number of pointer-sized slots required for node storage of a given capacity
+template <size_t InlineCapacity>
+struct xnode_storage_slots
+{
+	enum
+	{
+		value = (InlineCapacity > sizeof(void *)) ? (InlineCapacity + sizeof(void *) - 1) / sizeof(void *) : 1
+	};
+};
+
+/// refcounted value for shared storage, counter is placed before value so storage can point to value like for xstOwned
+template <typename T>
+struct xnode_shared_block
+{
+	typedef std::atomic<long> counter_type;
+
+	static const size_t alignment = (alignof(T) > alignof(counter_type)) ? alignof(T) : alignof(counter_type);
+	static const size_t offset = ((sizeof(counter_type) + alignof(T) - 1) / alignof(T)) * alignof(T);
+
+	template <typename... Args>
+	static T *create(Args &&...args)
+	{
+		static_assert(alignment <= alignof(std::max_align_t), "over-aligned types cannot be shared");
+		char *mem = static_cast<char *>(::operator new(offset + sizeof(T)));
+		try
+		{
+			T *result = new (static_cast<void *>(mem + offset)) T(std::forward<Args>(args)...);
+			new (static_cast<void *>(mem)) counter_type(1);
+			XNODE_STATS(count_alloc(xnode_type_code<T>::value));
+			return result;
+		}
+		catch (...)
+		{
+			::operator delete(mem);
+			throw;
+		}
+	}
+
+	static T *acquire(T *value)
+	{
+		refs(value).fetch_add(1, std::memory_order_relaxed);
+		return value;
+	}
+
+	static void release(T *value)
+	{
+		if (refs(value).fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			XNODE_STATS(count_free(xnode_type_code<T>::value));
+			char *mem = reinterpret_cast<char *>(value) - offset;
+			value->~T();
+			reinterpret_cast<counter_type *>(mem)->~counter_type();
+			::operator delete(mem);
+		}
+	}
+
+	static bool unique(const T *value)
+	{
+		return refs(value).load(std::memory_order_acquire) == 1;
+	}
+
+	/// makes value referenced by storage exclusive, copy is created if needed
+	static void unshare(T **storage)
+	{
+		if (!unique(*storage))
+		{
+			XNODE_STATS(count_copy(sizeof(T)));
+			T *copy = create(**storage);
+			release(*storage);
+			*storage = copy;
+		}
+	}
+
+	static counter_type &refs(const T *value)
+	{
+		return *reinterpret_cast<counter_type *>(const_cast<char *>(reinterpret_cast<const char *>(value)) - offset);
+	}
+};
+
 template <typename T, int storageType>
 class xnode_deleter
 {
 public:
 	/* Required interface:
 
-		static void destroy(void *ptr) {
-			delete static_cast<T *>(ptr);
+		static void destroy(void **storage) {
+			delete static_cast<T *>(*storage);
 		}
 
 		static bool needs_deleter() {
@@ -110,7 +215,7 @@ template <typename T>
 class xnode_deleter<T, xstNull>
 {
 public:
-	static void destroy(void * /* ptr */)
+	static void destroy(void ** /* storage */)
 	{
 		// empty
 	}
@@ -125,7 +230,7 @@ template <typename T>
 class xnode_deleter<T, xstPointer>
 {
 public:
-	static void destroy(void * /* ptr */)
+	static void destroy(void ** /* storage */)
 	{
 		// empty
 	}
@@ -140,7 +245,7 @@ template <typename T>
 class xnode_deleter<T, xstCasted>
 {
 public:
-	static void destroy(void * /* ptr */)
+	static void destroy(void ** /* storage */)
 	{
 		// empty
 	}
@@ -155,9 +260,10 @@ template <typename T>
 class xnode_deleter<T, xstOwned>
 {
 public:
-	static void destroy(void *ptr)
+	static void destroy(void **storage)
 	{
-		delete static_cast<T *>(ptr);
+		XNODE_STATS(count_free(xnode_type_code<T>::value));
+		delete static_cast<T *>(*storage);
 	}
 
 	static bool needs_deleter()
@@ -166,6 +272,81 @@ public:
 	}
 };
 
+template <typename T>
+class xnode_deleter<T, xstInline>
+{
+public:
+	static void destroy(void **storage)
+	{
+		reinterpret_cast<T *>(storage)->~T();
+	}
+
+	static bool needs_deleter()
+	{
+		return true;
+	}
+};
+
+template <typename T>
+class xnode_deleter<T, xstAllocated>
+{
+public:
+	static void destroy(void **storage)
+	{
+		xnode_allocated_block<T>::destroy(static_cast<T *>(*storage));
+	}
+
+	static bool needs_deleter()
+	{
+		return true;
+	}
+};
+
+template <typename T>
+class xnode_deleter<T, xstShared>
+{
+public:
+	static void destroy(void **storage)
+	{
+		xnode_shared_block<T>::release(static_cast<T *>(*storage));
+	}
+
+	static bool needs_deleter()
+	{
+		return true;
+	}
+};
+
+/// prepares storage for mutable access, required only for shared values
+template <typename T, int storageType>
+class xnode_unsharer
+{
+public:
+	static void unshare(void ** /* storage */)
+	{
+	}
+
+	static bool needs_unshare()
+	{
+		return false;
+	}
+};
+
+template <typename T>
+class xnode_unsharer<T, xstShared>
+{
+public:
+	static void unshare(void **storage)
+	{
+		xnode_shared_block<T>::unshare(reinterpret_cast<T **>(storage));
+	}
+
+	static bool needs_unshare()
+	{
+		return true;
+	}
+};
+
 template <typename T, int storageType>
 class xnode_setter
 {
@@ -176,7 +357,7 @@ public:
 	}
 
 	// copy value to already existing object using assign operator
-	static void copy(void * /* dest */, const void * /* src */)
+	static void copy(void ** /* dest */, const void * /* src */)
 	{
 		// empty
 	}
@@ -196,17 +377,37 @@ public:
 	}
 
 	// copy from another node, ignore old contents (for contructors)
-	static void init_from_node(void **dest, const void *src)
+	static void init_from_node(void **dest, void *const *src)
 	{
 		// by default, raw copy of pointers
-		*dest = const_cast<void *>(src);
+		*dest = *src;
 	}
 
 	// copy from another node using assign operator, assume old value holds pointer to existing object
-	static void copy_from_node(void * /* dest */, const void * /* src */)
+	static void copy_from_node(void ** /* dest */, void *const * /* src */)
 	{
 		// empty
 	}
+
+	// construct value from arguments in empty storage
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		T value(std::forward<Args>(args)...);
+		assign_from_value(dest, &value);
+	}
+
+	// move value to already existing object
+	static void move_assign(void **dest, void *src)
+	{
+		copy(dest, src);
+	}
+
+	// move contents of another node, ignore old contents, source is left destroyed
+	static void move(void **dest, void **src)
+	{
+		*dest = *src;
+	}
 };
 
 template <typename T>
@@ -218,7 +419,7 @@ public:
 		return false;
 	}
 
-	static void copy(void * /* dest */, const void * /* src */)
+	static void copy(void ** /* dest */, const void * /* src */)
 	{
 		// empty
 	}
@@ -234,15 +435,34 @@ public:
 		*dest = nullptr;
 	}
 
-	static void init_from_node(void **dest, const void *src)
+	static void init_from_node(void **dest, void *const *src)
 	{
-		*dest = const_cast<void *>(src);
+		*dest = *src;
 	}
 
-	static void copy_from_node(void * /* dest */, const void * /* src */)
+	static void copy_from_node(void ** /* dest */, void *const * /* src */)
 	{
 		// empty
 	}
+
+	// construct value from arguments in empty storage
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		T value(std::forward<Args>(args)...);
+		assign_from_value(dest, &value);
+	}
+
+	// move value to already existing object
+	static void move_assign(void **dest, void *src)
+	{
+		copy(dest, src);
+	}
+
+	static void move(void **dest, void **src)
+	{
+		*dest = *src;
+	}
 };
 
 template <typename T>
@@ -255,7 +475,7 @@ public:
 	}
 
 	// copy value
-	static void copy(void * /* dest */, const void * /* src */)
+	static void copy(void ** /* dest */, const void * /* src */)
 	{
 		// empty
 	}
@@ -274,16 +494,35 @@ public:
 		*dptr = *holder;
 	}
 
-	static void init_from_node(void **dest, const void *src)
+	static void init_from_node(void **dest, void *const *src)
 	{
 		// raw copy of pointers
-		*dest = const_cast<void *>(src);
+		*dest = *src;
 	}
 
-	static void copy_from_node(void * /* dest */, const void * /* src */)
+	static void copy_from_node(void ** /* dest */, void *const * /* src */)
 	{
 		// empty
 	}
+
+	// construct value from arguments in empty storage
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		T value(std::forward<Args>(args)...);
+		assign_from_value(dest, &value);
+	}
+
+	// move value to already existing object
+	static void move_assign(void **dest, void *src)
+	{
+		copy(dest, src);
+	}
+
+	static void move(void **dest, void **src)
+	{
+		*dest = *src;
+	}
 };
 
 template <typename T>
@@ -296,7 +535,7 @@ public:
 	}
 
 	// copy value
-	static void copy(void * /* dest */, const void * /* src */)
+	static void copy(void ** /* dest */, const void * /* src */)
 	{
 		// empty
 	}
@@ -313,15 +552,34 @@ public:
 		*dest = const_cast<void *>(reinterpret_cast<const void *>(*holder));
 	}
 
-	static void init_from_node(void **dest, const void *src)
+	static void init_from_node(void **dest, void *const *src)
 	{
-		*dest = const_cast<void *>(src);
+		*dest = *src;
 	}
 
-	static void copy_from_node(void * /* dest */, const void * /* src */)
+	static void copy_from_node(void ** /* dest */, void *const * /* src */)
 	{
 		// empty
 	}
+
+	// construct value from arguments in empty storage
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		T value(std::forward<Args>(args)...);
+		assign_from_value(dest, &value);
+	}
+
+	// move value to already existing object
+	static void move_assign(void **dest, void *src)
+	{
+		copy(dest, src);
+	}
+
+	static void move(void **dest, void **src)
+	{
+		*dest = *src;
+	}
 };
 
 template <typename T>
@@ -334,10 +592,10 @@ public:
 	}
 
 	// copy value
-	static void copy(void *dest, const void *src)
+	static void copy(void **dest, const void *src)
 	{
-		T *ndest = static_cast<T *>(dest);
-		T *nsrc = static_cast<T *>(const_cast<void *>(src));
+		T *ndest = static_cast<T *>(*dest);
+		const T *nsrc = static_cast<const T *>(src);
 		if (ndest)
 			*ndest = *nsrc;
 		else
@@ -348,7 +606,7 @@ public:
 	static void assign_from_value(void **dest, const void *src)
 	{
 		T **ndest = reinterpret_cast<T **>(dest);
-		T *nsrc = reinterpret_cast<T *>(const_cast<void *>(src));
+		const T *nsrc = static_cast<const T *>(src);
 		if (*ndest)
 		{
 			**ndest = *nsrc;
@@ -356,29 +614,245 @@ public:
 		else
 		{
 			*ndest = new T(*nsrc);
+			XNODE_STATS(count_alloc(xnode_type_code<T>::value));
 		}
 	}
 
 	static void hold_ptr(void **dest, void *src)
 	{
 		*dest = src;
+		XNODE_STATS(count_alloc(xnode_type_code<T>::value));
 	}
 
-	static void init_from_node(void **dest, const void *src)
+	static void init_from_node(void **dest, void *const *src)
 	{
 		T **ndest = reinterpret_cast<T **>(dest);
-		T *nsrc = reinterpret_cast<T *>(const_cast<void *>(src));
+		const T *nsrc = static_cast<const T *>(*src);
 		*ndest = new T(*nsrc);
+		XNODE_STATS(count_alloc(xnode_type_code<T>::value));
+		XNODE_STATS(count_copy(sizeof(T)));
 	}
 
-	static void copy_from_node(void *dest, const void *src)
+	static void copy_from_node(void **dest, void *const *src)
 	{
-		T *ndest = reinterpret_cast<T *>(dest);
-		T *nsrc = reinterpret_cast<T *>(const_cast<void *>(src));
+		T *ndest = static_cast<T *>(*dest);
+		const T *nsrc = static_cast<const T *>(*src);
 		*ndest = *nsrc;
+		XNODE_STATS(count_copy(sizeof(T)));
+	}
+
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		*dest = new T(std::forward<Args>(args)...);
+		XNODE_STATS(count_alloc(xnode_type_code<T>::value));
+	}
+
+	static void move_assign(void **dest, void *src)
+	{
+		*static_cast<T *>(*dest) = std::move(*static_cast<T *>(src));
+	}
+
+	static void move(void **dest, void **src)
+	{
+		*dest = *src;
+	}
+};
+
+/// owned value constructed directly in node storage, no dynamic allocation
+template <typename T>
+class xnode_setter<T, xstInline>
+{
+public:
+	static bool supports_copy()
+	{
+		return true;
+	}
+
+	static void copy(void **dest, const void *src)
+	{
+		*reinterpret_cast<T *>(dest) = *static_cast<const T *>(src);
+	}
+
+	// storage is expected to be empty
+	static void assign_from_value(void **dest, const void *src)
+	{
+		new (static_cast<void *>(dest)) T(*static_cast<const T *>(src));
+	}
+
+	static void hold_ptr(void **dest, void *src)
+	{
+		std::unique_ptr<T> holder(static_cast<T *>(src));
+		new (static_cast<void *>(dest)) T(std::move(*holder));
+	}
+
+	static void init_from_node(void **dest, void *const *src)
+	{
+		new (static_cast<void *>(dest)) T(*reinterpret_cast<const T *>(src));
+		XNODE_STATS(count_copy(sizeof(T)));
+	}
+
+	static void copy_from_node(void **dest, void *const *src)
+	{
+		*reinterpret_cast<T *>(dest) = *reinterpret_cast<const T *>(src);
+		XNODE_STATS(count_copy(sizeof(T)));
+	}
+
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		new (static_cast<void *>(dest)) T(std::forward<Args>(args)...);
+	}
+
+	static void move_assign(void **dest, void *src)
+	{
+		*reinterpret_cast<T *>(dest) = std::move(*static_cast<T *>(src));
+	}
+
+	static void move(void **dest, void **src)
+	{
+		T *nsrc = reinterpret_cast<T *>(src);
+		new (static_cast<void *>(dest)) T(std::move(*nsrc));
+		nsrc->~T();
 	}
 };
 
+/// owned value shared between node copies, copied when modified while shared
+template <typename T>
+class xnode_setter<T, xstShared>
+{
+public:
+	static bool supports_copy()
+	{
+		return true;
+	}
+
+	static void copy(void **dest, const void *src)
+	{
+		T **ndest = reinterpret_cast<T **>(dest);
+		const T *nsrc = static_cast<const T *>(src);
+		if (xnode_shared_block<T>::unique(*ndest))
+		{
+			**ndest = *nsrc;
+		}
+		else
+		{
+			T *value = xnode_shared_block<T>::create(*nsrc);
+			xnode_shared_block<T>::release(*ndest);
+			*ndest = value;
+		}
+	}
+
+	static void assign_from_value(void **dest, const void *src)
+	{
+		if (*dest)
+			copy(dest, src);
+		else
+			*dest = xnode_shared_block<T>::create(*static_cast<const T *>(src));
+	}
+
+	static void hold_ptr(void **dest, void *src)
+	{
+		std::unique_ptr<T> holder(static_cast<T *>(src));
+		*dest = xnode_shared_block<T>::create(std::move(*holder));
+	}
+
+	static void init_from_node(void **dest, void *const *src)
+	{
+		*dest = xnode_shared_block<T>::acquire(static_cast<T *>(*src));
+	}
+
+	static void copy_from_node(void **dest, void *const *src)
+	{
+		if (*dest != *src)
+		{
+			T *value = xnode_shared_block<T>::acquire(static_cast<T *>(*src));
+			xnode_shared_block<T>::release(static_cast<T *>(*dest));
+			*dest = value;
+		}
+	}
+
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		*dest = xnode_shared_block<T>::create(std::forward<Args>(args)...);
+	}
+
+	static void move_assign(void **dest, void *src)
+	{
+		T **ndest = reinterpret_cast<T **>(dest);
+		T *nsrc = static_cast<T *>(src);
+		if (xnode_shared_block<T>::unique(*ndest))
+		{
+			**ndest = std::move(*nsrc);
+		}
+		else
+		{
+			T *value = xnode_shared_block<T>::create(std::move(*nsrc));
+			xnode_shared_block<T>::release(*ndest);
+			*ndest = value;
+		}
+	}
+
+	static void move(void **dest, void **src)
+	{
+		*dest = *src;
+	}
+};
+
+/// owned value allocated from memory resource of value policy,
+/// storage holds pointer to value like for xstOwned
+template <typename T, typename ValuePolicy>
+class xnode_allocated_setter : public xnode_setter<T, xstOwned>
+{
+public:
+	static void assign_from_value(void **dest, const void *src)
+	{
+		T **ndest = reinterpret_cast<T **>(dest);
+		const T *nsrc = static_cast<const T *>(src);
+		if (*ndest)
+		{
+			**ndest = *nsrc;
+		}
+		else
+		{
+			*ndest = xnode_allocated_block<T>::create(ValuePolicy::memory_resource(), *nsrc);
+		}
+	}
+
+	// value is moved to block allocated from resource, source object is deleted
+	static void hold_ptr(void **dest, void *src)
+	{
+		std::unique_ptr<T> holder(static_cast<T *>(src));
+		*dest = xnode_allocated_block<T>::create(ValuePolicy::memory_resource(), std::move(*holder));
+	}
+
+	static void init_from_node(void **dest, void *const *src)
+	{
+		*dest = xnode_allocated_block<T>::create(ValuePolicy::memory_resource(), *static_cast<const T *>(*src));
+		XNODE_STATS(count_copy(sizeof(T)));
+	}
+
+	template <typename... Args>
+	static void construct(void **dest, Args &&...args)
+	{
+		*dest = xnode_allocated_block<T>::create(ValuePolicy::memory_resource(), std::forward<Args>(args)...);
+	}
+};
+
+/// setter used for a given storage type of node, only allocated storage depends on value policy
+template <typename T, int storageType, typename ValuePolicy>
+struct xnode_policy_setter
+{
+	typedef xnode_setter<T, storageType> type;
+};
+
+template <typename T, typename ValuePolicy>
+struct xnode_policy_setter<T, xstAllocated, ValuePolicy>
+{
+	typedef xnode_allocated_setter<T, ValuePolicy> type;
+};
+
 // default, same as null
 template <typename T, int storageType>
 class xnode_getter
@@ -407,14 +881,14 @@ public:
 		// empty
 	}
 
-	static bool equals(void *lhs, void *rhs)
+	static bool equals(void **lhs, void **rhs)
 	{
-		return lhs == rhs;
+		return *lhs == *rhs;
 	}
 
-	static bool less(void *lhs, void *rhs)
+	static bool less(void **lhs, void **rhs)
 	{
-		return lhs < rhs;
+		return *lhs < *rhs;
 	}
 };
 
@@ -444,14 +918,14 @@ public:
 		*destPtr = reinterpret_cast<T>(*src);
 	}
 
-	static bool equals(void *lhs, void *rhs)
+	static bool equals(void **lhs, void **rhs)
 	{
-		return lhs == rhs;
+		return *lhs == *rhs;
 	}
 
-	static bool less(void *lhs, void *rhs)
+	static bool less(void **lhs, void **rhs)
 	{
-		return lhs < rhs;
+		return *lhs < *rhs;
 	}
 };
 
@@ -481,15 +955,15 @@ public:
 		*destPtr = *reinterpret_cast<T *>(src);
 	}
 
-	static bool equals(void *lhs, void *rhs)
+	static bool equals(void **lhs, void **rhs)
 	{
-		return lhs == rhs;
+		return *lhs == *rhs;
 	}
 
-	static bool less(void *lhs, void *rhs)
+	static bool less(void **lhs, void **rhs)
 	{
-		T *lptr = reinterpret_cast<T *>(&lhs);
-		T *rptr = reinterpret_cast<T *>(&rhs);
+		T *lptr = reinterpret_cast<T *>(lhs);
+		T *rptr = reinterpret_cast<T *>(rhs);
 		return *lptr < *rptr;
 	}
 };
@@ -520,53 +994,114 @@ public:
 		*destPtr = *reinterpret_cast<T *>(*src);
 	}
 
-	static bool equals(void *lhs, void *rhs)
+	static bool equals(void **lhs, void **rhs)
 	{
-		T *lptr = reinterpret_cast<T *>(lhs);
-		T *rptr = reinterpret_cast<T *>(rhs);
+		T *lptr = reinterpret_cast<T *>(*lhs);
+		T *rptr = reinterpret_cast<T *>(*rhs);
 		return xn_equals(*lptr, *rptr);
 	}
 
-	static bool less(void *lhs, void *rhs)
+	static bool less(void **lhs, void **rhs)
 	{
-		T *lptr = reinterpret_cast<T *>(lhs);
-		T *rptr = reinterpret_cast<T *>(rhs);
+		T *lptr = reinterpret_cast<T *>(*lhs);
+		T *rptr = reinterpret_cast<T *>(*rhs);
 		return xn_less(*lptr, *rptr);
 	}
 };
 
+template <typename T>
+class xnode_getter<T, xstInline>
+{
+public:
+	static bool supports_ptr()
+	{
+		return true;
+	}
+
+	static bool supports_read_value()
+	{
+		return true;
+	}
+
+	// returns pointer to value
+	static void *value_ptr(void **src)
+	{
+		return static_cast<void *>(src);
+	}
+
+	static void read_value(void *dest, void **src)
+	{
+		T *destPtr = reinterpret_cast<T *>(dest);
+		*destPtr = *reinterpret_cast<T *>(src);
+	}
+
+	static bool equals(void **lhs, void **rhs)
+	{
+		return xn_equals(*reinterpret_cast<T *>(lhs), *reinterpret_cast<T *>(rhs));
+	}
+
+	static bool less(void **lhs, void **rhs)
+	{
+		return xn_less(*reinterpret_cast<T *>(lhs), *reinterpret_cast<T *>(rhs));
+	}
+};
+
+template <typename T>
+class xnode_getter<T, xstAllocated> : public xnode_getter<T, xstOwned>
+{
+};
+
+template <typename T>
+class xnode_getter<T, xstShared> : public xnode_getter<T, xstOwned>
+{
+public:
+	static bool equals(void **lhs, void **rhs)
+	{
+		return (*lhs == *rhs) || xnode_getter<T, xstOwned>::equals(lhs, rhs);
+	}
+};
+
+/// All value-handling entries receive address of node storage.
 struct xnode_vtable
 {
 	int type_code_;
+	int storage_type_;
 	const std::type_info &value_type_id_;
-	void (*deleter_)(void *);
-	void (*copy_)(void *, const void *);
+	void (*deleter_)(void **);
+	void (*copy_)(void **, const void *);
 	void (*assign_)(void **, const void *);
 	void (*hold_)(void **, void *);
-	void (*init_from_node_)(void **, const void *);
-	void (*copy_from_node_)(void *, const void *);
+	void (*init_from_node_)(void **, void *const *);
+	void (*copy_from_node_)(void **, void *const *);
+	void (*move_)(void **, void **);
+	void (*unshare_)(void **);
 	void *(*value_ptr_)(void **);
 	void (*read_value_)(void *, void **);
-	bool (*equals_)(void *, void *);
-	bool (*less_)(void *, void *);
+	bool (*equals_)(void **, void **);
+	bool (*less_)(void **, void **);
 };
 
-template <typename T>
+template <typename T, int storageType = xnode_storage_meta<T>::storage_type, typename ValuePolicy = xnode_def_value_policy>
 const xnode_vtable *xnode_get_vtable()
 {
+	typedef typename xnode_policy_setter<T, storageType, ValuePolicy>::type setter;
+
 	static const xnode_vtable pt = {
 		xnode_type_code<T>::value,
+		storageType,
 		typeid(T),
-		(xnode_deleter<T, xnode_storage_meta<T>::storage_type>::needs_deleter() ? &xnode_deleter<T, xnode_storage_meta<T>::storage_type>::destroy : nullptr),
-		(xnode_setter<T, xnode_storage_meta<T>::storage_type>::supports_copy() ? &xnode_setter<T, xnode_storage_meta<T>::storage_type>::copy : nullptr),
-		&xnode_setter<T, xnode_storage_meta<T>::storage_type>::assign_from_value,
-		&xnode_setter<T, xnode_storage_meta<T>::storage_type>::hold_ptr,
-		&xnode_setter<T, xnode_storage_meta<T>::storage_type>::init_from_node,
-		(xnode_setter<T, xnode_storage_meta<T>::storage_type>::supports_copy() ? &xnode_setter<T, xnode_storage_meta<T>::storage_type>::copy_from_node : nullptr),
-		(xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_ptr() ? &xnode_getter<T, xnode_storage_meta<T>::storage_type>::value_ptr : nullptr),
-		&xnode_getter<T, xnode_storage_meta<T>::storage_type>::read_value,
-		&xnode_getter<T, xnode_storage_meta<T>::storage_type>::equals,
-		&xnode_getter<T, xnode_storage_meta<T>::storage_type>::less};
+		(xnode_deleter<T, storageType>::needs_deleter() ? &xnode_deleter<T, storageType>::destroy : nullptr),
+		(setter::supports_copy() ? &setter::copy : nullptr),
+		&setter::assign_from_value,
+		&setter::hold_ptr,
+		&setter::init_from_node,
+		(setter::supports_copy() ? &setter::copy_from_node : nullptr),
+		&setter::move,
+		(xnode_unsharer<T, storageType>::needs_unshare() ? &xnode_unsharer<T, storageType>::unshare : nullptr),
+		(xnode_getter<T, storageType>::supports_ptr() ? &xnode_getter<T, storageType>::value_ptr : nullptr),
+		&xnode_getter<T, storageType>::read_value,
+		&xnode_getter<T, storageType>::equals,
+		&xnode_getter<T, storageType>::less};
 
 	return &pt;
 }
@@ -589,7 +1124,7 @@ void xnode_set_scalar(void **storage, T value)
 	xnode_setter<T, xnode_storage_meta<T>::storage_type>::assign_from_value(storage, &value);
 }
 
-std::string xnode_pack_value_as_str(const char *text)
+inline std::string xnode_pack_value_as_str(const char *text)
 {
 	return std::string(text);
 }
@@ -604,20 +1139,26 @@ public:
 	typedef basic_xnode<ValuePolicy> this_type;
 	typedef ValuePolicy value_policy;
 
-	basic_xnode() : vtable_(xnode_get_vtable<xnode_null_value>()), value_(nullptr)
+	/// max size of value which can be stored in node without dynamic allocation
+	static const size_t inline_capacity = xnode_value_policy_traits<ValuePolicy>::inline_capacity;
+
+	basic_xnode() : vtable_(xnode_get_vtable<xnode_null_value>()), value_()
 	{
 	}
 
 	basic_xnode(const basic_xnode &src)
 	{
 		vtable_ = src.vtable_;
-		vtable_->init_from_node_(&value_, src.value_);
+		vtable_->init_from_node_(value_, src.value_);
 	}
 
-	basic_xnode(basic_xnode &&src) : vtable_(xnode_get_vtable<xnode_null_value>()), value_(nullptr)
+	/// values are moved by pointer or by nothrow move of inline value, so containers of nodes (std::vector)
+	/// relocate nodes by move
+	basic_xnode(basic_xnode &&src) noexcept : vtable_(src.vtable_)
 	{
-		std::swap(vtable_, src.vtable_);
-		std::swap(value_, src.value_);
+		vtable_->move_(value_, src.value_);
+		src.vtable_ = xnode_get_vtable<xnode_null_value>();
+		src.value_[0] = nullptr;
 	}
 
 	~basic_xnode()
@@ -631,7 +1172,7 @@ public:
 		if (this == &src)
 			return *this;
 
-		if ((type() == src.type()) && (vtable_->copy_from_node_ != nullptr))
+		if (has_same_type(src) && (vtable_->copy_from_node_ != nullptr))
 		{
 			vtable_->copy_from_node_(value_, src.value_);
 		}
@@ -639,18 +1180,21 @@ public:
 		{
 			destroy();
 			vtable_ = src.vtable_;
-			vtable_->init_from_node_(&value_, src.value_);
+			vtable_->init_from_node_(value_, src.value_);
 		}
 
 		return *this;
 	}
 
-	basic_xnode &operator=(basic_xnode &&src)
+	basic_xnode &operator=(basic_xnode &&src) noexcept
 	{
 		if (this != &src)
 		{
-			std::swap(vtable_, src.vtable_);
-			std::swap(value_, src.value_);
+			destroy();
+			vtable_ = src.vtable_;
+			vtable_->move_(value_, src.value_);
+			src.vtable_ = xnode_get_vtable<xnode_null_value>();
+			src.value_[0] = nullptr;
 		}
 
 		return *this;
@@ -661,9 +1205,9 @@ public:
 	{
 		if (get_type_code() != rhs.get_type_code())
 			return false;
-		if (type() != rhs.type())
+		if (!has_same_type(rhs))
 			return false;
-		return vtable_->equals_(value_, rhs.value_);
+		return vtable_->equals_(const_cast<void **>(value_), const_cast<void **>(rhs.value_));
 	}
 
 	/// compares type and value of nodes
@@ -677,9 +1221,9 @@ public:
 	{
 		if (get_type_code() != rhs.get_type_code())
 			return get_type_code() < rhs.get_type_code(); // for ordering by type in multi-type container
-		if (type() != rhs.type())
+		if (!has_same_type(rhs))
 			return false;
-		return vtable_->less_(value_, rhs.value_);
+		return vtable_->less_(const_cast<void **>(value_), const_cast<void **>(rhs.value_));
 	}
 
 	/* Not recommended to use / define (because of casting):
@@ -711,14 +1255,14 @@ public:
 	/// checks if node has a null value
 	bool is_null() const
 	{
-		return (value_ == nullptr) && (vtable_->value_type_id_ == typeid(xnode_null_value));
+		return (value_[0] == nullptr) && holds_type<xnode_null_value>();
 	}
 
 	/// remove contents of node
 	void reset()
 	{
 		destroy();
-		value_ = nullptr;
+		value_[0] = nullptr;
 		vtable_ = xnode_get_vtable<xnode_null_value>();
 	}
 
@@ -726,9 +1270,9 @@ public:
 	template <typename T>
 	void set_as(const T &value, typename std::enable_if<!std::is_array<T>::value>::type * = 0)
 	{
-		if ((typeid(T) == type()) && (xnode_setter<T, xnode_storage_meta<T>::storage_type>::supports_copy()))
+		if (holds_type<T>() && (node_storage<T>::setter::supports_copy()))
 		{
-			vtable_->copy_(value_, static_cast<const void *>(&value));
+			node_storage<T>::setter::copy(value_, static_cast<const void *>(&value));
 		}
 		else
 		{
@@ -736,6 +1280,30 @@ public:
 		}
 	}
 
+	/// set value and type of node, value is moved into node
+	template <typename T>
+	void set_as(T &&value, typename std::enable_if<!std::is_lvalue_reference<T>::value && !std::is_const<T>::value && !std::is_array<T>::value>::type * = 0)
+	{
+		if (holds_type<T>() && (node_storage<T>::setter::supports_copy()))
+		{
+			node_storage<T>::setter::move_assign(value_, static_cast<void *>(&value));
+		}
+		else
+		{
+			emplace<T>(std::move(value));
+		}
+	}
+
+	/// constructs value of type T inside node from given arguments, without temporary copies
+	/// if constructor throws, node is left null
+	template <typename T, typename... Args>
+	void emplace(Args &&...args)
+	{
+		reset();
+		node_storage<T>::setter::construct(value_, std::forward<Args>(args)...);
+		vtable_ = vtable_of<T>();
+	}
+
 	/// set value and type of node for character arrays (string literals)
 	template <typename T>
 	void set_as(const T &value, typename std::enable_if<std::is_array<T>::value>::type * = 0)
@@ -747,13 +1315,16 @@ public:
 	template <typename T>
 	void set_value(const T &value)
 	{
-		if ((typeid(T) == type()) && (xnode_setter<T, xnode_storage_meta<T>::storage_type>::supports_copy()))
+		if (holds_type<T>() && (node_storage<T>::setter::supports_copy()))
 		{
-			vtable_->copy_(value_, static_cast<const void *>(&value));
+			node_storage<T>::setter::copy(value_, static_cast<const void *>(&value));
 		}
 		else
 		{
-			if (!xnode_caster<T, typename value_policy::cast_policy>::cast_from_value(&value_, vtable_->type_code_, value))
+			void *proxy;
+			if (vtable_->unshare_)
+				vtable_->unshare_(value_);
+			if (!xnode_cast_row<T, typename value_policy::cast_policy>::cast_from_value(caster_storage(&proxy), vtable_->type_code_, value))
 				throwWrongCastFromValue<T>();
 		}
 	}
@@ -763,13 +1334,14 @@ public:
 	T get_as() const
 	{
 		T result;
-		if (xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_read_value() && (typeid(T) == type()))
+		if (node_storage<T>::getter::supports_read_value() && holds_type<T>())
 		{
-			vtable_->read_value_(&result, const_cast<void **>(&value_));
+			node_storage<T>::getter::read_value(&result, const_cast<void **>(value_));
 			return result;
 		}
 
-		if (!xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(result, const_cast<void **>(&value_), vtable_->type_code_))
+		void *proxy;
+		if (!xnode_cast_row<T, typename value_policy::cast_policy>::cast_to_value(result, caster_storage(&proxy), vtable_->type_code_))
 		{
 			throwWrongCastToValue<T>();
 		}
@@ -780,13 +1352,14 @@ public:
 	template <typename T>
 	T &get_as(T &output)
 	{
-		if (xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_read_value() && (typeid(T) == type()))
+		if (node_storage<T>::getter::supports_read_value() && holds_type<T>())
 		{
-			vtable_->read_value_(&output, &value_);
+			node_storage<T>::getter::read_value(&output, value_);
 			return output;
 		}
 
-		if (!xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(output, &value_, vtable_->type_code_))
+		void *proxy;
+		if (!xnode_cast_row<T, typename value_policy::cast_policy>::cast_to_value(output, caster_storage(&proxy), vtable_->type_code_))
 			throwWrongCastToValue<T>();
 
 		return output;
@@ -799,13 +1372,14 @@ public:
 	T get_as_def(const T &def_value) const
 	{
 		T result;
-		if (xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_read_value() && (typeid(T) == type()))
+		if (node_storage<T>::getter::supports_read_value() && holds_type<T>())
 		{
-			vtable_->read_value_(&result, const_cast<void **>(&value_));
+			node_storage<T>::getter::read_value(&result, const_cast<void **>(value_));
 			return result;
 		}
 
-		if (xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(result, const_cast<void **>(&value_), vtable_->type_code_))
+		void *proxy;
+		if (xnode_cast_row<T, typename value_policy::cast_policy>::cast_to_value(result, caster_storage(&proxy), vtable_->type_code_))
 			return result;
 
 		return def_value;
@@ -817,13 +1391,14 @@ public:
 	template <typename T>
 	T &get_as_def(T &output, const T &def_value)
 	{
-		if (xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_read_value() && (typeid(T) == type()))
+		if (node_storage<T>::getter::supports_read_value() && holds_type<T>())
 		{
-			vtable_->read_value_(&output, &value_);
+			node_storage<T>::getter::read_value(&output, value_);
 			return output;
 		}
 
-		if (xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(output, &value_, vtable_->type_code_))
+		void *proxy;
+		if (xnode_cast_row<T, typename value_policy::cast_policy>::cast_to_value(output, caster_storage(&proxy), vtable_->type_code_))
 			return output;
 
 		return def_value;
@@ -831,16 +1406,17 @@ public:
 
 	/// returns true if node can be read as a given type
 	template <typename T>
-	bool is_convertable_to()
+	bool is_convertable_to() const
 	{
-		if (xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_read_value() && (typeid(T) == type()))
+		if (node_storage<T>::getter::supports_read_value() && holds_type<T>())
 		{
 			return true;
 		}
 		else
 		{
 			T tmp;
-			return xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(tmp, &value_, vtable_->type_code_);
+			void *proxy;
+			return xnode_cast_row<T, typename value_policy::cast_policy>::cast_to_value(tmp, caster_storage(&proxy), vtable_->type_code_);
 		}
 	}
 
@@ -848,11 +1424,14 @@ public:
 	template <typename T>
 	T *get_ptr()
 	{
-		if (!xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_ptr())
+		if (!node_storage<T>::getter::supports_ptr())
 			return nullptr;
 
-		if (typeid(T) == type())
-			return static_cast<T *>(vtable_->value_ptr_(&value_));
+		if (holds_type<T>())
+		{
+			xnode_unsharer<T, node_storage<T>::storage_type>::unshare(value_);
+			return static_cast<T *>(node_storage<T>::getter::value_ptr(value_));
+		}
 
 		return nullptr;
 	}
@@ -861,11 +1440,11 @@ public:
 	template <typename T>
 	const T *get_ptr() const
 	{
-		if (!xnode_getter<T, xnode_storage_meta<T>::storage_type>::supports_ptr())
+		if (!node_storage<T>::getter::supports_ptr())
 			return nullptr;
-		if (typeid(T) != type())
+		if (!holds_type<T>())
 			return nullptr;
-		return static_cast<T *>(vtable_->value_ptr_(const_cast<void **>(&value_)));
+		return static_cast<T *>(node_storage<T>::getter::value_ptr(const_cast<void **>(value_)));
 	}
 
 	/// returns (void *) pointer to value if supported, otherwise null
@@ -874,7 +1453,10 @@ public:
 		if (!vtable_->value_ptr_)
 			return nullptr;
 
-		return vtable_->value_ptr_(&value_);
+		if (vtable_->unshare_)
+			vtable_->unshare_(value_);
+
+		return vtable_->value_ptr_(value_);
 	}
 
 	/// returns (void *) pointer to value if supported, otherwise null
@@ -883,7 +1465,7 @@ public:
 		if (!vtable_->value_ptr_)
 			return nullptr;
 
-		return vtable_->value_ptr_(&value_);
+		return vtable_->value_ptr_(const_cast<void **>(value_));
 	}
 
 	/// returns reference to stored value, throws if cannot be retrieved
@@ -932,10 +1514,23 @@ public:
 
 		if (vtable_->deleter_ != nullptr)
 		{
-			result.reset(get_ptr<T>());
+			if (vtable_->storage_type_ != xstOwned)
+			{
+				// there is no object allocated by new to hand over, move value out of node
+				T *ptr = get_ptr<T>();
+				if (ptr)
+					result.reset(new T(std::move(*ptr)));
+				destroy();
+			}
+			else
+			{
+				result.reset(get_ptr<T>());
+				if (result)
+					XNODE_STATS(count_free(vtable_->type_code_));
+			}
 		}
 
-		value_ = nullptr;
+		value_[0] = nullptr;
 		vtable_ = xnode_get_vtable<xnode_null_value>();
 
 		if (result.get())
@@ -950,15 +1545,16 @@ public:
 	{
 		std::unique_ptr<T> holder(value);
 		destroy();
-		vtable_ = xnode_get_vtable<T>();
-		vtable_->hold_(&value_, holder.release());
+		value_[0] = nullptr;
+		vtable_ = vtable_of<T>();
+		vtable_->hold_(value_, holder.release());
 	}
 
 	/// returns true if type is matching value stored in xnode
 	template <typename T>
 	bool is() const
 	{
-		return typeid(T) == type();
+		return holds_type<T>();
 	}
 
 	/// object builder function with optional type casting
@@ -969,12 +1565,10 @@ public:
 	template <typename DestType, typename ValueType>
 	static this_type value_of(const ValueType &value)
 	{
-		this_type valueNode;
-		valueNode.set_as(value);
-
-		DestType tempValue;
 		this_type result;
-		result.set_as<DestType>(valueNode.get_as(tempValue));
+		result.set_as(value);
+		if (!result.template holds_type<DestType>())
+			result.set_as(result.template get_as<DestType>());
 		return result;
 	}
 
@@ -990,6 +1584,18 @@ public:
 		return result;
 	}
 
+	/// object builder function, value is moved into node
+	/// \param[in] ValueType input value type
+	/// \param[in] value input value to be moved to xnode
+	/// \result Returns xnode of type ValueType
+	template <typename ValueType>
+	static this_type value_of(ValueType &&value, typename std::enable_if<!std::is_lvalue_reference<ValueType>::value && !std::is_const<ValueType>::value && !std::is_array<ValueType>::value>::type * = 0)
+	{
+		this_type result;
+		result.template emplace<ValueType>(std::move(value));
+		return result;
+	}
+
 	/// object builder function for arrays
 	/// \param[in] ValueType input value type
 	/// \param[in] value input value to be converted to xnode
@@ -1011,39 +1617,102 @@ protected:
 		}
 	}
 
+	/// storage handlers used by node for values of a given type
+	template <typename T>
+	struct node_storage
+	{
+		static const int storage_type = xnode_node_storage_meta<T, ValuePolicy>::storage_type;
+		typedef xnode_getter<T, storage_type> getter;
+		typedef typename xnode_policy_setter<T, storage_type, ValuePolicy>::type setter;
+		// vtables not depending on policy are shared between policies
+		typedef typename std::conditional<storage_type == xstAllocated, ValuePolicy, xnode_def_value_policy>::type vtable_policy;
+	};
+
+	/// returns vtable matching storage used for values of a given type
+	template <typename T>
+	static const xnode_vtable *vtable_of()
+	{
+		return xnode_get_vtable<T, node_storage<T>::storage_type, typename node_storage<T>::vtable_policy>();
+	}
+
+	/// returns true if node holds value of a given type,
+	/// vtable identity is checked first, type_info is compared only if vtables differ
+	/// but can still describe the same type (each shared library can have its own vtable copy)
+	template <typename T>
+	bool holds_type() const
+	{
+		const xnode_vtable *expected = vtable_of<T>();
+		if (vtable_ == expected)
+			return true;
+		if ((vtable_->type_code_ != expected->type_code_) || (vtable_->storage_type_ != expected->storage_type_))
+			return false;
+		return vtable_->value_type_id_ == expected->value_type_id_;
+	}
+
+	/// returns true if both nodes hold values of the same type
+	bool has_same_type(const basic_xnode &other) const
+	{
+		if (vtable_ == other.vtable_)
+			return true;
+		if ((vtable_->type_code_ != other.vtable_->type_code_) || (vtable_->storage_type_ != other.vtable_->storage_type_))
+			return false;
+		return vtable_->value_type_id_ == other.vtable_->value_type_id_;
+	}
+
+	/// returns storage in form expected by casters,
+	/// inline values are exposed through proxy pointer like owned ones
+	void **caster_storage(void **proxy) const
+	{
+		if (vtable_->storage_type_ == xstInline)
+		{
+			*proxy = const_cast<void *>(static_cast<const void *>(value_));
+			return proxy;
+		}
+		return const_cast<void **>(value_);
+	}
+
 	template <typename T>
 	void rebuild_as(const T &value)
 	{
-		destroy();
-		value_ = nullptr;
-		vtable_ = xnode_get_vtable<T>();
-		vtable_->assign_(&value_, static_cast<const void *>(&value));
+		const xnode_vtable *vtable = vtable_of<T>();
+		reset();
+		vtable->assign_(value_, static_cast<const void *>(&value));
+		vtable_ = vtable;
 	}
 
 	void throwRefReadFail() const
 	{
+		XNODE_STATS(count_error(xseRefReadFail));
 		throw std::runtime_error(std::string("Reference read failed, data type: ") + to_string(vtable_->type_code_) + ", name: " + vtable_->value_type_id_.name());
 	}
 
 	template <typename T>
 	void throwWrongCastToValue() const
 	{
+		XNODE_STATS(count_error(xseWrongCast));
 		throw std::runtime_error(std::string("Conversion to value failed, storage type: [ code: ") + to_string(vtable_->type_code_) + ", name: " + vtable_->value_type_id_.name() + " ], value type name: " + typeid(T).name());
 	}
 
 	template <typename T>
 	void throwWrongCastFromValue() const
 	{
+		XNODE_STATS(count_error(xseWrongCast));
 		throw std::runtime_error(std::string("Conversion from value failed, storage type: [ code: ") + to_string(vtable_->type_code_) + ", name: " + vtable_->value_type_id_.name() + " ], value type name: " + typeid(T).name());
 	}
 
 private:
 	const xnode_vtable *vtable_;
-	void *value_;
+	void *value_[xnode_storage_slots<xnode_value_policy_traits<ValuePolicy>::inline_capacity>::value];
 };
 
 typedef basic_xnode<> xnode;
 
+/// node allocating owned values from current default memory resource
+typedef basic_xnode<xnode_pmr_value_policy> xnode_pmr;
+
+/// node sharing owned values between copies (copy-on-write)
+typedef basic_xnode<xnode_cow_value_policy> xnode_cow;
+
 #include "details/xnode_builtins.h"
 
 #endif
@@ -0,0 +1,617 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_compact.h
+// Purpose:     Compact, 8-byte variant of xnode using NaN-boxing.
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XNODE_COMPACT_H__
+#define __XNODE_COMPACT_H__
+
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+#include "xnode.h"
+
+/// \file xnode_compact.h
+/// Compact variant of xnode, whole node is a single 64-bit word.
+///
+/// Encoding
+/// - double: stored as is, all NaNs are normalized to single quiet NaN
+/// - null: tagged NaN
+/// - bool, float, char, short, int, unsigned variants and 64-bit integers
+///   which fit in 40 bits: tagged NaN with type code & value in payload
+/// - everything else: tagged NaN with 48-bit pointer to dynamically allocated basic_xnode,
+///   boxing throws std::runtime_error if address of allocated node does not fit in 48 bits
+///
+/// Conversions are performed by the same casters as for basic_xnode.
+
+/// encoding of values stored directly in compact node
+/// default: value has to be boxed
+template <typename T>
+struct xnode_compact_codec
+{
+	static const bool is_direct = false;
+
+	static bool encode(const T & /* value */, uint64_t & /* payload */)
+	{
+		return false;
+	}
+
+	static T decode(uint64_t /* payload */)
+	{
+		return T();
+	}
+};
+
+/// integral types, encoded if value fits in 40 bits
+template <typename T>
+struct xnode_compact_int_codec
+{
+	static const bool is_direct = true;
+
+	static bool encode(const T &value, uint64_t &payload)
+	{
+		if (std::numeric_limits<T>::is_signed)
+		{
+			long long v = static_cast<long long>(value);
+			if ((v < -(1LL << 39)) || (v >= (1LL << 39)))
+				return false;
+			payload = static_cast<uint64_t>(v) & ((1ULL << 40) - 1);
+		}
+		else
+		{
+			unsigned long long v = static_cast<unsigned long long>(value);
+			if (v >= (1ULL << 40))
+				return false;
+			payload = v;
+		}
+		return true;
+	}
+
+	static T decode(uint64_t payload)
+	{
+		if (std::numeric_limits<T>::is_signed)
+		{
+			// sign-extend from 40 bits
+			return static_cast<T>(static_cast<int64_t>(payload << 24) >> 24);
+		}
+		return static_cast<T>(payload);
+	}
+};
+
+template <>
+struct xnode_compact_codec<bool>
+{
+	static const bool is_direct = true;
+
+	static bool encode(const bool &value, uint64_t &payload)
+	{
+		payload = value ? 1 : 0;
+		return true;
+	}
+
+	static bool decode(uint64_t payload)
+	{
+		return payload != 0;
+	}
+};
+
+template <>
+struct xnode_compact_codec<float>
+{
+	static const bool is_direct = true;
+
+	static bool encode(const float &value, uint64_t &payload)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		payload = bits;
+		return true;
+	}
+
+	static float decode(uint64_t payload)
+	{
+		uint32_t bits = static_cast<uint32_t>(payload);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+};
+
+template <> struct xnode_compact_codec<char> : xnode_compact_int_codec<char> {};
+template <> struct xnode_compact_codec<short> : xnode_compact_int_codec<short> {};
+template <> struct xnode_compact_codec<int> : xnode_compact_int_codec<int> {};
+template <> struct xnode_compact_codec<long> : xnode_compact_int_codec<long> {};
+template <> struct xnode_compact_codec<long long> : xnode_compact_int_codec<long long> {};
+template <> struct xnode_compact_codec<unsigned char> : xnode_compact_int_codec<unsigned char> {};
+template <> struct xnode_compact_codec<unsigned short> : xnode_compact_int_codec<unsigned short> {};
+template <> struct xnode_compact_codec<unsigned int> : xnode_compact_int_codec<unsigned int> {};
+template <> struct xnode_compact_codec<unsigned long> : xnode_compact_int_codec<unsigned long> {};
+template <> struct xnode_compact_codec<unsigned long long> : xnode_compact_int_codec<unsigned long long> {};
+
+/// Compact node, 8 bytes in size, with the same access interface as basic_xnode.
+/// Values which cannot be encoded directly are held in dynamically allocated basic_xnode.
+template <class ValuePolicy = xnode_def_value_policy>
+class basic_compact_xnode
+{
+public:
+	typedef basic_compact_xnode<ValuePolicy> this_type;
+	typedef ValuePolicy value_policy;
+	typedef basic_xnode<ValuePolicy> boxed_node_type;
+
+	basic_compact_xnode() : bits_(tag_null)
+	{
+	}
+
+	basic_compact_xnode(const basic_compact_xnode &src) : bits_(src.bits_)
+	{
+		if (src.is_boxed())
+			bits_ = make_boxed(new boxed_node_type(*src.boxed()));
+	}
+
+	basic_compact_xnode(basic_compact_xnode &&src) noexcept : bits_(src.bits_)
+	{
+		src.bits_ = tag_null;
+	}
+
+	~basic_compact_xnode()
+	{
+		destroy();
+	}
+
+	basic_compact_xnode &operator=(const basic_compact_xnode &src)
+	{
+		if (this == &src)
+			return *this;
+
+		if (src.is_boxed())
+		{
+			if (is_boxed())
+			{
+				*boxed() = *src.boxed();
+				return *this;
+			}
+
+			uint64_t bits = make_boxed(new boxed_node_type(*src.boxed()));
+			destroy();
+			bits_ = bits;
+		}
+		else
+		{
+			destroy();
+			bits_ = src.bits_;
+		}
+
+		return *this;
+	}
+
+	basic_compact_xnode &operator=(basic_compact_xnode &&src) noexcept
+	{
+		if (this != &src)
+		{
+			destroy();
+			bits_ = src.bits_;
+			src.bits_ = tag_null;
+		}
+
+		return *this;
+	}
+
+	/// compares type and value of nodes
+	bool operator==(const basic_compact_xnode &rhs) const
+	{
+		if (bits_ == rhs.bits_)
+			return true;
+		if (is_boxed() && rhs.is_boxed())
+			return *boxed() == *rhs.boxed();
+		return false;
+	}
+
+	/// compares type and value of nodes
+	bool operator!=(const basic_compact_xnode &rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	/// required for sorting
+	bool operator<(const basic_compact_xnode &rhs) const
+	{
+		int lcode = get_type_code();
+		int rcode = rhs.get_type_code();
+		if (lcode != rcode)
+			return lcode < rcode;
+
+		if (is_boxed() && rhs.is_boxed())
+			return *boxed() < *rhs.boxed();
+
+		if (is_boxed() || rhs.is_boxed())
+		{
+			// large & small integer of the same type
+			if (lcode == xnode_type_code<long>::value)
+				return get_as<long>() < rhs.get_as<long>();
+			if (lcode == xnode_type_code<long long>::value)
+				return get_as<long long>() < rhs.get_as<long long>();
+			if (lcode == xnode_type_code<unsigned long>::value)
+				return get_as<unsigned long>() < rhs.get_as<unsigned long>();
+			if (lcode == xnode_type_code<unsigned long long>::value)
+				return get_as<unsigned long long>() < rhs.get_as<unsigned long long>();
+			return false;
+		}
+
+		if (is_double())
+			return as_double() < rhs.as_double();
+
+		if (is_null())
+			return false;
+
+		if (lcode == xnode_type_code<float>::value)
+			return xnode_compact_codec<float>::decode(payload()) < xnode_compact_codec<float>::decode(rhs.payload());
+
+		if (is_unsigned_code(lcode))
+			return payload() < rhs.payload();
+
+		return xnode_compact_int_codec<long long>::decode(payload()) < xnode_compact_int_codec<long long>::decode(rhs.payload());
+	}
+
+	/// returns code of type of value stored in node, =0 for types which have no casting defined
+	int get_type_code() const
+	{
+		switch (bits_ & tag_mask)
+		{
+		case tag_null:
+			return xnode_type_code<xnode_null_value>::value;
+		case tag_scalar:
+			return static_cast<int>((bits_ >> code_shift) & 0xff);
+		case tag_boxed:
+			return boxed()->get_type_code();
+		default:
+			return xnode_type_code<double>::value;
+		}
+	}
+
+	/// returns type of value stored in node, compatible with built-in typeid()
+	const std::type_info &type() const
+	{
+		switch (bits_ & tag_mask)
+		{
+		case tag_null:
+			return typeid(xnode_null_value);
+		case tag_scalar:
+			return scalar_type(get_type_code());
+		case tag_boxed:
+			return boxed()->type();
+		default:
+			return typeid(double);
+		}
+	}
+
+	/// checks if node has a null value
+	bool is_null() const
+	{
+		return bits_ == tag_null;
+	}
+
+	/// returns true if value is held in dynamically allocated node
+	bool is_boxed() const
+	{
+		return (bits_ & tag_mask) == tag_boxed;
+	}
+
+	/// remove contents of node
+	void reset()
+	{
+		destroy();
+		bits_ = tag_null;
+	}
+
+	/// returns true if type is matching value stored in node
+	template <typename T>
+	bool is() const
+	{
+		if (is_boxed())
+			return boxed()->template is<T>();
+		return (xnode_type_code<T>::value != 0) && (xnode_type_code<T>::value == get_type_code());
+	}
+
+	/// set value and type of node
+	template <typename T>
+	void set_as(const T &value, typename std::enable_if<!std::is_array<T>::value>::type * = 0)
+	{
+		uint64_t bits;
+		if (encode(value, bits))
+		{
+			destroy();
+			bits_ = bits;
+		}
+		else if (is_boxed() && boxed()->template is<T>())
+		{
+			boxed()->set_as(value);
+		}
+		else
+		{
+			std::unique_ptr<boxed_node_type> holder(new boxed_node_type());
+			holder->set_as(value);
+			destroy();
+			bits_ = make_boxed(holder.release());
+		}
+	}
+
+	/// set value and type of node for character arrays (string literals)
+	template <typename T>
+	void set_as(const T &value, typename std::enable_if<std::is_array<T>::value>::type * = 0)
+	{
+		set_as(xnode_pack_value_as_str(value));
+	}
+
+	/// get copy of value with optional conversion
+	template <typename T>
+	T get_as() const
+	{
+		if (is_boxed())
+			return static_cast<const boxed_node_type *>(boxed())->template get_as<T>();
+
+		T result;
+		if (!read_value(result))
+			throwWrongCastToValue<T>();
+		return result;
+	}
+
+	/// get copy of value with optional conversion
+	/// does not throw on wrong cast
+	/// \param[in] def_value value to be used when stored value cannot be retrieved
+	template <typename T>
+	T get_as_def(const T &def_value) const
+	{
+		if (is_boxed())
+			return static_cast<const boxed_node_type *>(boxed())->get_as_def(def_value);
+
+		T result;
+		if (read_value(result))
+			return result;
+		return def_value;
+	}
+
+	/// returns true if node can be read as a given type
+	template <typename T>
+	bool is_convertable_to() const
+	{
+		if (is_boxed())
+			return static_cast<const boxed_node_type *>(boxed())->template is_convertable_to<T>();
+
+		T tmp;
+		return read_value(tmp);
+	}
+
+	/// returns pointer to stored value, available only for boxed values
+	template <typename T>
+	T *get_ptr()
+	{
+		return is_boxed() ? boxed()->template get_ptr<T>() : nullptr;
+	}
+
+	/// returns pointer to stored value, available only for boxed values
+	template <typename T>
+	const T *get_ptr() const
+	{
+		return is_boxed() ? static_cast<const boxed_node_type *>(boxed())->template get_ptr<T>() : nullptr;
+	}
+
+	/// returns reference to stored value, throws if cannot be retrieved
+	template <typename T>
+	const T &get_ref() const
+	{
+		const T *ptr = get_ptr<T>();
+
+		if (!ptr)
+			throw std::runtime_error(std::string("Reference read failed, data type: ") + to_string(get_type_code()));
+
+		return *ptr;
+	}
+
+	/// object builder function
+	template <typename ValueType>
+	static this_type value_of(const ValueType &value)
+	{
+		this_type result;
+		result.set_as(value);
+		return result;
+	}
+
+protected:
+	static const uint64_t tag_mask = 0xFFFF000000000000ULL;
+	static const uint64_t tag_null = 0xFFF9000000000000ULL;
+	static const uint64_t tag_scalar = 0xFFFA000000000000ULL;
+	static const uint64_t tag_boxed = 0xFFFB000000000000ULL;
+	static const uint64_t payload_mask = 0x000000FFFFFFFFFFULL;
+	static const uint64_t pointer_mask = 0x0000FFFFFFFFFFFFULL;
+	static const uint64_t canonical_nan = 0x7FF8000000000000ULL;
+	static const int code_shift = 40;
+
+	void destroy()
+	{
+		if (is_boxed())
+			delete boxed();
+	}
+
+	boxed_node_type *boxed() const
+	{
+		return reinterpret_cast<boxed_node_type *>(static_cast<uintptr_t>(bits_ & pointer_mask));
+	}
+
+	/// takes ownership of node, which is released if its address cannot be stored in 48 bits
+	/// (5-level paging, tagged pointers)
+	static uint64_t make_boxed(boxed_node_type *node)
+	{
+		uint64_t addr = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(node));
+		if ((addr & ~pointer_mask) != 0)
+		{
+			delete node;
+			throw std::runtime_error("Compact node cannot hold pointer wider than 48 bits");
+		}
+		return tag_boxed | addr;
+	}
+
+	bool is_double() const
+	{
+		uint64_t tag = bits_ & tag_mask;
+		return (tag != tag_null) && (tag != tag_scalar) && (tag != tag_boxed);
+	}
+
+	double as_double() const
+	{
+		double value;
+		std::memcpy(&value, &bits_, sizeof(value));
+		return value;
+	}
+
+	uint64_t payload() const
+	{
+		return bits_ & payload_mask;
+	}
+
+	static bool is_unsigned_code(int code)
+	{
+		return (code == xnode_type_code<bool>::value) ||
+			   (code >= xnode_type_code<unsigned char>::value && code <= xnode_type_code<unsigned long long>::value);
+	}
+
+	static bool encode(const double &value, uint64_t &bits)
+	{
+		if (std::isnan(value))
+		{
+			bits = canonical_nan;
+		}
+		else
+		{
+			std::memcpy(&bits, &value, sizeof(bits));
+		}
+		return true;
+	}
+
+	static bool encode(const xnode_null_value & /* value */, uint64_t &bits)
+	{
+		bits = tag_null;
+		return true;
+	}
+
+	template <typename T>
+	static bool encode(const T &value, uint64_t &bits)
+	{
+		uint64_t payload;
+		if (!xnode_compact_codec<T>::encode(value, payload))
+			return false;
+		bits = tag_scalar | (static_cast<uint64_t>(xnode_type_code<T>::value) << code_shift) | payload;
+		return true;
+	}
+
+	static const std::type_info &scalar_type(int code)
+	{
+		switch (code)
+		{
+		case xnode_type_code<bool>::value:
+			return typeid(bool);
+		case xnode_type_code<float>::value:
+			return typeid(float);
+		case xnode_type_code<char>::value:
+			return typeid(char);
+		case xnode_type_code<short>::value:
+			return typeid(short);
+		case xnode_type_code<int>::value:
+			return typeid(int);
+		case xnode_type_code<long>::value:
+			return typeid(long);
+		case xnode_type_code<long long>::value:
+			return typeid(long long);
+		case xnode_type_code<unsigned char>::value:
+			return typeid(unsigned char);
+		case xnode_type_code<unsigned short>::value:
+			return typeid(unsigned short);
+		case xnode_type_code<unsigned int>::value:
+			return typeid(unsigned int);
+		case xnode_type_code<unsigned long>::value:
+			return typeid(unsigned long);
+		default:
+			return typeid(unsigned long long);
+		}
+	}
+
+	/// converts directly stored value using casters of value policy
+	template <typename SrcType, typename T>
+	static bool cast_scalar(T &output, SrcType value)
+	{
+		void *slot = nullptr;
+		if (xnode_storage_meta<SrcType>::storage_type == xstCasted)
+			xnode_set_scalar<SrcType>(&slot, value);
+		else
+			slot = &value;
+		return xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(output, &slot, xnode_type_code<SrcType>::value);
+	}
+
+	/// reads directly stored value
+	template <typename T>
+	bool read_value(T &output) const
+	{
+		if (is_double())
+			return cast_scalar<double>(output, as_double());
+
+		if (is_null())
+		{
+			void *slot = nullptr;
+			return xnode_caster<T, typename value_policy::cast_policy>::cast_to_value(output, &slot, xnode_type_code<xnode_null_value>::value);
+		}
+
+		int code = get_type_code();
+		if (xnode_compact_codec<T>::is_direct && (code == xnode_type_code<T>::value))
+		{
+			output = xnode_compact_codec<T>::decode(payload());
+			return true;
+		}
+
+		switch (code)
+		{
+		case xnode_type_code<bool>::value:
+			return cast_scalar<bool>(output, xnode_compact_codec<bool>::decode(payload()));
+		case xnode_type_code<float>::value:
+			return cast_scalar<float>(output, xnode_compact_codec<float>::decode(payload()));
+		case xnode_type_code<char>::value:
+			return cast_scalar<char>(output, xnode_compact_codec<char>::decode(payload()));
+		case xnode_type_code<short>::value:
+			return cast_scalar<short>(output, xnode_compact_codec<short>::decode(payload()));
+		case xnode_type_code<int>::value:
+			return cast_scalar<int>(output, xnode_compact_codec<int>::decode(payload()));
+		case xnode_type_code<long>::value:
+			return cast_scalar<long>(output, xnode_compact_codec<long>::decode(payload()));
+		case xnode_type_code<long long>::value:
+			return cast_scalar<long long>(output, xnode_compact_codec<long long>::decode(payload()));
+		case xnode_type_code<unsigned char>::value:
+			return cast_scalar<unsigned char>(output, xnode_compact_codec<unsigned char>::decode(payload()));
+		case xnode_type_code<unsigned short>::value:
+			return cast_scalar<unsigned short>(output, xnode_compact_codec<unsigned short>::decode(payload()));
+		case xnode_type_code<unsigned int>::value:
+			return cast_scalar<unsigned int>(output, xnode_compact_codec<unsigned int>::decode(payload()));
+		case xnode_type_code<unsigned long>::value:
+			return cast_scalar<unsigned long>(output, xnode_compact_codec<unsigned long>::decode(payload()));
+		case xnode_type_code<unsigned long long>::value:
+			return cast_scalar<unsigned long long>(output, xnode_compact_codec<unsigned long long>::decode(payload()));
+		default:
+			return false;
+		}
+	}
+
+	template <typename T>
+	void throwWrongCastToValue() const
+	{
+		XNODE_STATS(count_error(xseWrongCast));
+		throw std::runtime_error(std::string("Conversion to value failed, storage type: [ code: ") + to_string(get_type_code()) + ", name: " + type().name() + " ], value type name: " + typeid(T).name());
+	}
+
+private:
+	uint64_t bits_;
+};
+
+typedef basic_compact_xnode<> xnode_compact;
+
+#endif
@@ -23,6 +23,26 @@ struct xnode_ld_cast_policy {
 
 };
 
+// Conversion tables for long double policy cover codes up to long double
+template<>
+struct xnode_cast_policy_type_codes<xnode_ld_cast_policy> {
+    enum {
+        null_code = xnode_cast_policy_silent_cast<false>::null_code,
+        def_code = 0,
+        max_code = xnode_type_code<long double>::value
+    };
+};
+
+// Own rows of policy: double & long double, other types have no casting defined
+template<>
+struct xnode_cast_policy_types<xnode_ld_cast_policy> {
+    typedef xnode_type_list<
+        void, void, void, void,
+        double,
+        void, void, void, void, void, void, void, void, void, void, void, void, void,
+        long double> type;
+};
+
 typedef xnode_def_cast_policy xnode_ld_value_policy_base;
 
 struct xnode_ld_value_policy : xnode_ld_value_policy_base {
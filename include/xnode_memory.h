@@ -0,0 +1,359 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_memory.h
+// Purpose:     Memory resources & allocators for xnode values and containers.
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XNODE_MEMORY_H__
+#define __XNODE_MEMORY_H__
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include "xnode_type_ext.h"
+
+#if (__cplusplus >= 201703L) && !defined(XNODE_NO_STD_PMR) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define XNODE_HAS_STD_PMR 1
+#endif
+#endif
+
+/// \file xnode_memory.h
+/// Memory resources & allocators for xnode values and containers.
+///
+/// With C++17, xnode_memory_resource is std::pmr::memory_resource, so any standard resource can be used.
+/// For C++11 a compatible class with the same interface is provided.
+///
+/// Resource used by default is selected per thread and can be changed for a scope:
+///
+///     xnode_monotonic_buffer_resource arena;
+///     {
+///         xnode_memory_scope scope(&arena);
+///         xnode_pmr doc = xnode_pmr::value_of(xobject_pmr());
+///         ...
+///     } // all values have to be destroyed before arena
+
+#ifdef XNODE_HAS_STD_PMR
+
+typedef std::pmr::memory_resource xnode_memory_resource;
+typedef std::pmr::monotonic_buffer_resource xnode_monotonic_buffer_resource;
+
+inline xnode_memory_resource *xnode_new_delete_resource()
+{
+	return std::pmr::new_delete_resource();
+}
+
+#else
+
+/// abstract memory resource, interface compatible with std::pmr::memory_resource
+class xnode_memory_resource
+{
+public:
+	virtual ~xnode_memory_resource() {}
+
+	void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+	{
+		return do_allocate(bytes, alignment);
+	}
+
+	void deallocate(void *ptr, size_t bytes, size_t alignment = alignof(std::max_align_t))
+	{
+		do_deallocate(ptr, bytes, alignment);
+	}
+
+	bool is_equal(const xnode_memory_resource &other) const noexcept
+	{
+		return do_is_equal(other);
+	}
+
+protected:
+	virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+	virtual void do_deallocate(void *ptr, size_t bytes, size_t alignment) = 0;
+	virtual bool do_is_equal(const xnode_memory_resource &other) const noexcept = 0;
+};
+
+inline bool operator==(const xnode_memory_resource &lhs, const xnode_memory_resource &rhs)
+{
+	return (&lhs == &rhs) || lhs.is_equal(rhs);
+}
+
+inline bool operator!=(const xnode_memory_resource &lhs, const xnode_memory_resource &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/// resource using global operator new & delete
+class xnode_new_delete_resource_type : public xnode_memory_resource
+{
+protected:
+	virtual void *do_allocate(size_t bytes, size_t /* alignment */)
+	{
+		return ::operator new(bytes);
+	}
+
+	virtual void do_deallocate(void *ptr, size_t /* bytes */, size_t /* alignment */)
+	{
+		::operator delete(ptr);
+	}
+
+	virtual bool do_is_equal(const xnode_memory_resource &other) const noexcept
+	{
+		return this == &other;
+	}
+};
+
+inline xnode_memory_resource *xnode_new_delete_resource()
+{
+	static xnode_new_delete_resource_type resource;
+	return &resource;
+}
+
+/// arena resource: memory is taken from growing chunks, deallocation is a no-op,
+/// everything is released at once by release() or destructor
+class xnode_monotonic_buffer_resource : public xnode_memory_resource
+{
+public:
+	xnode_monotonic_buffer_resource()
+		: upstream_(xnode_new_delete_resource()), next_size_(1024), current_(nullptr), left_(0)
+	{
+	}
+
+	explicit xnode_monotonic_buffer_resource(size_t initial_size)
+		: upstream_(xnode_new_delete_resource()), next_size_(initial_size ? initial_size : 1), current_(nullptr), left_(0)
+	{
+	}
+
+	xnode_monotonic_buffer_resource(void *buffer, size_t buffer_size)
+		: upstream_(xnode_new_delete_resource()), next_size_(buffer_size ? buffer_size * 2 : 1024),
+		  current_(static_cast<char *>(buffer)), left_(buffer_size)
+	{
+	}
+
+	~xnode_monotonic_buffer_resource()
+	{
+		release();
+	}
+
+	/// returns all allocated memory to upstream resource
+	void release()
+	{
+		for (size_t i = 0; i < chunks_.size(); ++i)
+			upstream_->deallocate(chunks_[i].first, chunks_[i].second);
+		chunks_.clear();
+		current_ = nullptr;
+		left_ = 0;
+	}
+
+	xnode_memory_resource *upstream_resource() const
+	{
+		return upstream_;
+	}
+
+protected:
+	virtual void *do_allocate(size_t bytes, size_t alignment)
+	{
+		size_t padding = align_padding(current_, alignment);
+		if (!current_ || (padding + bytes > left_))
+		{
+			size_t size = (std::max)(next_size_, bytes + alignment);
+			current_ = static_cast<char *>(upstream_->allocate(size));
+			chunks_.push_back(std::make_pair(static_cast<void *>(current_), size));
+			left_ = size;
+			next_size_ = size * 2;
+			padding = align_padding(current_, alignment);
+		}
+
+		char *result = current_ + padding;
+		current_ = result + bytes;
+		left_ -= padding + bytes;
+		return result;
+	}
+
+	virtual void do_deallocate(void * /* ptr */, size_t /* bytes */, size_t /* alignment */)
+	{
+		// released with whole arena
+	}
+
+	virtual bool do_is_equal(const xnode_memory_resource &other) const noexcept
+	{
+		return this == &other;
+	}
+
+	static size_t align_padding(const char *ptr, size_t alignment)
+	{
+		size_t misalign = reinterpret_cast<size_t>(ptr) & (alignment - 1);
+		return misalign ? alignment - misalign : 0;
+	}
+
+private:
+	xnode_monotonic_buffer_resource(const xnode_monotonic_buffer_resource &);
+	xnode_monotonic_buffer_resource &operator=(const xnode_monotonic_buffer_resource &);
+
+	xnode_memory_resource *upstream_;
+	size_t next_size_;
+	char *current_;
+	size_t left_;
+	std::vector<std::pair<void *, size_t> > chunks_;
+};
+
+#endif
+
+/// returns storage for current thread's default resource
+inline xnode_memory_resource *&xnode_default_resource_ref()
+{
+	static thread_local xnode_memory_resource *resource = nullptr;
+	return resource;
+}
+
+/// returns resource used by default in current thread
+inline xnode_memory_resource *xnode_get_default_resource()
+{
+	xnode_memory_resource *resource = xnode_default_resource_ref();
+	return resource ? resource : xnode_new_delete_resource();
+}
+
+/// sets resource used by default in current thread, returns previous one
+inline xnode_memory_resource *xnode_set_default_resource(xnode_memory_resource *resource)
+{
+	xnode_memory_resource *prev = xnode_get_default_resource();
+	xnode_default_resource_ref() = resource;
+	return prev;
+}
+
+/// sets default resource of current thread for a lifetime of scope object
+class xnode_memory_scope
+{
+public:
+	explicit xnode_memory_scope(xnode_memory_resource *resource)
+		: prev_(xnode_set_default_resource(resource))
+	{
+	}
+
+	~xnode_memory_scope()
+	{
+		xnode_set_default_resource(prev_);
+	}
+
+private:
+	xnode_memory_scope(const xnode_memory_scope &);
+	xnode_memory_scope &operator=(const xnode_memory_scope &);
+
+	xnode_memory_resource *prev_;
+};
+
+/// allocator for containers, forwards requests to memory resource selected at construction
+/// default constructed allocator uses current default resource
+template <typename T>
+class xnode_polymorphic_allocator
+{
+public:
+	typedef T value_type;
+
+	xnode_polymorphic_allocator() : resource_(xnode_get_default_resource())
+	{
+	}
+
+	xnode_polymorphic_allocator(xnode_memory_resource *resource) : resource_(resource)
+	{
+	}
+
+	template <typename U>
+	xnode_polymorphic_allocator(const xnode_polymorphic_allocator<U> &other) : resource_(other.resource())
+	{
+	}
+
+	T *allocate(size_t n)
+	{
+		return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *ptr, size_t n)
+	{
+		resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+	}
+
+	/// copy of container uses current default resource, not the source one
+	xnode_polymorphic_allocator select_on_container_copy_construction() const
+	{
+		return xnode_polymorphic_allocator();
+	}
+
+	xnode_memory_resource *resource() const
+	{
+		return resource_;
+	}
+
+private:
+	xnode_memory_resource *resource_;
+};
+
+template <typename T, typename U>
+bool operator==(const xnode_polymorphic_allocator<T> &lhs, const xnode_polymorphic_allocator<U> &rhs)
+{
+	return *lhs.resource() == *rhs.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const xnode_polymorphic_allocator<T> &lhs, const xnode_polymorphic_allocator<U> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/// header of value block allocated from memory resource, keeps resource for deallocation
+struct xnode_block_header
+{
+	xnode_memory_resource *resource_;
+};
+
+/// value with header, allocated from memory resource
+template <typename T>
+struct xnode_allocated_block
+{
+	static const size_t alignment = (alignof(T) > alignof(xnode_block_header)) ? alignof(T) : alignof(xnode_block_header);
+	static const size_t offset = ((sizeof(xnode_block_header) + alignof(T) - 1) / alignof(T)) * alignof(T);
+	static const size_t size = offset + sizeof(T);
+
+	template <typename... Args>
+	static T *create(xnode_memory_resource *resource, Args &&...args)
+	{
+		char *mem = static_cast<char *>(resource->allocate(size, alignment));
+		try
+		{
+			T *result = new (static_cast<void *>(mem + offset)) T(std::forward<Args>(args)...);
+			new (static_cast<void *>(mem)) xnode_block_header();
+			reinterpret_cast<xnode_block_header *>(mem)->resource_ = resource;
+			XNODE_STATS(count_alloc(xnode_type_code<T>::value));
+			return result;
+		}
+		catch (...)
+		{
+			resource->deallocate(mem, size, alignment);
+			throw;
+		}
+	}
+
+	static void destroy(T *value)
+	{
+		XNODE_STATS(count_free(xnode_type_code<T>::value));
+		char *mem = reinterpret_cast<char *>(value) - offset;
+		xnode_memory_resource *resource = reinterpret_cast<xnode_block_header *>(mem)->resource_;
+		value->~T();
+		resource->deallocate(mem, size, alignment);
+	}
+};
+
+/// value policy allocating values from current default memory resource
+struct xnode_pmr_value_policy : xnode_def_value_policy
+{
+	static xnode_memory_resource *memory_resource()
+	{
+		return xnode_get_default_resource();
+	}
+};
+
+#endif
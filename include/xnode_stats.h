@@ -0,0 +1,288 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_stats.h
+// Purpose:     Optional counters of value allocations, conversions & errors
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef __XNODE_STATS_H__
+#define __XNODE_STATS_H__
+
+#include <cstddef>
+#include <cstring>
+
+/// \file xnode_stats.h
+/// Optional instrumentation of xnode internals, compiled in when XNODE_ENABLE_STATS is defined
+/// (consistently for all translation units of a program).
+///
+/// Counters are kept per thread without synchronization, xnode_stats_collect() returns sum for all threads,
+/// including threads which already finished:
+///
+///     xnode_stats_snapshot stats = xnode_stats_collect();
+///     stats.conversions[xnode_type_code<std::string>::value][xnode_type_code<int>::value];
+///
+/// Without XNODE_ENABLE_STATS hooks expand to nothing and snapshot is always empty.
+
+/// number of type codes counted separately, higher codes (and custom types) are counted in the last slot
+enum { xnode_stats_type_codes = 32 };
+
+/// exceptions counted by instrumentation
+enum xnode_stats_error {
+	xseWrongCast,    // conversion to / from value failed (throwWrongCastToValue, throwWrongCastFromValue)
+	xseRefReadFail,  // reference to value of different type requested (throwRefReadFail)
+	xseOutOfRange,   // numeric value does not fit in target type (ranged_cast)
+	xseCount
+};
+
+/// sum of counters, indexed by type code
+struct xnode_stats_snapshot {
+	typedef unsigned long long counter_type;
+
+	counter_type allocs[xnode_stats_type_codes];  // owned values created (or taken over with hold)
+	counter_type frees[xnode_stats_type_codes];   // owned values destroyed (or released)
+	counter_type conversions[xnode_stats_type_codes][xnode_stats_type_codes];          // [source][destination]
+	counter_type conversion_failures[xnode_stats_type_codes][xnode_stats_type_codes];  // [source][destination]
+	counter_type errors[xseCount];
+	counter_type copies;        // values copied from node to node
+	counter_type copied_bytes;  // sum of sizeof() of copied values
+
+	xnode_stats_snapshot() {
+		clear();
+	}
+
+	void clear() {
+		std::memset(static_cast<void *>(this), 0, sizeof(*this));
+	}
+
+	xnode_stats_snapshot &operator+=(const xnode_stats_snapshot &rhs) {
+		for (size_t i = 0; i < xnode_stats_type_codes; ++i) {
+			allocs[i] += rhs.allocs[i];
+			frees[i] += rhs.frees[i];
+			for (size_t j = 0; j < xnode_stats_type_codes; ++j) {
+				conversions[i][j] += rhs.conversions[i][j];
+				conversion_failures[i][j] += rhs.conversion_failures[i][j];
+			}
+		}
+		for (size_t i = 0; i < xseCount; ++i)
+			errors[i] += rhs.errors[i];
+		copies += rhs.copies;
+		copied_bytes += rhs.copied_bytes;
+		return *this;
+	}
+
+	counter_type total_allocs() const {
+		return sum(allocs);
+	}
+
+	counter_type total_frees() const {
+		return sum(frees);
+	}
+
+	counter_type total_conversions() const {
+		counter_type result = 0;
+		for (size_t i = 0; i < xnode_stats_type_codes; ++i)
+			result += sum(conversions[i]);
+		return result;
+	}
+
+	counter_type total_conversion_failures() const {
+		counter_type result = 0;
+		for (size_t i = 0; i < xnode_stats_type_codes; ++i)
+			result += sum(conversion_failures[i]);
+		return result;
+	}
+
+	/// slot used for a given type code
+	static size_t slot(int typeCode) {
+		unsigned int code = static_cast<unsigned int>(typeCode);
+		return (code < xnode_stats_type_codes) ? code : xnode_stats_type_codes - 1;
+	}
+
+private:
+	static counter_type sum(const counter_type (&values)[xnode_stats_type_codes]) {
+		counter_type result = 0;
+		for (size_t i = 0; i < xnode_stats_type_codes; ++i)
+			result += values[i];
+		return result;
+	}
+};
+
+#ifdef XNODE_ENABLE_STATS
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+/// counters of a single thread, modified only by owning thread,
+/// atomics are used so that other threads can read them while collecting
+class xnode_stats_block {
+public:
+	xnode_stats_block();
+	~xnode_stats_block();
+
+	void count_alloc(int typeCode) {
+		increment(allocs_[xnode_stats_snapshot::slot(typeCode)]);
+	}
+
+	void count_free(int typeCode) {
+		increment(frees_[xnode_stats_snapshot::slot(typeCode)]);
+	}
+
+	void count_conversion(int srcTypeCode, int destTypeCode, bool success) {
+		size_t src = xnode_stats_snapshot::slot(srcTypeCode);
+		size_t dest = xnode_stats_snapshot::slot(destTypeCode);
+		increment(conversions_[src][dest]);
+		if (!success)
+			increment(conversion_failures_[src][dest]);
+	}
+
+	void count_error(xnode_stats_error error) {
+		increment(errors_[error]);
+	}
+
+	void count_copy(size_t bytes) {
+		increment(copies_);
+		increment(copied_bytes_, bytes);
+	}
+
+	/// adds counters to output
+	void read(xnode_stats_snapshot &output) const {
+		for (size_t i = 0; i < xnode_stats_type_codes; ++i) {
+			output.allocs[i] += allocs_[i].load(std::memory_order_relaxed);
+			output.frees[i] += frees_[i].load(std::memory_order_relaxed);
+			for (size_t j = 0; j < xnode_stats_type_codes; ++j) {
+				output.conversions[i][j] += conversions_[i][j].load(std::memory_order_relaxed);
+				output.conversion_failures[i][j] += conversion_failures_[i][j].load(std::memory_order_relaxed);
+			}
+		}
+		for (size_t i = 0; i < xseCount; ++i)
+			output.errors[i] += errors_[i].load(std::memory_order_relaxed);
+		output.copies += copies_.load(std::memory_order_relaxed);
+		output.copied_bytes += copied_bytes_.load(std::memory_order_relaxed);
+	}
+
+	void clear() {
+		for (size_t i = 0; i < xnode_stats_type_codes; ++i) {
+			allocs_[i].store(0, std::memory_order_relaxed);
+			frees_[i].store(0, std::memory_order_relaxed);
+			for (size_t j = 0; j < xnode_stats_type_codes; ++j) {
+				conversions_[i][j].store(0, std::memory_order_relaxed);
+				conversion_failures_[i][j].store(0, std::memory_order_relaxed);
+			}
+		}
+		for (size_t i = 0; i < xseCount; ++i)
+			errors_[i].store(0, std::memory_order_relaxed);
+		copies_.store(0, std::memory_order_relaxed);
+		copied_bytes_.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	typedef std::atomic<unsigned long long> counter_type;
+
+	// single writer, so read-modify-write is not needed
+	static void increment(counter_type &counter, unsigned long long value = 1) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	xnode_stats_block(const xnode_stats_block &);
+	xnode_stats_block &operator=(const xnode_stats_block &);
+
+	counter_type allocs_[xnode_stats_type_codes];
+	counter_type frees_[xnode_stats_type_codes];
+	counter_type conversions_[xnode_stats_type_codes][xnode_stats_type_codes];
+	counter_type conversion_failures_[xnode_stats_type_codes][xnode_stats_type_codes];
+	counter_type errors_[xseCount];
+	counter_type copies_;
+	counter_type copied_bytes_;
+};
+
+/// list of counter blocks of running threads, counters of finished threads are kept in a snapshot
+class xnode_stats_registry {
+public:
+	static xnode_stats_registry &instance() {
+		static xnode_stats_registry registry;
+		return registry;
+	}
+
+	void add(const xnode_stats_block *block) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		blocks_.push_back(block);
+	}
+
+	void remove(const xnode_stats_block *block) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		block->read(finished_);
+		blocks_.erase(std::remove(blocks_.begin(), blocks_.end(), block), blocks_.end());
+	}
+
+	xnode_stats_snapshot collect() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		xnode_stats_snapshot result = finished_;
+		for (size_t i = 0; i < blocks_.size(); ++i)
+			blocks_[i]->read(result);
+		return result;
+	}
+
+	/// increments made by other threads while reset is running can be lost
+	void reset() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		finished_.clear();
+		for (size_t i = 0; i < blocks_.size(); ++i)
+			const_cast<xnode_stats_block *>(blocks_[i])->clear();
+	}
+
+private:
+	std::mutex mutex_;
+	std::vector<const xnode_stats_block *> blocks_;
+	xnode_stats_snapshot finished_;
+};
+
+inline xnode_stats_block::xnode_stats_block() {
+	clear();
+	xnode_stats_registry::instance().add(this);
+}
+
+/// true after counters of current thread are destroyed at thread exit, values freed later
+/// (e.g. by destructors of static nodes) are not counted; plain flag has no destructor, so it is valid till the end
+inline bool &xnode_stats_local_destroyed() {
+	static thread_local bool destroyed = false;
+	return destroyed;
+}
+
+inline xnode_stats_block::~xnode_stats_block() {
+	xnode_stats_local_destroyed() = true;
+	xnode_stats_registry::instance().remove(this);
+}
+
+/// counters of current thread
+inline xnode_stats_block &xnode_stats_local() {
+	static thread_local xnode_stats_block block;
+	return block;
+}
+
+inline xnode_stats_snapshot xnode_stats_collect() {
+	return xnode_stats_registry::instance().collect();
+}
+
+inline void xnode_stats_reset() {
+	xnode_stats_registry::instance().reset();
+}
+
+#define XNODE_STATS(call) (xnode_stats_local_destroyed() ? (void)0 : xnode_stats_local().call)
+
+#else
+
+inline xnode_stats_snapshot xnode_stats_collect() {
+	return xnode_stats_snapshot();
+}
+
+inline void xnode_stats_reset() {
+}
+
+#define XNODE_STATS(call) ((void)0)
+
+#endif // XNODE_ENABLE_STATS
+
+#endif
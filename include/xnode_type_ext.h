@@ -9,7 +9,10 @@
 #ifndef __XNODE_TYPEE_EXT_H__
 #define __XNODE_TYPEE_EXT_H__
 #include <string>
+#include <cstddef>
+#include <type_traits>
 #include "xnode_utils.h"
+#include "xnode_stats.h"
 
 /// \file xnode_type_ext.h
 /// utility base classes & definitions required for type extensions
@@ -18,6 +21,47 @@ struct xnode_def_cast_policy {
 
 struct xnode_def_value_policy {
 	typedef xnode_def_cast_policy cast_policy; // caster selection policy
+	enum { inline_capacity = 0 }; // max size of owned value stored inside node, 0 = always allocate
+};
+
+/// value policy storing owned values up to Capacity bytes inside node (if nothrow-movable)
+template<size_t Capacity>
+struct xnode_inline_value_policy : xnode_def_value_policy {
+	enum { inline_capacity = Capacity };
+};
+
+/// value policy sharing owned values between node copies, value is copied on first mutable access
+struct xnode_cow_value_policy : xnode_def_value_policy {
+	enum { shared_values = 1 };
+};
+
+namespace XN_CHECK_POLICY
+{
+	template <typename T, typename = void>
+	struct inlineCapacity : std::integral_constant<size_t, 0> {};
+
+	template <typename T>
+	struct inlineCapacity<T, decltype(void(T::inline_capacity))> : std::integral_constant<size_t, T::inline_capacity> {};
+
+	template <typename T, typename = void>
+	struct memoryResource : std::false_type {};
+
+	template <typename T>
+	struct memoryResource<T, decltype(void(T::memory_resource()))> : std::true_type {};
+
+	template <typename T, typename = void>
+	struct sharedValues : std::false_type {};
+
+	template <typename T>
+	struct sharedValues<T, decltype(void(T::shared_values))> : std::integral_constant<bool, T::shared_values != 0> {};
+}
+
+/// value policy properties, with defaults for optional policy members
+template<typename ValuePolicy>
+struct xnode_value_policy_traits {
+	static const size_t inline_capacity = XN_CHECK_POLICY::inlineCapacity<ValuePolicy>::value;
+	static const bool has_memory_resource = XN_CHECK_POLICY::memoryResource<ValuePolicy>::value; // owned values allocated from ValuePolicy::memory_resource()
+	static const bool shared_values = XN_CHECK_POLICY::sharedValues<ValuePolicy>::value; // owned values are refcounted & copied on write
 };
 
 template<bool selector>
@@ -69,5 +113,205 @@ public:
 	}
 };
 
+// ----------------------------------------------------------------
+// -- Conversion tables
+// ----------------------------------------------------------------
+
+template<int... Codes>
+struct xnode_code_list {};
+
+/// generates list of Count type codes starting from First
+template<int First, int Count, int... Codes>
+struct xnode_make_code_list : xnode_make_code_list<First, Count - 1, First + Count - 1, Codes...> {};
+
+template<int First, int... Codes>
+struct xnode_make_code_list<First, 0, Codes...> {
+	typedef xnode_code_list<Codes...> type;
+};
+
+template<typename... Types>
+struct xnode_type_list {};
+
+/// types with conversions defined by cast policy, ordered by type code starting from first_code,
+/// void is used for codes which have no casting row
+template<typename CastPolicy>
+struct xnode_cast_policy_types {
+	typedef xnode_type_list<> type;
+};
+
+/// range of type codes covered by conversion tables of a given cast policy
+template<typename CastPolicy>
+struct xnode_cast_table_range {
+	enum {
+		first_code = (xnode_cast_policy_type_codes<CastPolicy>::null_code < 0) ? xnode_cast_policy_type_codes<CastPolicy>::null_code : 0,
+		size = xnode_cast_policy_type_codes<CastPolicy>::max_code - first_code + 1
+	};
+};
+
+typedef bool (*xnode_cast_to_value_func)(void *, void **);
+typedef bool (*xnode_cast_from_value_func)(void **, const void *);
+
+/// single conversion with fixed type codes, caster switch is resolved at compile time
+template<typename ValueType, typename CastPolicy>
+struct xnode_cast_cell {
+	template<int SrcTypeCode>
+	static bool to_value(void *output, void **storage) {
+		return xnode_caster<ValueType, CastPolicy>::cast_to_value(*static_cast<ValueType *>(output), storage, SrcTypeCode);
+	}
+
+	template<int DestTypeCode>
+	static bool from_value(void **storage, const void *value) {
+		return xnode_caster<ValueType, CastPolicy>::cast_from_value(storage, DestTypeCode, *static_cast<const ValueType *>(value));
+	}
+};
+
+template<typename ValueType, typename CastPolicy, typename CodeList>
+struct xnode_cast_cells;
+
+template<typename ValueType, typename CastPolicy, int... Codes>
+struct xnode_cast_cells<ValueType, CastPolicy, xnode_code_list<Codes...> > {
+	static const xnode_cast_to_value_func to_value[sizeof...(Codes)];
+	static const xnode_cast_from_value_func from_value[sizeof...(Codes)];
+};
+
+template<typename ValueType, typename CastPolicy, int... Codes>
+const xnode_cast_to_value_func xnode_cast_cells<ValueType, CastPolicy, xnode_code_list<Codes...> >::to_value[sizeof...(Codes)] = {
+	&xnode_cast_cell<ValueType, CastPolicy>::template to_value<Codes>...
+};
+
+template<typename ValueType, typename CastPolicy, int... Codes>
+const xnode_cast_from_value_func xnode_cast_cells<ValueType, CastPolicy, xnode_code_list<Codes...> >::from_value[sizeof...(Codes)] = {
+	&xnode_cast_cell<ValueType, CastPolicy>::template from_value<Codes>...
+};
+
+/// conversion table row for a given value type: one function per type code of other side,
+/// codes outside of policy range are handled by caster directly
+template<typename ValueType, typename CastPolicy>
+struct xnode_cast_row {
+	typedef xnode_cast_table_range<CastPolicy> range;
+	typedef xnode_cast_cells<ValueType, CastPolicy, typename xnode_make_code_list<range::first_code, range::size>::type> cells;
+
+	static constexpr const xnode_cast_to_value_func *to_value_row() {
+		return cells::to_value;
+	}
+
+	static constexpr const xnode_cast_from_value_func *from_value_row() {
+		return cells::from_value;
+	}
+
+#ifdef XNODE_ENABLE_STATS
+	// conversion which throws is counted as failed
+	static bool cast_to_value(ValueType &output, void **storage, int srcTypeCode) {
+		bool result = false;
+		try {
+			result = dispatch_to_value(output, storage, srcTypeCode);
+		}
+		catch (...) {
+			XNODE_STATS(count_conversion(srcTypeCode, xnode_type_code<ValueType>::value, false));
+			throw;
+		}
+		XNODE_STATS(count_conversion(srcTypeCode, xnode_type_code<ValueType>::value, result));
+		return result;
+	}
+
+	static bool cast_from_value(void **storage, int destTypeCode, const ValueType &value) {
+		bool result = false;
+		try {
+			result = dispatch_from_value(storage, destTypeCode, value);
+		}
+		catch (...) {
+			XNODE_STATS(count_conversion(xnode_type_code<ValueType>::value, destTypeCode, false));
+			throw;
+		}
+		XNODE_STATS(count_conversion(xnode_type_code<ValueType>::value, destTypeCode, result));
+		return result;
+	}
+#else
+	static bool cast_to_value(ValueType &output, void **storage, int srcTypeCode) {
+		return dispatch_to_value(output, storage, srcTypeCode);
+	}
+
+	static bool cast_from_value(void **storage, int destTypeCode, const ValueType &value) {
+		return dispatch_from_value(storage, destTypeCode, value);
+	}
+#endif
+
+private:
+	static bool dispatch_to_value(ValueType &output, void **storage, int srcTypeCode) {
+		unsigned int index = static_cast<unsigned int>(srcTypeCode - range::first_code);
+		if (index < static_cast<unsigned int>(range::size))
+			return cells::to_value[index](&output, storage);
+		return xnode_caster<ValueType, CastPolicy>::cast_to_value(output, storage, srcTypeCode);
+	}
+
+	static bool dispatch_from_value(void **storage, int destTypeCode, const ValueType &value) {
+		unsigned int index = static_cast<unsigned int>(destTypeCode - range::first_code);
+		if (index < static_cast<unsigned int>(range::size))
+			return cells::from_value[index](storage, &value);
+		return xnode_caster<ValueType, CastPolicy>::cast_from_value(storage, destTypeCode, value);
+	}
+};
+
+template<typename CastPolicy>
+struct xnode_cast_row<void, CastPolicy> {
+	static constexpr const xnode_cast_to_value_func *to_value_row() {
+		return nullptr;
+	}
+
+	static constexpr const xnode_cast_from_value_func *from_value_row() {
+		return nullptr;
+	}
+};
+
+template<typename CastPolicy, typename TypeList>
+struct xnode_cast_matrix_rows;
+
+template<typename CastPolicy, typename... Types>
+struct xnode_cast_matrix_rows<CastPolicy, xnode_type_list<Types...> > {
+	static const xnode_cast_to_value_func *const to_value[sizeof...(Types) + 1];
+	static const xnode_cast_from_value_func *const from_value[sizeof...(Types) + 1];
+};
+
+template<typename CastPolicy, typename... Types>
+const xnode_cast_to_value_func *const xnode_cast_matrix_rows<CastPolicy, xnode_type_list<Types...> >::to_value[sizeof...(Types) + 1] = {
+	xnode_cast_row<Types, CastPolicy>::to_value_row()..., nullptr
+};
+
+template<typename CastPolicy, typename... Types>
+const xnode_cast_from_value_func *const xnode_cast_matrix_rows<CastPolicy, xnode_type_list<Types...> >::from_value[sizeof...(Types) + 1] = {
+	xnode_cast_row<Types, CastPolicy>::from_value_row()..., nullptr
+};
+
+/// conversion matrix of cast policy indexed by (destination type code, source type code),
+/// for use when neither type is known at compile time
+template<typename CastPolicy>
+struct xnode_cast_matrix {
+	typedef xnode_cast_table_range<CastPolicy> range;
+	typedef xnode_cast_matrix_rows<CastPolicy, typename xnode_cast_policy_types<CastPolicy>::type> rows;
+
+	/// returns conversion from value stored with srcTypeCode to output of type selected by destTypeCode,
+	/// null if there is no such conversion in table
+	static xnode_cast_to_value_func to_value(int destTypeCode, int srcTypeCode) {
+		const xnode_cast_to_value_func *row = find_row(rows::to_value, destTypeCode);
+		unsigned int src = static_cast<unsigned int>(srcTypeCode - range::first_code);
+		return (row && (src < static_cast<unsigned int>(range::size))) ? row[src] : nullptr;
+	}
+
+	/// returns conversion from input value of type selected by srcTypeCode to storage of value with destTypeCode,
+	/// null if there is no such conversion in table
+	static xnode_cast_from_value_func from_value(int srcTypeCode, int destTypeCode) {
+		const xnode_cast_from_value_func *row = find_row(rows::from_value, srcTypeCode);
+		unsigned int dest = static_cast<unsigned int>(destTypeCode - range::first_code);
+		return (row && (dest < static_cast<unsigned int>(range::size))) ? row[dest] : nullptr;
+	}
+
+protected:
+	template<typename Row, size_t Size>
+	static Row find_row(Row const (&table)[Size], int typeCode) {
+		unsigned int index = static_cast<unsigned int>(typeCode - range::first_code);
+		return (index < Size - 1) ? table[index] : nullptr;
+	}
+};
+
 
 #endif
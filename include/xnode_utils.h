@@ -11,34 +11,474 @@
 
 #include <sstream>
 #include <string>
+#include <limits>
+#include <type_traits>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <cmath>
+#include <clocale>
+
+#if (__cplusplus >= 201703L) && !defined(XNODE_NO_CHARCONV) && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#define XNODE_HAS_CHARCONV 1
+#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+#define XNODE_HAS_CHARCONV_FLOAT 1
+#endif
+#endif
+#endif
+
+// ----------------------------------------------------------------
+// -- Locale-independent number formatting & parsing
+// ----------------------------------------------------------------
+
+/// size of buffer sufficient for any number formatted by xn_format_number
+enum { xn_number_buffer_size = 64 };
+
+/// result of number parsing
+enum xn_number_status {
+	xnsOk,
+	xnsInvalid,    // no number at the beginning of input
+	xnsOutOfRange  // number does not fit in output type
+};
+
+/// checks if number of a given type is handled by xn_format_number / xn_parse_number,
+/// character types, bool & long double are formatted by streams
+template <typename T>
+struct xn_is_fast_number {
+	static const bool value =
+		(std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+		 !std::is_same<T, char>::value && !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+		 !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value) ||
+		std::is_same<T, float>::value || std::is_same<T, double>::value;
+};
+
+namespace XN_NUMBER
+{
+	inline const char *skip_space(const char *first, const char *last)
+	{
+		while (first != last && (*first == ' ' || *first == '\t' || *first == '\n' || *first == '\r' || *first == '\f' || *first == '\v'))
+			++first;
+		return first;
+	}
+
+	template <typename T>
+	bool is_negative(T value, std::true_type /* signed */)
+	{
+		return value < 0;
+	}
+
+	template <typename T>
+	bool is_negative(T /* value */, std::false_type /* signed */)
+	{
+		return false;
+	}
+
+	template <typename T>
+	char *format_integer(char *buffer, T value)
+	{
+#ifdef XNODE_HAS_CHARCONV
+		return std::to_chars(buffer, buffer + xn_number_buffer_size, value).ptr;
+#else
+		typedef typename std::make_unsigned<T>::type unsigned_type;
+		char digits[3 * sizeof(T) + 2];
+		char *pos = digits + sizeof(digits);
+		bool negative = is_negative(value, std::integral_constant<bool, std::is_signed<T>::value>());
+		unsigned_type magnitude = static_cast<unsigned_type>(value);
+		if (negative)
+			magnitude = static_cast<unsigned_type>(0u - magnitude);
+		do
+		{
+			*--pos = static_cast<char>('0' + magnitude % 10);
+			magnitude = static_cast<unsigned_type>(magnitude / 10);
+		} while (magnitude != 0);
+		if (negative)
+			*--pos = '-';
+		size_t len = static_cast<size_t>(digits + sizeof(digits) - pos);
+		std::memcpy(buffer, pos, len);
+		return buffer + len;
+#endif
+	}
+
+	/// parses integer, range of T is checked while digits are accumulated
+	template <typename T>
+	xn_number_status parse_integer(const char *first, const char *last, T &value, const char *&end)
+	{
+		typedef unsigned long long acc_type;
+		const char *pos = first;
+		bool negative = false;
+		if (pos != last && (*pos == '-' || *pos == '+'))
+		{
+			negative = (*pos == '-');
+			++pos;
+		}
+
+		const acc_type limit = negative ?
+			(std::is_signed<T>::value ? static_cast<acc_type>(std::numeric_limits<T>::max()) + 1u : 0u) :
+			static_cast<acc_type>(std::numeric_limits<T>::max());
+
+		const char *digits = pos;
+		acc_type acc = 0;
+		bool overflow = false;
+		for (; pos != last && *pos >= '0' && *pos <= '9'; ++pos)
+		{
+			unsigned int digit = static_cast<unsigned int>(*pos - '0');
+			if (overflow || (digit > limit) || (acc > (limit - digit) / 10))
+				overflow = true;
+			else
+				acc = acc * 10 + digit;
+		}
+
+		if (pos == digits)
+			return xnsInvalid;
+
+		end = pos;
+		if (overflow)
+			return xnsOutOfRange;
+
+		if (negative && acc != 0)
+			value = static_cast<T>(-static_cast<long long>(acc - 1) - 1);
+		else
+			value = static_cast<T>(acc);
+		return xnsOk;
+	}
+
+	inline bool match_word(const char *first, const char *last, const char *word)
+	{
+		for (; *word; ++word, ++first)
+			if (first == last || (*first | 0x20) != *word)
+				return false;
+		return true;
+	}
+
+	template <typename T>
+	T read_float(const char *text, char **end);
+
+	template <>
+	inline float read_float<float>(const char *text, char **end)
+	{
+		return std::strtof(text, end);
+	}
+
+	template <>
+	inline double read_float<double>(const char *text, char **end)
+	{
+		return std::strtod(text, end);
+	}
+
+	/// parses floating point number: [sign] digits [. digits] [e [sign] digits] | inf | infinity | nan
+	template <typename T>
+	xn_number_status parse_float(const char *first, const char *last, T &value, const char *&end)
+	{
+		const char *pos = first;
+		bool negative = false;
+		if (pos != last && (*pos == '-' || *pos == '+'))
+		{
+			negative = (*pos == '-');
+			++pos;
+		}
+
+		if (match_word(pos, last, "inf"))
+		{
+			end = pos + (match_word(pos, last, "infinity") ? 8 : 3);
+			value = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+			return xnsOk;
+		}
+		if (match_word(pos, last, "nan"))
+		{
+			end = pos + 3;
+			value = negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+			return xnsOk;
+		}
+
+#ifdef XNODE_HAS_CHARCONV_FLOAT
+		if (pos != last && (*pos == '-' || *pos == '+'))
+			return xnsInvalid;
+		std::from_chars_result res = std::from_chars(pos, last, value);
+		if (res.ec == std::errc::invalid_argument)
+			return xnsInvalid;
+		end = res.ptr;
+		if (res.ec == std::errc::result_out_of_range)
+			return xnsOutOfRange;
+		if (negative)
+			value = -value;
+		return xnsOk;
+#else
+		// syntax is checked here, so that strtod does not accept hex or locale-specific forms
+		const char *mantissa = pos;
+		size_t digits = 0;
+		while (pos != last && *pos >= '0' && *pos <= '9')
+			++pos, ++digits;
+		const char *point = nullptr;
+		if (pos != last && *pos == '.')
+		{
+			point = pos++;
+			while (pos != last && *pos >= '0' && *pos <= '9')
+				++pos, ++digits;
+		}
+		if (digits == 0)
+			return xnsInvalid;
+		if (pos != last && (*pos == 'e' || *pos == 'E'))
+		{
+			const char *exp = pos + 1;
+			if (exp != last && (*exp == '-' || *exp == '+'))
+				++exp;
+			if (exp != last && *exp >= '0' && *exp <= '9')
+			{
+				pos = exp;
+				while (pos != last && *pos >= '0' && *pos <= '9')
+					++pos;
+			}
+		}
+		end = pos;
+
+		size_t len = static_cast<size_t>(pos - mantissa);
+		char local[128];
+		std::string heap;
+		char *text = local;
+		if (len >= sizeof(local))
+		{
+			heap.resize(len + 1);
+			text = &heap[0];
+		}
+		std::memcpy(text, mantissa, len);
+		text[len] = '\0';
+		if (point)
+			text[point - mantissa] = *std::localeconv()->decimal_point;
+
+		errno = 0;
+		char *parsed;
+		T result = read_float<T>(text, &parsed);
+		// ERANGE is also reported for denormalized results, these are accepted
+		if (errno == ERANGE && (std::isinf(result) || result == 0))
+			return xnsOutOfRange;
+		value = negative ? -result : result;
+		return xnsOk;
+#endif
+	}
+
+	template <typename T>
+	char *format_special(char *buffer, T value)
+	{
+		const char *text = std::isnan(value) ? (std::signbit(value) ? "-nan" : "nan") : (value < 0 ? "-inf" : "inf");
+		size_t len = std::strlen(text);
+		std::memcpy(buffer, text, len);
+		return buffer + len;
+	}
+
+	template <typename T>
+	char *format_float(char *buffer, T value)
+	{
+		if (std::isnan(value) || std::isinf(value))
+			return format_special(buffer, value);
+
+#ifdef XNODE_HAS_CHARCONV_FLOAT
+		return std::to_chars(buffer, buffer + xn_number_buffer_size, value).ptr;
+#else
+		// find shortest digits which read back to the same value,
+		// result is formatted as fixed or scientific, whichever is shorter (same as std::to_chars)
+		char *out = buffer;
+		if (std::signbit(value))
+			*out++ = '-';
+		const T magnitude = std::fabs(value);
+		char digits[xn_number_buffer_size];
+		int count;
+		int exponent;
+
+		if (magnitude == std::floor(magnitude) && magnitude < std::ldexp(static_cast<T>(1), std::numeric_limits<T>::digits))
+		{
+			// integral values below 2^digits are represented exactly by their digits
+			count = static_cast<int>(format_integer(digits, static_cast<unsigned long long>(magnitude)) - digits);
+			exponent = count - 1;
+		}
+		else
+		{
+			char sci[xn_number_buffer_size];
+			// rounding to digits10 keeps every shorter representation of normal values
+			int precision = (magnitude < std::numeric_limits<T>::min()) ? 1 : std::numeric_limits<T>::digits10;
+			for (;; ++precision)
+			{
+				std::snprintf(sci, sizeof(sci), "%.*e", precision - 1, static_cast<double>(magnitude));
+				if (precision >= std::numeric_limits<T>::max_digits10)
+					break;
+				char *parsed;
+				if (read_float<T>(sci, &parsed) == magnitude)
+					break;
+			}
+
+			// split "d.ddde+xx" into digits & exponent
+			const char decimal_point = *std::localeconv()->decimal_point;
+			const char *pos = sci;
+			count = 0;
+			for (; *pos != 'e'; ++pos)
+				if (*pos != decimal_point)
+					digits[count++] = *pos;
+			exponent = std::atoi(pos + 1);
+		}
+		while (count > 1 && digits[count - 1] == '0')
+			--count;
+
+		// scientific: d[.ddd]e+xx
+		char exp_text[8];
+		int exp_len = std::snprintf(exp_text, sizeof(exp_text), "e%c%02d", exponent < 0 ? '-' : '+', exponent < 0 ? -exponent : exponent);
+		int sci_len = count + (count > 1 ? 1 : 0) + exp_len;
+
+		// fixed: ddd000, ddd.ddd or 0.000ddd
+		int fixed_len = (exponent >= 0) ? ((count > exponent + 1) ? count + 1 : exponent + 1) : (count + 1 - exponent);
+
+		if (fixed_len <= sci_len)
+		{
+			if (exponent >= count)
+			{
+				// integral value, all digits are printed exactly
+				if (magnitude < static_cast<T>(std::numeric_limits<unsigned long long>::max()))
+					out = format_integer(out, static_cast<unsigned long long>(magnitude));
+				else
+					out += std::snprintf(out, xn_number_buffer_size - 1, "%.0f", static_cast<double>(magnitude));
+			}
+			else if (exponent >= 0)
+			{
+				for (int i = 0; i < count; ++i)
+				{
+					if (i == exponent + 1)
+						*out++ = '.';
+					*out++ = digits[i];
+				}
+			}
+			else
+			{
+				*out++ = '0';
+				*out++ = '.';
+				for (int i = 1; i < -exponent; ++i)
+					*out++ = '0';
+				std::memcpy(out, digits, static_cast<size_t>(count));
+				out += count;
+			}
+		}
+		else
+		{
+			*out++ = digits[0];
+			if (count > 1)
+			{
+				*out++ = '.';
+				std::memcpy(out, digits + 1, static_cast<size_t>(count - 1));
+				out += count - 1;
+			}
+			std::memcpy(out, exp_text, static_cast<size_t>(exp_len));
+			out += exp_len;
+		}
+		return out;
+#endif
+	}
+
+	template <typename T>
+	char *format(char *buffer, T value, std::true_type /* integral */)
+	{
+		return format_integer(buffer, value);
+	}
+
+	template <typename T>
+	char *format(char *buffer, T value, std::false_type /* integral */)
+	{
+		return format_float(buffer, value);
+	}
+
+	template <typename T>
+	xn_number_status parse(const char *first, const char *last, T &value, const char *&end, std::true_type /* integral */)
+	{
+		return parse_integer(first, last, value, end);
+	}
+
+	template <typename T>
+	xn_number_status parse(const char *first, const char *last, T &value, const char *&end, std::false_type /* integral */)
+	{
+		return parse_float(first, last, value, end);
+	}
+}
+
+/// writes number to buffer (at least xn_number_buffer_size long) without locale,
+/// floating point values are written in shortest form which reads back to the same value
+/// \result returns end of written text
+template <typename T>
+char *xn_format_number(char *buffer, T value)
+{
+	static_assert(xn_is_fast_number<T>::value, "type not supported");
+	return XN_NUMBER::format(buffer, value, std::integral_constant<bool, std::is_integral<T>::value>());
+}
+
+/// parses number from text without locale, leading whitespace is skipped,
+/// parsing stops at first character which is not part of number
+/// \param[out] end set to first character after parsed number
+template <typename T>
+xn_number_status xn_parse_number(const char *first, const char *last, T &value, const char *&end)
+{
+	static_assert(xn_is_fast_number<T>::value, "type not supported");
+	end = first;
+	return XN_NUMBER::parse(XN_NUMBER::skip_space(first, last), last, value, end, std::integral_constant<bool, std::is_integral<T>::value>());
+}
+
+template <typename T>
+xn_number_status xn_parse_number(const std::string &text, T &value)
+{
+	const char *end;
+	return xn_parse_number(text.data(), text.data() + text.size(), value, end);
+}
+
+namespace XN_NUMBER
+{
+	template <typename T>
+	std::string to_string(const T &arg, std::true_type /* fast */)
+	{
+		char buffer[xn_number_buffer_size];
+		return std::string(buffer, xn_format_number(buffer, arg));
+	}
+
+	template <typename T>
+	std::string to_string(const T &arg, std::false_type /* fast */)
+	{
+		std::ostringstream out;
+		out << arg;
+		return(out.str());
+	}
+
+	template <typename T>
+	bool from_string(T &output, const std::string &str, std::true_type /* fast */)
+	{
+		return xn_parse_number(str, output) == xnsOk;
+	}
+
+	template <typename T>
+	bool from_string(T &output, const std::string &str, std::false_type /* fast */)
+	{
+		std::istringstream is(str);
+		return !(!(is >> output));
+	}
+}
 
 template < class T >
 std::string to_string(const T &arg)
 {
-	std::ostringstream out;
-	out << arg;
-	return(out.str());
+	return XN_NUMBER::to_string(arg, std::integral_constant<bool, xn_is_fast_number<T>::value>());
 }
 
 template <typename T>
-T from_string(const std::string &str) {
-	std::istringstream is(str);
-	T t;
-	is >> t;
-	return t;
+bool from_string(T &output, const std::string &str) {
+	return XN_NUMBER::from_string(output, str, std::integral_constant<bool, xn_is_fast_number<T>::value>());
 }
 
 template <typename T>
-bool from_string(T &output, const std::string &str) {
-	std::istringstream is(str);
-    return !(!(is >> output));
+T from_string(const std::string &str) {
+	T t = T();
+	from_string(t, str);
+	return t;
 }
 
 template <typename T>
 T from_string_def(const std::string &str, const T &defValue) {
-	std::istringstream is(str);
 	T res;
-	if (!(is >> res))
+	if (!from_string(res, str))
 		res = defValue;
 	return res;
 }
@@ -2,9 +2,43 @@
 #define XOBJECT_H
 
 #include "details/property_list.h"
+#include "details/property_list_concurrent.h"
 #include "xnode.h"
+#include "xkey.h"
 
-typedef property_list<std::string, xnode> xobject;
+/// number of fields stored inside of xobject, larger objects use flat storage (see property_list_small.h);
+/// up to this size objects need no allocation for fields, above 32 fields inline and flat storage perform alike
+enum { xobject_inline_fields = 8 };
+
+/// object with fields in insertion order, see property_list_small.h and property_list_flat.h
+typedef property_list<std::string, xnode, std::allocator<xnode>, property_list_small_storage<xobject_inline_fields> > xobject;
+
+/// object of arena-capable nodes, keys & values are allocated from current default memory resource
+typedef property_list<std::string, xnode_pmr, xnode_polymorphic_allocator<xnode_pmr>, property_list_small_storage<xobject_inline_fields> > xobject_pmr;
+
+/// object with interned field names, keys are compared by identity and hash is not calculated on lookup
+typedef property_list<xkey, xnode, std::allocator<xnode>, property_list_small_storage<xobject_inline_fields> > xobject_interned;
+
+/// object with interned field names, allocated from current default memory resource
+typedef property_list<xkey, xnode_pmr, xnode_polymorphic_allocator<xnode_pmr>, property_list_small_storage<xobject_inline_fields> > xobject_interned_pmr;
+
+/// object which shares key list with other objects with the same keys in the same order (see property_list_shape.h),
+/// for large arrays of records
+typedef property_list<std::string, xnode, std::allocator<xnode>, property_list_shape_storage> xobject_shaped;
+
+/// shaped object of arena-capable nodes, values are allocated from current default memory resource
+typedef property_list<std::string, xnode_pmr, xnode_polymorphic_allocator<xnode_pmr>, property_list_shape_storage> xobject_shaped_pmr;
+
+/// read-only object created by freeze() of another object, fields are found with perfect hash
+/// (see property_list_frozen.h), object can be thawed by copying to another object type: xobject obj(frozen)
+typedef property_list<std::string, xnode, std::allocator<xnode>, property_list_frozen_storage> frozen_xobject;
+
+/// read-only object of arena-capable nodes
+typedef property_list<std::string, xnode_pmr, xnode_polymorphic_allocator<xnode_pmr>, property_list_frozen_storage> frozen_xobject_pmr;
+
+/// object which can be read and changed by many threads at once, with lock per group of fields
+/// (see property_list_concurrent.h), ordered access through snapshot()
+typedef concurrent_property_list<std::string, xnode> concurrent_xobject;
 
 // Define a specific type code for long double to distinguish it
 template<>
@@ -12,4 +46,44 @@ struct xnode_type_code<xobject> {
     enum { value = 15 }; // Ensure this doesn't conflict with other type codes
 };
 
+template<>
+struct xnode_type_code<xobject_pmr> {
+    enum { value = 15 };
+};
+
+template<>
+struct xnode_type_code<xobject_interned> {
+    enum { value = 18 };
+};
+
+template<>
+struct xnode_type_code<xobject_interned_pmr> {
+    enum { value = 18 };
+};
+
+template<>
+struct xnode_type_code<xobject_shaped> {
+    enum { value = 19 };
+};
+
+template<>
+struct xnode_type_code<xobject_shaped_pmr> {
+    enum { value = 19 };
+};
+
+template<>
+struct xnode_type_code<frozen_xobject> {
+    enum { value = 20 };
+};
+
+template<>
+struct xnode_type_code<frozen_xobject_pmr> {
+    enum { value = 20 };
+};
+
+template<>
+struct xnode_type_code<concurrent_xobject> {
+    enum { value = 21 };
+};
+
 #endif // XOBJECT_H
\ No newline at end of file
@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------------
+// Name:        concurrent_property_list_test.cpp
+// Purpose:     Unit tests for concurrent_property_list and concurrent_xobject
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xobject.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include "cunit.h"
+
+using namespace std;
+
+typedef concurrent_property_list<string, int> concurrent_list;
+
+void TestConcurrentBasics() {
+    concurrent_list props;
+    Assert(!props.put("one", 1), "new key");
+    Assert(!props.put("two", 2), "new key");
+    Assert(props.put("one", 10), "existing key");
+    props.emplace("three", 3);
+    AssertEquals(3u, static_cast<unsigned>(props.size()), "size");
+    AssertEquals(10, props.get("one"), "get");
+    AssertEquals(-1, props.get_def("four", -1), "get_def of missing key");
+    Assert(props.contains(string("two")) && !props.contains("four"), "contains");
+
+    int value = 0;
+    Assert(props.try_get("three", value) && value == 3, "try_get");
+    Assert(!props.try_get("four", value) && value == 3, "try_get of missing key");
+
+    const concurrent_list::key_handle two_key("two");
+    AssertEquals(2, props.get(two_key), "get by handle");
+
+    try {
+        props.get("four");
+        Assert(false, "missing key should throw");
+    }
+    catch (const std::runtime_error &e) {
+        AssertEquals(string("key not found: four"), string(e.what()), "key text in message");
+    }
+
+    Assert(props.remove("two") && !props.remove("two"), "remove");
+    props.put("two", 22);
+    vector<string> keys = props.get_keys();
+    Assert(keys.size() == 3 && keys[0] == "one" && keys[1] == "three" && keys[2] == "two", "snapshot keeps order of insertion");
+
+    concurrent_list copy(props);
+    Assert(copy == props, "copy");
+    copy.put("one", 1);
+    Assert(!(copy == props) && props.get("one") == 10, "copy is independent");
+    copy = props;
+    Assert(copy == props, "assignment");
+
+    property_list<string, int> items = props.snapshot();
+    concurrent_list restored(items);
+    Assert(restored.snapshot() == items, "list from snapshot");
+
+    props.clear();
+    Assert(props.empty() && !props.contains("one"), "clear");
+}
+
+// readers of the same keys run while writers put & remove other keys
+void TestConcurrentThreads() {
+    const int thread_count = 4;
+    const int key_count = 200;
+    const int rounds = 200;
+    concurrent_list props;
+    for (int i = 0; i < key_count; ++i)
+        props.put("key" + to_string(i), i);
+
+    vector<int> errors(thread_count, 0);
+    vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.push_back(std::thread([&props, &errors, t, key_count, rounds]() {
+            for (int r = 0; r < rounds; ++r) {
+                for (int i = 0; i < key_count; i += 7) {
+                    if (props.get_def("key" + to_string(i), -1) != i)
+                        ++errors[t];
+                }
+                string own = "thread" + to_string(t) + "_" + to_string(r % 10);
+                props.put(own, r);
+                if (props.get(own) != r)
+                    ++errors[t];
+                if (r % 3 == 0)
+                    props.remove(own);
+                if (r % 50 == 0 && props.snapshot().get("key0") != 0)
+                    ++errors[t];
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    for (int t = 0; t < thread_count; ++t)
+        AssertEquals(0, errors[t], "values read by threads");
+    AssertEquals(props.snapshot().size(), props.size(), "size after threads");
+    vector<string> keys = props.get_keys();
+    Assert(keys[0] == "key0" && keys[key_count - 1] == "key" + to_string(key_count - 1), "order of keys after threads");
+}
+
+void TestConcurrentObject() {
+    concurrent_xobject tenants;
+    tenants.put("acme", xnode::value_of(1));
+    tenants.put("initech", xnode::value_of(2));
+
+    xnode value = xnode::value_of(tenants);
+    Assert(value.is<concurrent_xobject>(), "stored in node");
+    AssertEquals(21, value.get_type_code(), "type code");
+    AssertEquals(2, value.get_ref<concurrent_xobject>().get("initech").get_as<int>(), "read from node");
+    AssertEquals(1, value.get_ref<concurrent_xobject>().get_def("acme", xnode()).get_as<int>(), "get_def from node");
+}
+
+int concurrent_property_list_test() {
+    TEST_PROLOG();
+    TEST_FUNC(ConcurrentBasics);
+    TEST_FUNC(ConcurrentThreads);
+    TEST_FUNC(ConcurrentObject);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return concurrent_property_list_test();
+}
@@ -11,6 +11,9 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <type_traits>
 
 #include "cunit.h"
 
@@ -260,7 +263,685 @@ void TestStaticOfMethods() {
     }
 }
 
+// hash storage is the default, other layouts are selected explicitly
+void TestDefaultStoragePolicy() {
+    Assert(std::is_same<property_list<string, int>::storage_policy, property_list_hash_storage>::value,
+           "Hash storage should be the default");
+}
+
+typedef property_list<string, int, std::allocator<int>, property_list_flat_storage> flat_list;
+
+// Test flat storage keeps insertion order after removal and re-insertion
+void TestFlatStorageOrder() {
+    flat_list props;
+    props.put("one", 1);
+    props.put("two", 2);
+    props.put("three", 3);
+    Assert(props.put("two", 22), "Replacing value should report existing key");
+
+    props.remove("one");
+    Assert(!props.needs_reorg(), "Single tombstone should be below compaction threshold");
+    Assert(!props.contains("one"), "Removed key should not be found");
+    Assert(props.size() == 2, "Size should not include tombstones");
+
+    props.put("one", 11);
+    std::vector<string> keys = props.get_keys();
+    Assert(keys.size() == 3, "Should have 3 keys");
+    Assert(keys[0] == "two", "First key should be 'two'");
+    Assert(keys[1] == "three", "Second key should be 'three'");
+    Assert(keys[2] == "one", "Re-inserted key should be last");
+
+    std::vector<int> values = props.get_values();
+    Assert(values[0] == 22 && values[1] == 3 && values[2] == 11, "Values should be in order of keys");
+
+    // const iterators skip tombstones without reorg
+    props.remove("three");
+    Assert(props.needs_reorg(), "Half of entries removed should need compaction");
+    const flat_list &const_props = props;
+    int count = 0;
+    for (auto it = const_props.keys_cbegin(); it != const_props.keys_cend(); ++it)
+        count++;
+    Assert(count == 2, "Const key iterators should skip tombstones");
+    Assert(props.needs_reorg(), "Const iteration should not reorg");
+
+    props.reorg();
+    Assert(!props.needs_reorg(), "Reorg should remove tombstones");
+    Assert(props.get("one") == 11 && props.get("two") == 22 && !props.contains("three"), "Values should survive reorg");
+}
+
+// Test flat storage with enough keys to rebuild index several times
+void TestFlatStorageGrowth() {
+    flat_list props;
+    const int count = 1000;
+    for (int i = 0; i < count; ++i)
+        props.put("key" + to_string(i), i);
+    Assert(props.size() == count, "Should hold all keys");
+
+    for (int i = 0; i < count; i += 2)
+        props.remove("key" + to_string(i));
+    for (int i = 0; i < count; ++i) {
+        int *value = props.get_ptr("key" + to_string(i));
+        Assert((value != nullptr) == (i % 2 == 1), "Only odd keys should be left");
+        Assert(value == nullptr || *value == i, "Value should match key");
+    }
+
+    // tombstones are dropped when block is rebuilt
+    for (int i = count; i < 2 * count; ++i)
+        props.put("key" + to_string(i), i);
+    Assert(props.size() == count + count / 2, "Size after second insert");
+
+    std::vector<int> expected;
+    for (int i = 1; i < count; i += 2)
+        expected.push_back(i);
+    for (int i = count; i < 2 * count; ++i)
+        expected.push_back(i);
+
+    size_t pos = 0;
+    for (auto it = props.values_begin(); it != props.values_end(); ++it, ++pos) {
+        Assert(it->first == "key" + to_string(expected[pos]), "Keys should be in insertion order");
+        Assert(it->second == expected[pos], "Values should be in insertion order");
+    }
+    Assert(pos == expected.size(), "Should iterate over all items");
+
+    props.clear();
+    Assert(props.empty(), "Should be empty after clear");
+    Assert(!props.contains("key1"), "Should not find key after clear");
+    props.put("key1", 1);
+    Assert(props.get("key1") == 1, "Should be usable after clear");
+}
+
+// Test copy, move & equality of flat storage
+void TestFlatStorageCopyMove() {
+    flat_list props = flat_list::of("one", 1, "two", 2, "three", 3);
+    props.remove("two");
+
+    flat_list copy(props);
+    Assert(copy == props, "Copy should be equal");
+    Assert(!copy.needs_reorg(), "Copy should not have tombstones");
+    Assert(copy.get_keys() == props.get_keys(), "Copy should keep order");
+
+    copy.put("two", 2);
+    Assert(!(copy == props), "Lists with different items should differ");
+
+    flat_list reordered = flat_list::of("three", 3, "one", 1);
+    Assert(!(reordered == props), "Lists with different order should differ");
+
+    flat_list moved(std::move(copy));
+    Assert(moved.size() == 3, "Moved list should have all items");
+    Assert(copy.empty(), "Source of move should be empty");
+
+    copy = moved;
+    Assert(copy == moved, "Copy assignment");
+    copy = copy;
+    Assert(copy.size() == 3, "Self assignment");
+    props = std::move(moved);
+    Assert(props.get("two") == 2, "Move assignment");
+}
+
+// Test inserting value which refers to item of the same list while list grows
+void TestFlatStorageSelfReference() {
+    flat_list props;
+    props.put("first", 42);
+    for (int i = 0; i < 100; ++i)
+        props.put("copy" + to_string(i), props.get("first"));
+    for (int i = 0; i < 100; ++i)
+        Assert(props.get("copy" + to_string(i)) == 42, "Value should be copied before rebuild");
+}
+
+// removed entries are skipped by iterators, compacted only above threshold
+void TestFlatStorageTombstones() {
+    flat_list props;
+    for (int i = 0; i < 30; ++i)
+        props.put("key" + to_string(i), i);
+
+    for (int i = 0; i < 30; i += 3)
+        props.remove("key" + to_string(i));
+    Assert(!props.needs_reorg(), "10 tombstones of 30 entries should not need compaction");
+
+    int expected = 1, count = 0;
+    for (auto it = props.keys_begin(); it != props.keys_end(); ++it, ++count) {
+        Assert(*it == "key" + to_string(expected), "Iterator should skip tombstones");
+        expected += (expected % 3 == 2) ? 2 : 1;
+    }
+    Assert(count == 20, "Iterator should visit live entries");
+
+    props.remove("key1");
+    Assert(props.needs_reorg(), "Tombstones above 1/3 of entries should need compaction");
+    auto first = props.keys_begin();
+    std::vector<string> keys(first, props.keys_end());
+    Assert(!props.needs_reorg() && keys.size() == 19 && keys[0] == "key2", "Iteration should compact entries");
+
+    // remove + iterate loop
+    while (!props.empty()) {
+        props.remove(*props.keys_begin());
+        int sum = 0;
+        for (auto it = props.values_begin(); it != props.values_end(); ++it)
+            sum += it->second;
+        Assert(props.get_keys().size() == props.size(), "Keys should match size after each remove");
+        Assert(sum >= 0, "Values should be readable");
+    }
+    props.reorg();
+    Assert(props.get_keys().empty(), "Reorg of empty list");
+}
+
+// keys_end does not compact entries, so keys can be removed in a loop over keys
+void TestFlatStorageRemoveWhileIterating() {
+    flat_list props;
+    for (int i = 0; i < 32; ++i)
+        props.put("key" + to_string(i), i);
+
+    int count = 0;
+    for (auto it = props.keys_begin(); it != props.keys_end(); ++it, ++count) {
+        Assert(*it == "key" + to_string(count), "Should visit keys in order");
+        props.remove(*it);
+    }
+    Assert(count == 32 && props.empty(), "All keys should be removed");
+    Assert(props.needs_reorg(), "Tombstones should stay until keys_begin");
+    auto first = props.keys_begin();
+    Assert(first == props.keys_end() && !props.needs_reorg(), "keys_begin should compact entries");
+}
+
+// key which counts its copies, move can throw if requested by template argument
+template<bool NothrowMove>
+struct counted_key {
+    static int copies;
+
+    explicit counted_key(int value) : value(value) {}
+    counted_key(const counted_key &src) : value(src.value) { ++copies; }
+    counted_key(counted_key &&src) noexcept(NothrowMove) : value(src.value) {}
+    counted_key &operator=(const counted_key &) = default;
+
+    bool operator==(const counted_key &rhs) const {
+        return value == rhs.value;
+    }
+
+    int value;
+};
+
+template<bool NothrowMove>
+int counted_key<NothrowMove>::copies = 0;
+
+namespace std {
+    template<bool NothrowMove>
+    struct hash<counted_key<NothrowMove> > {
+        size_t operator()(const counted_key<NothrowMove> &key) const {
+            return std::hash<int>()(key.value);
+        }
+    };
+}
+
+template<bool NothrowMove>
+void CheckFlatStorageKeyMoves(bool copied) {
+    typedef counted_key<NothrowMove> key_type;
+    property_list<key_type, string, std::allocator<string>, property_list_flat_storage> props;
+    const int count = 200;
+    for (int i = 0; i < count; ++i)
+        props.put(key_type(i), to_string(i));
+    for (int i = 0; i < count; i += 2)
+        props.remove(key_type(i));
+    props.reorg();
+    Assert((key_type::copies != 0) == copied, "Keys should be copied only when move can throw");
+
+    int expected = 1;
+    for (auto it = props.values_begin(); it != props.values_end(); ++it, expected += 2)
+        Assert(it->first.value == expected && it->second == to_string(expected), "Items should survive rebuild");
+    Assert(expected == count + 1, "Should iterate over all items");
+}
+
+// Test that entries are moved to a new block, keys stay const for users of iterators
+void TestFlatStorageKeyMoves() {
+    CheckFlatStorageKeyMoves<true>(false);
+    CheckFlatStorageKeyMoves<false>(true);
+
+    flat_list props = flat_list::of("one", 1);
+    static_assert(std::is_const<std::remove_reference<decltype(props.values_begin()->first)>::type>::value,
+        "Key should be const for value iterators");
+    static_assert(std::is_same<decltype((*props.values_begin()).second), int &>::value,
+        "Value should be writable for value iterators");
+    props.values_begin()->second = 2;
+    Assert(props.get("one") == 2, "Value should be set through iterator");
+}
+
+typedef property_list<string, int, std::allocator<int>, property_list_small_storage<4> > small_list;
+
+// Test small storage before promotion: order, removal & reuse of free slots
+void TestSmallStorageInline() {
+    small_list props = small_list::of("one", 1, "two", 2, "three", 3, "four", 4);
+    props.remove("two");
+    Assert(props.needs_reorg(), "Removed entry in the middle should be a tombstone");
+    props.remove("four");
+    Assert(props.size() == 2, "Size after removal");
+
+    // array is full of entries and tombstones, so it is compacted instead of promoted
+    props.put("five", 5);
+    props.put("six", 6);
+    Assert(props.size() == 4, "Size after re-insert");
+    Assert(!props.contains("two") && !props.contains("four"), "Removed keys should not be found");
+
+    std::vector<string> keys = props.get_keys();
+    Assert(keys.size() == 4, "Should have 4 keys");
+    Assert(keys[0] == "one" && keys[1] == "three" && keys[2] == "five" && keys[3] == "six", "Keys should be in insertion order");
+    Assert(props.get("five") == 5 && props.get("three") == 3, "Values should survive compaction");
+
+    Assert(props.put("one", 11), "Replacing value should report existing key");
+    Assert(props.get_values()[0] == 11, "Replaced value should keep position");
+}
+
+// Test removal of all keys while iterating over inline entries
+void TestSmallStorageRemoveWhileIterating() {
+    small_list props = small_list::of("one", 1, "two", 2, "three", 3);
+    props.remove("two");
+    props.put("four", 4);
+
+    std::vector<string> visited;
+    for (auto it = props.keys_begin(); it != props.keys_end(); ++it) {
+        visited.push_back(*it);
+        props.remove(*it);
+    }
+    Assert(visited.size() == 3 && visited[0] == "one" && visited[2] == "four", "Should visit each key once");
+    Assert(props.empty(), "All keys should be removed");
+    auto first = props.keys_begin();
+    Assert(first == props.keys_end(), "Empty list after removal");
+}
+
+// Test promotion of small storage to flat storage
+void TestSmallStoragePromotion() {
+    small_list props;
+    for (int i = 0; i < 20; ++i)
+        props.put("key" + to_string(i), props.empty() ? i : props.get("key0") + i);
+    Assert(props.size() == 20, "Should hold all keys after promotion");
+
+    int expected = 0;
+    for (auto it = props.keys_begin(); it != props.keys_end(); ++it, ++expected)
+        Assert(*it == "key" + to_string(expected), "Keys should keep insertion order after promotion");
+    for (int i = 0; i < 20; ++i)
+        Assert(props.get("key" + to_string(i)) == i, "Values should survive promotion");
+
+    props.remove("key3");
+    Assert(!props.contains("key3"), "Remove after promotion");
+
+    // value refers to inline item which is moved during promotion
+    small_list full = small_list::of("a", 1, "b", 2, "c", 3, "d", 4);
+    full.put("e", full.get("a"));
+    Assert(full.get("e") == 1 && full.get("a") == 1, "Value should be copied before promotion");
+
+    // copy of a list which fits in the array
+    small_list copy(props);
+    copy.clear();
+    copy.put("a", 1);
+    small_list small_copy(copy);
+    Assert(small_copy == copy, "Copy of small promoted list");
+
+    small_list big_copy(props);
+    Assert(big_copy == props, "Copy of promoted list");
+    small_list moved(std::move(big_copy));
+    Assert(moved.size() == 19 && big_copy.empty(), "Move of promoted list");
+    big_copy.put("x", 1);
+    Assert(big_copy.get_keys().size() == 1, "Moved-from list should be usable");
+
+    small_list inline_list = small_list::of("a", 1, "b", 2);
+    small_list inline_moved(std::move(inline_list));
+    Assert(inline_moved.get("b") == 2 && inline_list.empty(), "Move of inline list");
+    inline_list = inline_moved;
+    Assert(inline_list == inline_moved, "Copy assignment of inline list");
+    props = std::move(inline_moved);
+    Assert(props.size() == 2 && props.get("a") == 1, "Move assignment of inline list to promoted list");
+    Assert(!props.storage().promoted(), "Moved inline list should stay inline");
+    inline_list = moved;
+    Assert(inline_list == moved && inline_list.storage().promoted(), "Copy assignment of promoted list to inline list");
+    props = std::move(inline_list);
+    Assert(props == moved && props.storage().promoted() && !inline_list.storage().promoted(), "Move assignment of promoted list");
+
+    // inline entries and flat storage share memory
+    typedef small_list::storage_type::entry entry;
+    static_assert(sizeof(small_list) < sizeof(flat_list) + 4 * sizeof(entry), "Promoted list should not keep inline entries");
+}
+
 // Main test runner
+typedef property_list<string, int, std::allocator<int>, property_list_shape_storage> shape_list;
+
+// lists built with the same keys in the same order share shape
+void TestShapeStorageSharing() {
+    shape_list a = shape_list::of("x", 1, "y", 2, "z", 3);
+    shape_list b = shape_list::of("x", 10, "y", 20, "z", 30);
+    shape_list c = shape_list::of("y", 1, "x", 2, "z", 3);
+    Assert(a.storage().shape() == b.storage().shape(), "Same keys in the same order should share shape");
+    Assert(a.storage().shape() != c.storage().shape(), "Different order should give different shape");
+    Assert(b.get("y") == 20 && c.get("y") == 1, "Values are kept per list");
+
+    b.put("y", 21);
+    Assert(a.storage().shape() == b.storage().shape() && b.get("y") == 21, "Update should keep shape");
+
+    b.remove("x");
+    shape_list d = shape_list::of("y", 0, "z", 0);
+    Assert(b.storage().shape() == d.storage().shape(), "Remove should move list to shape without key");
+    Assert(b.get_keys() == (vector<string>{"y", "z"}), "Keys after remove");
+    Assert(b.get("z") == 30 && !b.contains("x"), "Values after remove");
+
+    b.clear();
+    Assert(b.empty() && b.get_keys().empty(), "Clear");
+    b.put("x", 1);
+    Assert(b.get("x") == 1, "Put after clear");
+}
+
+// shapes of large lists take linear memory, they are kept for next lists until trim()
+void TestShapeStorageLarge() {
+    typedef property_list_shape<string> shape_type;
+    const int count = 5000;
+    const shape_type *shape;
+    {
+        shape_list a, b;
+        for (int i = 0; i < count; ++i)
+            a.put("key" + to_string(i), i);
+        for (int i = 0; i < count; ++i)
+            b.put("key" + to_string(i), -i);
+        Assert(a.storage().shape() == b.storage().shape(), "Large lists should share shape");
+        Assert(a.get("key0") == 0 && a.get("key4999") == 4999 && b.get("key2500") == -2500, "Lookup in large shape");
+        Assert(!a.contains("key5000"), "Missing key in large shape");
+
+        shape_list c(a), e(a);
+        c.remove("key1000");
+        e.remove("key1000");
+        Assert(c.storage().shape() == e.storage().shape(), "Removal should be remembered");
+        c.put("other", 1);
+        Assert(c.size() == count && !c.contains("key1000") && c.get("other") == 1, "Branch of large shape");
+        Assert(a.contains("key1000") && !a.contains("other") && a.get("key4999") == 4999, "Branch should not change shared keys");
+        shape = a.storage().shape();
+    }
+
+    shape_list d;
+    for (int i = 0; i < count; ++i)
+        d.put("key" + to_string(i), i);
+    Assert(d.storage().shape() == shape, "Shape should be kept for next list");
+    uint32_t shape_id = shape->id();
+    d.clear();
+
+    Assert(shape_type::trim() >= count, "Unused shapes should be destroyed by trim");
+    for (int i = 0; i < count; ++i)
+        d.put("key" + to_string(i), i);
+    Assert(d.storage().shape()->id() != shape_id && d.get("key4999") == 4999, "Lookup in rebuilt shape");
+
+    shape_list f = shape_list::of("x", 1, "y", 2);
+    shape_type::trim();
+    Assert(f.get("y") == 2 && shape_list::of("x", 0, "y", 0).storage().shape() == f.storage().shape(), "Used shapes should be kept by trim");
+}
+
+void TestShapeStorageItems() {
+    shape_list props;
+    for (int i = 0; i < 20; ++i)
+        props.put("key" + to_string(i), i);
+
+    int expected = 0;
+    for (auto it = props.values_begin(); it != props.values_end(); ++it, ++expected) {
+        Assert(it->first == "key" + to_string(expected), "Keys should keep insertion order");
+        Assert(it->second == expected, "Values should follow keys");
+        it->second += 100;
+    }
+    Assert(props.get("key19") == 119, "Value iterator should give access to values");
+    Assert(props.get("key5") == 105 && !props.contains("key20"), "Lookup in large shape");
+
+    const shape_list &cprops = props;
+    int sum = 0;
+    for (auto it = cprops.values_cbegin(); it != cprops.values_cend(); ++it)
+        sum += (*it).second;
+    Assert(sum == 20 * 100 + 190, "Const value iterator");
+
+    shape_list copy(props);
+    Assert(copy == props && copy.storage().shape() == props.storage().shape(), "Copy should share shape");
+    copy.put("key0", 0);
+    Assert(!(copy == props), "Lists with different values are not equal");
+
+    shape_list moved(std::move(copy));
+    Assert(moved.size() == 20 && copy.empty(), "Move");
+    copy = moved;
+    Assert(copy == moved, "Copy assignment");
+    copy = std::move(props);
+    Assert(copy.get("key1") == 101 && props.empty(), "Move assignment");
+
+    // value refers to item of the same list
+    copy.put("extra", copy.get("key1"));
+    Assert(copy.get("extra") == 101, "Value should be copied before values grow");
+}
+
+// lookup by text without constructing key
+template<typename ListType>
+void CheckTextLookup() {
+    ListType props = ListType::of("alpha", 1, "beta", 2);
+    for (int i = 0; i < 20; ++i)
+        props.put("key" + to_string(i), i);
+
+    const char *buffer = "beta,key12,gamma";
+    Assert(props.get(property_list_key_ref(buffer, 4)) == 2, "Lookup by pointer + length");
+    Assert(props.get(property_list_key_ref(buffer + 5, 5)) == 12, "Lookup by slice");
+    Assert(!props.contains(property_list_key_ref(buffer + 11, 5)), "Missing key by slice");
+    Assert(props.get("alpha") == 1 && props.contains("key19"), "Lookup by const char *");
+    Assert(*props.get_ptr("key3") == 3 && props.get_ptr("gamma") == nullptr, "get_ptr by text");
+    Assert(props.get_def("gamma", -1) == -1, "get_def by text");
+
+    const ListType &cprops = props;
+    Assert(cprops.get("beta") == 2, "Const lookup by text");
+
+    bool thrown = false;
+    try {
+        props.get(property_list_key_ref(buffer + 11, 5));
+    }
+    catch (const std::runtime_error &e) {
+        thrown = string(e.what()) == "key not found: gamma";
+    }
+    Assert(thrown, "Missing key should throw with key text");
+
+#if __cplusplus >= 201703L
+    std::string_view view(buffer, 4);
+    Assert(props.get(view) == 2 && props.contains(std::string_view("key7")), "Lookup by string_view");
+#endif
+
+    props.remove("alpha");
+    props.remove(property_list_key_ref(buffer, 4));
+    Assert(!props.contains("alpha") && !props.contains("beta") && props.size() == 20, "Remove by text");
+    Assert(property_list_key_hash(std::string("key12")) == property_list_key_hash(property_list_key_ref(buffer + 5, 5)),
+           "Key and text should have the same hash");
+}
+
+void TestTextLookup() {
+    CheckTextLookup<property_list<string, int> >();
+    CheckTextLookup<flat_list>();
+    CheckTextLookup<small_list>();
+    CheckTextLookup<shape_list>();
+}
+
+// values which can only be moved
+template<typename StoragePolicy>
+void CheckMoveOnlyValues() {
+    typedef property_list<string, std::unique_ptr<int>, std::allocator<std::unique_ptr<int> >, StoragePolicy> ptr_list;
+    ptr_list props;
+    for (int i = 0; i < 12; ++i)
+        props.put("key" + to_string(i), std::unique_ptr<int>(new int(i)));
+    props.emplace("new", new int(42));
+    props.emplace(string("new"), new int(43));
+    props.emplace("empty");
+    Assert(*props.get("new") == 43 && *props.get("key11") == 11, "Move-only values should be moved in");
+    Assert(props.get("empty") == nullptr, "Emplace without args should value-initialize");
+
+    ptr_list other;
+    other.put("key0", std::unique_ptr<int>(new int(100)));
+    other.put("other", std::unique_ptr<int>(new int(101)));
+    props.merge(std::move(other), property_list_merge_keep);
+    Assert(*props.get("key0") == 0 && *props.get("other") == 101 && other.empty(), "Merge should move values");
+}
+
+template<typename ListType>
+void CheckBulkOperations() {
+    ListType props;
+    props.reserve(40);
+    std::vector<std::pair<string, int> > items;
+    for (int i = 0; i < 40; ++i)
+        items.push_back(std::make_pair("key" + to_string(i), i));
+    props.put_all(items.begin(), items.end());
+    Assert(props.size() == 40 && props.get_keys()[39] == "key39", "put_all should keep order of range");
+
+    std::map<string, int> sorted;
+    sorted["a"] = 1;
+    sorted["key5"] = 55;
+    props.put_all(sorted.begin(), sorted.end());
+    Assert(props.size() == 41 && props.get("key5") == 55 && props.get_keys()[40] == "a", "put_all should replace values");
+
+    ListType copy;
+    copy.put_all(props.values_cbegin(), props.values_cend());
+    Assert(copy.size() == props.size() && copy.get("a") == 1, "put_all from other list");
+
+    string key("moved key");
+    props.put(std::move(key), 7);
+    Assert(props.get("moved key") == 7, "Put with moved key");
+
+    ListType other = ListType::of("key1", 100, "b", 2, "a", 3);
+    props.merge(std::move(other));
+    Assert(props.get("key1") == 100 && props.get("a") == 3 && props.get_keys().back() == "b", "Merge should replace values");
+    Assert(other.empty(), "Merged list should be empty");
+
+    other = ListType::of("key2", 200, "c", 3);
+    props.merge(std::move(other), property_list_merge_keep);
+    Assert(props.get("key2") == 2 && props.get("c") == 3, "Merge should keep existing values");
+    props.merge(std::move(props));
+    Assert(props.size() == 44, "Merge with itself should do nothing");
+}
+
+void TestBulkOperations() {
+    CheckBulkOperations<property_list<string, int, std::allocator<int>, property_list_hash_storage> >();
+    CheckBulkOperations<flat_list>();
+    CheckBulkOperations<small_list>();
+    CheckBulkOperations<shape_list>();
+    CheckMoveOnlyValues<property_list_hash_storage>();
+    CheckMoveOnlyValues<property_list_flat_storage>();
+    CheckMoveOnlyValues<property_list_small_storage<4> >();
+    CheckMoveOnlyValues<property_list_shape_storage>();
+}
+
+// one key handle used for lookups in many lists
+template<typename ListType>
+void CheckKeyHandle() {
+    const typename ListType::key_handle value_key("value"), missing_key("missing");
+    std::vector<ListType> lists;
+    for (int i = 0; i < 10; ++i) {
+        ListType props = ListType::of("id", i, "ts", 1000 + i, "value", i * 2);
+        if (i % 3 == 0)
+            props.put("extra" + to_string(i), 0);
+        lists.push_back(props);
+    }
+
+    int sum = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < lists.size(); ++i) {
+            const ListType &props = lists[i];
+            sum += props.get(value_key);
+            Assert(!props.contains(missing_key), "Handle of missing key");
+            Assert(props.get_def(missing_key, -1) == -1, "get_def with handle");
+        }
+    }
+    Assert(sum == 2 * 90, "Lookup with handle");
+    *lists[1].get_ptr(value_key) = 100;
+    Assert(lists[1].get("value") == 100, "get_ptr with handle");
+
+    bool thrown = false;
+    try {
+        lists[0].get(missing_key);
+    }
+    catch (const std::runtime_error &e) {
+        thrown = string(e.what()) == "key not found: missing";
+    }
+    Assert(thrown, "Missing key should throw");
+}
+
+void TestKeyHandle() {
+    CheckKeyHandle<property_list<string, int, std::allocator<int>, property_list_hash_storage> >();
+    CheckKeyHandle<flat_list>();
+    CheckKeyHandle<small_list>();
+    CheckKeyHandle<shape_list>();
+
+    // slot is remembered for shape of last list
+    shape_list::key_handle ts_key("ts");
+    shape_list first = shape_list::of("id", 1, "ts", 2), second = shape_list::of("ts", 3, "id", 4);
+    Assert(ts_key.cached_slot(first.storage().shape()->id()) == shape_list::key_handle::npos, "Empty cache");
+    Assert(first.get(ts_key) == 2, "Lookup in first shape");
+    Assert(ts_key.cached_slot(first.storage().shape()->id()) == 1, "Slot should be cached for shape");
+    Assert(second.get(ts_key) == 3 && first.get(ts_key) == 2, "Lookup in other shape");
+
+    // remembered slot is a hint: shape ids can repeat, 0 is the empty cache
+    Assert(ts_key.cached_slot(0) == shape_list::key_handle::npos, "Id 0 should not match");
+    ts_key.cache_slot(first.storage().shape()->id(), 0);
+    Assert(first.get(ts_key) == 2, "Slot with other key should not be used");
+    ts_key.cache_slot(first.storage().shape()->id(), 7);
+    Assert(first.get(ts_key) == 2, "Slot out of range should not be used");
+    Assert(ts_key.hash() == property_list_entry_hash(string("ts")), "Handle should keep entry hash");
+}
+
+// key with many equal hashes, for lookup of keys which perfect hash can't separate
+struct weak_key {
+    int value;
+
+    bool operator==(const weak_key &rhs) const {
+        return value == rhs.value;
+    }
+};
+
+namespace std {
+    template<>
+    struct hash<weak_key> {
+        size_t operator()(const weak_key &key) const {
+            return static_cast<size_t>(key.value % 3);
+        }
+    };
+}
+
+void TestFrozenStorage() {
+    typedef property_list<string, int, std::allocator<int>, property_list_frozen_storage> frozen_list;
+    for (int count = 0; count < 300; count += (count < 20) ? 1 : 37) {
+        flat_list props;
+        for (int i = 0; i < count; ++i)
+            props.put("key" + to_string(i * 7), i);
+        props.remove("key7");
+        frozen_list frozen = props.freeze();
+        Assert(frozen.size() == props.size(), "Frozen list should have all items");
+        Assert(frozen.storage().slot_count() >= frozen.size(), "Each item should have its slot");
+        for (int i = 0; i < count; ++i)
+            Assert(frozen.contains("key" + to_string(i * 7)) == (i != 1), "Frozen lookup");
+        Assert(!frozen.contains("key1") && !frozen.contains(""), "Missing keys of frozen list");
+        Assert(frozen.get_keys() == props.get_keys(), "Frozen list should keep order");
+    }
+
+    small_list props = small_list::of("id", 1, "name", 2, "value", 3);
+    frozen_list frozen = props.freeze();
+    const frozen_list::key_handle value_key("value");
+    Assert(frozen.get("name") == 2 && frozen.get(value_key) == 3, "Lookup by text and handle");
+    Assert(frozen.get_def("missing", -1) == -1, "get_def of frozen list");
+    frozen.get("id") = 10;
+    Assert(frozen.get("id") == 10 && props.get("id") == 1, "Values of frozen list can be updated");
+
+    frozen_list copy(frozen);
+    Assert(copy == frozen && copy.get(value_key) == 3, "Copy of frozen list");
+    frozen_list moved(std::move(copy));
+    Assert(moved.get("name") == 2 && copy.empty() && !copy.contains("name"), "Move of frozen list");
+    copy = moved;
+    Assert(copy.get_keys() == props.get_keys(), "Assignment of frozen list");
+
+    // thaw
+    flat_list thawed(frozen);
+    thawed.put("new", 4);
+    Assert(thawed.size() == 4 && thawed.get("id") == 10 && thawed.get_keys()[3] == "new", "Thawed list");
+
+    typedef property_list<weak_key, int, std::allocator<int>, property_list_flat_storage> weak_list;
+    weak_list weak;
+    for (int i = 0; i < 50; ++i) {
+        weak_key key = { i };
+        weak.put(key, i * 2);
+    }
+    property_list<weak_key, int, std::allocator<int>, property_list_frozen_storage> frozen_weak = weak.freeze();
+    for (int i = 0; i < 60; ++i) {
+        weak_key key = { i };
+        const int *found = frozen_weak.get_ptr(key);
+        Assert((found != nullptr) == (i < 50) && (found == nullptr || *found == i * 2), "Lookup of keys with equal hashes");
+    }
+}
+
 int main() {
     try {
         std::cout << "Running property_list iterator tests..." << std::endl;
@@ -272,6 +953,24 @@ int main() {
         TestKeysIteratorsWithReorg();
         TestKeyIteratorModification();
         TestStaticOfMethods();
+        TestDefaultStoragePolicy();
+        TestFlatStorageOrder();
+        TestFlatStorageGrowth();
+        TestFlatStorageCopyMove();
+        TestFlatStorageSelfReference();
+        TestFlatStorageTombstones();
+        TestFlatStorageRemoveWhileIterating();
+        TestFlatStorageKeyMoves();
+        TestSmallStorageInline();
+        TestSmallStorageRemoveWhileIterating();
+        TestSmallStoragePromotion();
+        TestShapeStorageSharing();
+        TestShapeStorageItems();
+        TestShapeStorageLarge();
+        TestTextLookup();
+        TestBulkOperations();
+        TestKeyHandle();
+        TestFrozenStorage();
         
         std::cout << "All tests passed!" << std::endl;
         return 0;
@@ -33,6 +33,13 @@ void TestArrayOfWithAutomaticConversion() {
     Assert(mixed[1].get_as<std::string>() == "hello", "Second element should be 'hello'");
     Assert(abs(mixed[2].get_as<double>() - 3.14) < 0.0001, "Third element should be 3.14");
     Assert(mixed[3].get_as<bool>() == true, "Fourth element should be true");
+
+    // Nodes are added without wrapping
+    xnode node = xnode::value_of(7);
+    xarray with_nodes = xarray::of(node, xnode::value_of(std::string("moved")), 8);
+    Assert(with_nodes[0].is<int>() && with_nodes[0].get_as<int>() == 7, "Node should be added as it is");
+    Assert(with_nodes[1].is<std::string>(), "Moved node should be added as it is");
+    Assert(with_nodes[2].get_as<int>() == 8, "Value should be converted");
 }
 #endif
 
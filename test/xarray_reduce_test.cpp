@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_reduce_test.cpp
+// Purpose:     Unit tests for reductions over xarray (xarray_reduce.h)
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xarray.h"
+#include "xarray_reduce.h"
+#include <cmath>
+#include <climits>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#include "cunit.h"
+
+using namespace std;
+
+// runs check for each instruction set supported by CPU
+template <typename Func>
+void for_each_level(Func check) {
+    int previous = xarray_simd_level();
+    for (int level = xarray_simd_scalar; level <= xarray_simd_detect(); ++level) {
+        xarray_simd_set_level(level);
+        check();
+    }
+    xarray_simd_set_level(previous);
+}
+
+void TestReduceIntegers() {
+    xarray packed;
+    xarray boxed;
+    xarray longs;
+    long long expected_sum = 0;
+    for (int i = 0; i < 1001; ++i) {
+        int value = (i % 7 == 0) ? -i : i * 3;
+        packed.push_back(xnode::value_of(value));
+        boxed.push_back(xnode::value_of(value));
+        longs.push_back(xnode::value_of(static_cast<long long>(value) * 1000000));
+        expected_sum += value;
+    }
+    boxed.unpack();
+    Assert(packed.packed() && !boxed.packed(), "Layouts of arrays");
+
+    for_each_level([&]() {
+        AssertEquals(expected_sum, xarray_sum<long long>(packed), "Sum of packed ints");
+        AssertEquals(expected_sum, xarray_sum<long long>(boxed), "Sum of int nodes");
+        AssertEquals(static_cast<double>(expected_sum), xarray_sum(packed), "Sum of ints as double");
+        AssertEquals(expected_sum * 1000000, xarray_sum<long long>(longs), "Sum of long longs");
+        AssertEquals(-994, xarray_min<int>(packed), "Min of ints");
+        AssertEquals(3000, xarray_max<int>(boxed), "Max of ints");
+        AssertEquals(3000000000LL, xarray_max<long long>(longs), "Max of long longs");
+        AssertEquals(-994000000LL, xarray_min<long long>(longs), "Min of long longs");
+    });
+}
+
+void TestReduceDoubles() {
+    xarray values;
+    for (int i = 0; i < 103; ++i)
+        values.push_back(xnode::value_of(i * 0.5));
+    xarray floats;
+    for (int i = 0; i < 103; ++i)
+        floats.push_back(xnode::value_of(static_cast<float>(i) * 0.25f));
+
+    for_each_level([&]() {
+        AssertEquals(2626.5, xarray_sum(values), "Sum of doubles");
+        AssertEquals(25.5, xarray_mean(values), "Mean of doubles");
+        AssertEquals(0.0, xarray_min(values), "Min of doubles");
+        AssertEquals(51.0, xarray_max(values), "Max of doubles");
+        AssertEquals(1313.25, xarray_sum(floats), "Sum of floats");
+        AssertEquals(25.5, xarray_max<float>(floats), "Max of floats");
+        AssertEquals(51, xarray_max<int>(values), "Max of doubles as int");
+        AssertEquals(2601, xarray_sum<int>(values), "Doubles are truncated per element when summed as ints");
+    });
+
+    xarray with_nan = xarray::of(xnode::value_of(1.0), xnode::value_of(std::nan("")), xnode::value_of(-3.0));
+    Assert(std::isnan(xarray_sum(with_nan)), "NaN is included in sum");
+    AssertEquals(-3.0, xarray_min(with_nan), "NaN is skipped by min");
+    AssertEquals(1.0, xarray_max(with_nan), "NaN is skipped by max");
+    xarray only_nan = xarray::of(xnode::value_of(std::nan("")));
+    AssertThrows([&only_nan]() { xarray_min(only_nan); }, "Min of NaN only");
+}
+
+void TestReduceMixed() {
+    xarray values;
+    values.push_back(xnode::value_of(1));
+    values.push_back(xnode::value_of(2));
+    values.push_back(xnode());
+    values.push_back(xnode::value_of(2.5));
+    values.push_back(xnode::value_of(std::string("4")));
+    values.push_back(xnode::value_of(static_cast<short>(5)));
+    values.push_back(xnode::value_of(true));
+    values.push_back(xnode::value_of(10LL));
+    Assert(!values.packed(), "Mixed array is not packed");
+
+    for_each_level([&]() {
+        AssertEquals(25.5, xarray_sum(values), "Sum of mixed array");
+        AssertEquals(25LL, xarray_sum<long long>(values), "Sum of mixed array as integers");
+        AssertEquals(7u, static_cast<unsigned>(xarray_count_if_non_null(values)), "Null is not counted");
+        AssertEquals(25.5 / 7, xarray_mean(values), "Mean skips null");
+        AssertEquals(1.0, xarray_min(values), "Min of mixed array");
+        AssertEquals(10.0, xarray_max(values), "Max of mixed array");
+    });
+
+    xarray empty;
+    AssertEquals(0.0, xarray_sum(empty), "Sum of empty array");
+    AssertEquals(0u, static_cast<unsigned>(xarray_count_if_non_null(empty)), "Count of empty array");
+    Assert(std::isnan(xarray_mean(empty)), "Mean of empty array");
+    AssertThrows([&empty]() { xarray_max(empty); }, "Max of empty array");
+
+    xarray text = xarray::of(xnode::value_of(std::string("abc")));
+    AssertThrows([&text]() { xarray_sum(text); }, "Text which is not a number");
+}
+
+void TestReduceRange() {
+    xarray big = xarray::of(xnode::value_of(2000000000), xnode::value_of(2000000000));
+    AssertEquals(4000000000LL, xarray_sum<long long>(big), "Sum of ints as long long");
+    AssertThrows([&big]() { xarray_sum<int>(big); }, "Sum which does not fit in int");
+
+    xarray huge = xarray::of(xnode::value_of(5000000000LL), xnode::value_of(1LL));
+    AssertThrows([&huge]() { xarray_sum<int>(huge); }, "Element which does not fit in int");
+    AssertThrows([&huge]() { xarray_min<int>(huge); }, "Min checks range of every element");
+
+    xarray negative = xarray::of(xnode::value_of(3), xnode::value_of(-1));
+    AssertThrows([&negative]() { xarray_sum<unsigned int>(negative); }, "Negative element as unsigned");
+
+    for_each_level([]() {
+        xarray overflow;
+        for (int i = 0; i < 16; ++i)
+            overflow.push_back(xnode::value_of(LLONG_MAX / 4));
+        AssertThrows([&overflow]() { xarray_sum<long long>(overflow); }, "Sum of long longs which overflows");
+        AssertEquals(static_cast<double>(LLONG_MAX / 4) * 16, xarray_sum(overflow), "Sum of long longs as double");
+        xarray above_signed;
+        for (int i = 0; i < 5; ++i)
+            above_signed.push_back(xnode::value_of(LLONG_MAX / 4));
+        AssertEquals(static_cast<unsigned long long>(LLONG_MAX / 4) * 5, xarray_sum<unsigned long long>(above_signed),
+                     "Sum of long longs as unsigned");
+
+        xarray cancel;
+        for (int i = 0; i < 8; ++i) {
+            cancel.push_back(xnode::value_of(LLONG_MAX - 1));
+            cancel.push_back(xnode::value_of(-(LLONG_MAX - 1)));
+        }
+        AssertEquals(0LL, xarray_sum<long long>(cancel), "Sum of long longs which cancel out");
+    });
+}
+
+void TestReduceDot() {
+    xarray lhs, rhs, ints;
+    double expected = 0;
+    for (int i = 0; i < 517; ++i) {
+        lhs.push_back(xnode::value_of(i * 0.5));
+        rhs.push_back(xnode::value_of(2.0));
+        ints.push_back(xnode::value_of(2));
+        expected += i;
+    }
+    for_each_level([&]() {
+        AssertEquals(expected, xarray_dot(lhs, rhs), "Dot product of doubles");
+        AssertEquals(expected, xarray_dot(lhs, ints), "Dot product of doubles and ints");
+    });
+
+    xarray with_null = xarray::of(xnode::value_of(1.0), xnode(), xnode::value_of(3.0));
+    xarray other = xarray::of(xnode::value_of(2.0), xnode::value_of(std::nan("")), xnode::value_of(4.0));
+    AssertEquals(14.0, xarray_dot(with_null, other), "Pairs with null are skipped");
+    AssertThrows([&lhs, &other]() { xarray_dot(lhs, other); }, "Arrays with different sizes");
+}
+
+int xarray_reduce_test() {
+    TEST_PROLOG();
+    TEST_FUNC(ReduceIntegers);
+    TEST_FUNC(ReduceDoubles);
+    TEST_FUNC(ReduceMixed);
+    TEST_FUNC(ReduceRange);
+    TEST_FUNC(ReduceDot);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xarray_reduce_test();
+}
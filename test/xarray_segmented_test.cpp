@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_segmented_test.cpp
+// Purpose:     Unit tests for segmented arrays (xarray_segmented.h)
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xarray.h"
+#include "xarray_segmented.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <stdexcept>
+
+#include "cunit.h"
+
+using namespace std;
+
+typedef basic_segmented_xarray<xnode, std::allocator<xnode>, 4> small_chunk_array;
+
+void TestSegmentedAppend() {
+    small_chunk_array values;
+    Assert(values.empty() && values.chunk_count() == 0, "Empty array has no chunks");
+
+    values.push_back(xnode::value_of(0));
+    const xnode *first = &values[0];
+    for (int i = 1; i < 10; ++i)
+        values.push_back(xnode::value_of(i));
+    values.emplace_back(xnode::value_of(std::string("last")));
+
+    AssertEquals(11u, static_cast<unsigned>(values.size()), "size");
+    AssertEquals(3u, static_cast<unsigned>(values.chunk_count()), "chunks allocated by appends");
+    Assert(first == &values[0], "Elements are not relocated by appends");
+    AssertEquals(9, values[9].get_as<int>(), "element in 3rd chunk");
+    AssertEquals(std::string("last"), values.back().get_as<std::string>(), "back");
+    AssertThrows([&values]() { values.at(11); }, "index out of range");
+
+    int expected = 0;
+    for (small_chunk_array::const_iterator it = values.begin(); it != values.end() - 1; ++it)
+        AssertEquals(expected++, it->get_as<int>(), "iteration over chunks");
+    AssertEquals(10, expected, "number of iterated elements");
+    AssertEquals(11, static_cast<int>(values.end() - values.begin()), "distance between iterators");
+    AssertEquals(7, (values.begin() + 7)->get_as<int>(), "random access iterator");
+    small_chunk_array::iterator back = values.end();
+    --back;
+    --back;
+    AssertEquals(9, back->get_as<int>(), "iterator moved back from end");
+}
+
+void TestSegmentedRelease() {
+    small_chunk_array values;
+    for (int i = 0; i < 10; ++i)
+        values.push_back(xnode::value_of(i));
+
+    values.pop_back();
+    values.pop_back();
+    AssertEquals(2u, static_cast<unsigned>(values.chunk_count()), "Empty chunk released by pop_back");
+
+    for (int i = 0; i < 5; ++i)
+        values.pop_front();
+    AssertEquals(1u, static_cast<unsigned>(values.chunk_count()), "Empty chunk released by pop_front");
+    AssertEquals(5, values.front().get_as<int>(), "front after pop_front");
+    AssertEquals(3u, static_cast<unsigned>(values.size()), "size after pops");
+
+    values.push_back(xnode::value_of(8));
+    values.push_back(xnode::value_of(9));
+    AssertEquals(2u, static_cast<unsigned>(values.chunk_count()), "Chunk added after partly used front chunk");
+    AssertEquals(9, values[4].get_as<int>(), "element after front offset");
+
+    while (!values.empty())
+        values.pop_front();
+    AssertEquals(0u, static_cast<unsigned>(values.chunk_count()), "All chunks released");
+
+    values.push_back(xnode::value_of(1));
+    values.clear();
+    Assert(values.empty() && values.chunk_count() == 0, "clear releases chunks");
+}
+
+void TestSegmentedCopyAndNode() {
+    segmented_xarray values;
+    for (int i = 0; i < 3000; ++i)
+        values.push_back(xnode::value_of(i));
+    AssertEquals(3u, static_cast<unsigned>(values.chunk_count()), "chunks of default size");
+
+    segmented_xarray copy(values);
+    Assert(copy == values && !(copy < values), "Copy is equal");
+    copy.back().set_as(-1);
+    Assert(copy != values && copy < values, "Modified copy");
+
+    segmented_xarray moved(std::move(copy));
+    Assert(copy.empty() && moved.size() == 3000, "Moved array");
+
+    xnode node = xnode::value_of(std::move(moved));
+    AssertEquals(27, node.get_type_code(), "Type code of segmented array");
+    Assert(node.is<segmented_xarray>(), "Segmented array in node");
+    AssertEquals(2999u, static_cast<unsigned>(node.get_ptr<segmented_xarray>()->size() - 1), "Size of array in node");
+    xnode node_copy = node;
+    Assert(node_copy == node, "Copy of node with segmented array");
+
+    xarray packed = xarray::of(xnode::value_of(1), xnode::value_of(2));
+    segmented_xarray converted = segmented_xarray::from_xarray(packed);
+    Assert(packed.packed() && converted.size() == 2 && converted[1].get_as<int>() == 2, "Conversion from xarray");
+    Assert(converted.to_xarray() == packed, "Conversion to xarray");
+}
+
+void TestNodeMoveNoexcept() {
+    Assert(std::is_nothrow_move_constructible<xnode>::value, "xnode is moved by std::vector");
+    Assert(std::is_nothrow_move_assignable<xnode>::value, "xnode move assignment is noexcept");
+    Assert(std::is_nothrow_move_constructible<segmented_xarray>::value, "segmented array move is noexcept");
+
+    std::vector<xnode> nodes;
+    nodes.push_back(xnode::value_of(std::string("text which is not copied")));
+    const std::string *text = nodes[0].get_ptr<std::string>();
+    for (int i = 0; i < 100; ++i)
+        nodes.push_back(xnode::value_of(i));
+    Assert(text == nodes[0].get_ptr<std::string>(), "Owned value is kept when vector grows");
+}
+
+int xarray_segmented_test() {
+    TEST_PROLOG();
+    TEST_FUNC(SegmentedAppend);
+    TEST_FUNC(SegmentedRelease);
+    TEST_FUNC(SegmentedCopyAndNode);
+    TEST_FUNC(NodeMoveNoexcept);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xarray_segmented_test();
+}
@@ -22,6 +22,13 @@
 // for std::to_string
 #include <string>
 
+// for std::nan
+#include <cmath>
+
+// for std::thread
+#include <thread>
+#include <type_traits>
+
 #include "cunit.h"
 #include "xobject.h"
 
@@ -238,6 +245,13 @@ void TestArrayCopy() {
 	copy[0].set_as(100);
 	Assert(original[0].get_as<int>() == 1, "Original should be unchanged");
 	Assert(copy[0].get_as<int>() == 100, "Copy should be modified");
+
+	// arrays are moved by containers without copying
+	Assert(std::is_nothrow_move_constructible<xarray>::value, "Move of xarray should be noexcept");
+	Assert(std::is_nothrow_move_assignable<xarray>::value, "Move assignment of xarray should be noexcept");
+	xarray moved;
+	moved = std::move(copy);
+	Assert(moved.size() == 3 && moved[0].get_as<int>() == 100 && copy.empty(), "Move assignment");
 }
 
 void TestArrayIteration() {
@@ -306,6 +320,172 @@ void TestArrayManipulation() {
 	Assert(v[0].get_as<int>() == 5, "Resized element should have default value");
 }
 
+void TestArrayPacking() {
+	// Elements of the same scalar type are packed
+	xarray v;
+	v.reserve(100);
+	for (int i = 0; i < 100; ++i)
+		v.push_back(xnode::value_of(i));
+	Assert(v.packed() && v.size() == 100, "Array of ints should be packed");
+	Assert(v.capacity() >= 100, "Reserved capacity should be kept");
+	Assert(v.node_at(42).is<int>() && v.node_at(42).get_as<int>() == 42, "Element of packed array");
+
+	// Const access by reference keeps packed elements
+	const xarray &cv = v;
+	int sum = 0;
+	for (const auto& node : cv)
+		sum += node.get_as<int>();
+	Assert(sum == 4950 && cv[99].get_as<int>() == 99 && v.packed(), "Const access should not unpack");
+
+	// Copies are packed and compare equal to unpacked arrays
+	xarray copy(v);
+	xarray boxed(v);
+	boxed[0].set_as(0);
+	Assert(copy.packed() && !boxed.packed(), "Non-const access should unpack");
+	Assert(copy == v && copy == boxed && boxed == copy, "Packed and unpacked arrays should be equal");
+	copy.push_back(xnode::value_of(100));
+	Assert(v < copy && !(copy < boxed) && boxed < copy, "Order of packed and unpacked arrays");
+	copy.resize(50);
+	Assert(copy.packed() && copy.size() == 50 && copy.node_at(49).get_as<int>() == 49, "Resize of packed array");
+
+	// Element of other type unpacks array
+	v.push_back(xnode::value_of(2.5));
+	Assert(!v.packed() && v.size() == 101, "Mixed array should be unpacked");
+	Assert(v[0].is<int>() && v[100].is<double>(), "Types should be kept after unpack");
+
+	v.clear();
+	v.push_back(xnode::value_of(1.5));
+	v.push_back(xnode::value_of(2.5));
+	Assert(v.packed() && v.packed_data().code() == xnode_type_code<double>::value, "Empty array should be packed again");
+	v.insert(v.begin(), xnode::value_of(0.5));
+	v.erase(v.begin() + 1);
+	Assert(!v.packed() && v.size() == 2 && v[1].get_as<double>() == 2.5, "Insert and erase unpack array");
+
+	xarray nan_values = xarray::of(xnode::value_of(std::nan("")), xnode::value_of(-0.0));
+	xarray nan_boxed(nan_values);
+	nan_boxed.unpack();
+	xarray zeros = xarray::of(xnode::value_of(std::nan("")), xnode::value_of(0.0));
+	Assert(nan_values.packed() && nan_values == nan_boxed && nan_boxed == nan_values, "Packed doubles compare like nodes");
+	Assert(!(nan_values == zeros) && (nan_boxed == zeros) == (nan_values == zeros), "Packed doubles compare by bits like nodes");
+
+	// Const access from many threads creates xnode elements once
+	xarray shared;
+	for (int i = 0; i < 1000; ++i)
+		shared.push_back(xnode::value_of(static_cast<long long>(i)));
+	const xarray &cshared = shared;
+	std::vector<long long> sums(4, 0);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < sums.size(); ++t) {
+		threads.push_back(std::thread([&cshared, &sums, t]() {
+			for (size_t i = 0; i < cshared.size(); ++i)
+				sums[t] += (t % 2 == 0) ? cshared[i].get_as<long long>() : cshared.node_at(i).get_as<long long>();
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+	for (size_t t = 0; t < sums.size(); ++t)
+		Assert(sums[t] == 499500, "Sum read by thread");
+}
+
+// allocator which counts allocations of element buffers
+static int xarray_allocations = 0;
+
+template<typename T>
+struct counting_allocator {
+	typedef T value_type;
+	counting_allocator() {}
+	template<typename U> counting_allocator(const counting_allocator<U> &) {}
+	T *allocate(size_t n) {
+		++xarray_allocations;
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T *p, size_t n) { std::allocator<T>().deallocate(p, n); }
+	template<typename U> bool operator==(const counting_allocator<U> &) const { return true; }
+	template<typename U> bool operator!=(const counting_allocator<U> &) const { return false; }
+};
+
+void TestArrayInline() {
+	typedef basic_xarray<xnode, counting_allocator<xnode> > counted_xarray;
+
+	// Short arrays are kept inside of array object
+	xarray_allocations = 0;
+	counted_xarray mixed;
+	mixed.push_back(xnode::value_of(1));
+	mixed.push_back(xnode::value_of(std::string("two")));
+	mixed.push_back(xnode::value_of(3.0));
+	mixed.push_back(xnode());
+	Assert(!mixed.packed() && mixed.size() == 4 && mixed.capacity() == 4, "Mixed elements in inline buffer");
+	counted_xarray ints = counted_xarray::of(xnode::value_of(1), xnode::value_of(2), xnode::value_of(3));
+	Assert(ints.packed() && ints.capacity() == 8, "Packed ints in inline buffer");
+	counted_xarray copy(mixed);
+	counted_xarray moved(std::move(copy));
+	Assert(copy.empty() && moved == mixed && moved[1].get_as<std::string>() == "two", "Copy and move of inline array");
+	AssertEquals(0, xarray_allocations, "Inline arrays do not allocate");
+	Assert(sizeof(xarray) < sizeof(xarray::container_type) + sizeof(xarray::packed_type), "Packed and boxed layouts share inline buffer");
+
+	// Nodes created for const access of packed array are allocated, they are reused when array is unpacked
+	counted_xarray shared = counted_xarray::of(xnode::value_of(1), xnode::value_of(2));
+	const counted_xarray &cshared = shared;
+	Assert(cshared[1].get_as<int>() == 2 && shared.packed(), "Const access keeps packed elements");
+	AssertEquals(1, xarray_allocations, "Nodes of packed array allocated once");
+	shared.insert(cshared.begin() + 1, xnode::value_of(std::string("x")));
+	Assert(!shared.packed() && shared.size() == 3 && shared[1].get_as<std::string>() == "x" && shared[2].get_as<int>() == 2,
+		"Insert at position of const iterator unpacks array");
+	xarray_allocations = 0;
+
+	// Element buffer is allocated after inline capacity is used
+	mixed.push_back(xnode::value_of(5));
+	Assert(mixed.size() == 5 && mixed.capacity() >= 5 && mixed[1].get_as<std::string>() == "two", "Array moved to element buffer");
+	AssertEquals(1, xarray_allocations, "Element buffer allocated once");
+	counted_xarray grown(std::move(mixed));
+	AssertEquals(1, xarray_allocations, "Element buffer is taken by move");
+	Assert(mixed.empty() && grown.size() == 5, "Array moved with element buffer");
+
+	// Operations which cross inline capacity
+	grown.erase(grown.begin() + 4);
+	grown.insert(grown.begin(), xnode::value_of(0));
+	grown.insert(grown.begin() + 2, xnode::value_of(-1));
+	Assert(grown.size() == 6 && grown[0].get_as<int>() == 0 && grown[2].get_as<int>() == -1 && grown[3].get_as<std::string>() == "two",
+		"Insert and erase of array");
+	grown.resize(2);
+	Assert(grown.size() == 2 && grown[1].get_as<int>() == 1, "Resize of array");
+	xarray values;
+	values.reserve(3);
+	Assert(values.capacity() >= 3, "Reserve within inline capacity");
+	values.resize(20, xnode::value_of(std::string("x")));
+	Assert(values.size() == 20 && values.capacity() >= 20 && values[19].get_as<std::string>() == "x", "Resize above inline capacity");
+
+	// Value passed by reference can be an element of the same array
+	std::string long_text(100, 'z');
+	xarray texts;
+	texts.push_back(xnode::value_of(long_text));
+	texts.resize(10, texts[0]);
+	Assert(texts.size() == 10 && texts[9].get_as<std::string>() == long_text, "Resize with element of array");
+	xarray numbers = xarray::of(xnode::value_of(1), xnode::value_of(2));
+	const xarray &cnumbers = numbers;
+	numbers.push_back(cnumbers[1]);
+	numbers.resize(8, cnumbers[2]);
+	Assert(numbers.packed() && numbers.size() == 8 && cnumbers[7].get_as<int>() == 2, "Element created for const access of packed array as value");
+	numbers.insert(cnumbers.begin(), cnumbers[0]);
+	Assert(!numbers.packed() && numbers.size() == 9 && numbers[0].get_as<int>() == 1 && numbers[1].get_as<int>() == 1,
+		"Insert of element created for const access");
+
+	// Inline capacity is a template parameter
+	typedef basic_xarray<xnode, std::allocator<xnode>, 8> wide_xarray;
+	typedef basic_xarray<xnode, std::allocator<xnode>, 0> heap_xarray;
+	wide_xarray wide;
+	heap_xarray heap;
+	for (int i = 0; i < 8; ++i) {
+		wide.push_back(xnode::value_of(std::string(1, 'a' + i)));
+		heap.push_back(xnode::value_of(std::string(1, 'a' + i)));
+	}
+	Assert(wide.capacity() == 8 && wide[7].get_as<std::string>() == "h", "Array with 8 inline elements");
+	Assert(heap.size() == 8 && heap[7].get_as<std::string>() == "h", "Array without inline elements");
+	xnode node = xnode::value_of(wide);
+	Assert(node.is<wide_xarray>() && node.get_type_code() == xnode_type_code<xarray>::value, "Array with inline elements in node");
+	Assert(node.get_ptr<wide_xarray>()->size() == 8, "Size of array in node");
+}
+
 int xarray_test() {
 	TEST_PROLOG();
 	TEST_FUNC(ArraySum);
@@ -318,6 +498,8 @@ int xarray_test() {
 	TEST_FUNC(ArrayCopy);
 	TEST_FUNC(ArrayIteration);
 	TEST_FUNC(ArrayManipulation);
+	TEST_FUNC(ArrayPacking);
+	TEST_FUNC(ArrayInline);
 	TEST_EPILOG();
 }
 
@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------------------
+// Name:        xarray_typed_test.cpp
+// Purpose:     Unit tests for typed arrays (xarray_of<T>)
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xarray.h"
+#include "xarray_typed.h"
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "cunit.h"
+
+using namespace std;
+
+void TestTypedNumbers() {
+    xarray_of<double> values = {1.5, 2.5, 3.0};
+    values.push_back(4.0);
+    AssertEquals(4u, static_cast<unsigned>(values.size()), "size");
+    AssertEquals(11.0, std::accumulate(values.data(), values.data() + values.size(), 0.0), "sum over data()");
+
+    xarray_of<int64_t> ids(3, 7);
+    ids[1] = 8;
+    ids.insert(ids.begin(), 6);
+    ids.erase(ids.end() - 1);
+    Assert(ids == xarray_of<int64_t>({6, 7, 8}), "modifiers");
+    Assert(ids < xarray_of<int64_t>({6, 8}), "order");
+
+    xnode node = ids.node_at(2);
+    AssertEquals(8, node.get_as<int>(), "element as node");
+    AssertThrows([&ids]() { ids.node_at(3); }, "index out of range");
+}
+
+void TestTypedBool() {
+    xarray_of<bool> flags;
+    for (int i = 0; i < 100; ++i)
+        flags.push_back(i % 3 == 0);
+    AssertEquals(34, static_cast<int>(std::count(flags.begin(), flags.end(), true)), "bit-packed flags");
+    flags[1] = true;
+    Assert(flags.at(1) && !flags.at(2), "element access");
+    Assert(flags.node_at(0).get_as<bool>(), "flag as node");
+}
+
+void TestTypedStrings() {
+    xarray_of<string> names = {"alpha", "", "gamma"};
+    names.push_back("delta", 3);
+    AssertEquals(4u, static_cast<unsigned>(names.size()), "size");
+    AssertEquals(string("del"), names[3], "pointer + length");
+    AssertEquals(string(""), names.at(1), "empty text");
+    AssertEquals(5u, static_cast<unsigned>(names.length(2)), "length");
+    Assert(std::string(names.data(2), names.length(2)) == "gamma", "text of element");
+
+    names.set(0, "a");
+    names.set(1, "beta");
+    vector<string> copy(names.begin(), names.end());
+    Assert(copy.size() == 4 && copy[0] == "a" && copy[1] == "beta" && copy[2] == "gamma" && copy[3] == "del", "set");
+
+    names.pop_back();
+    Assert(names == xarray_of<string>({"a", "beta", "gamma"}), "pop_back");
+    Assert(xarray_of<string>({"a", "b"}) < xarray_of<string>({"a", "ba"}), "order");
+    Assert(!(xarray_of<string>({"b"}) < xarray_of<string>({"a", "b"})), "order of first element");
+    AssertThrows([&names]() { names.at(3); }, "index out of range");
+
+#if __cplusplus >= 201703L
+    Assert(names.view(1) == "beta", "view");
+#endif
+}
+
+void TestTypedConversion() {
+    xarray nodes = xarray::of(xnode::value_of(1), xnode::value_of(2.5), xnode::value_of(string("3")));
+    xarray_of<double> values = xarray_of<double>::from_xarray(nodes);
+    Assert(values == xarray_of<double>({1.0, 2.5, 3.0}), "bulk conversion from xarray");
+
+    xarray back = values.to_xarray();
+    AssertEquals(3u, static_cast<unsigned>(back.size()), "bulk conversion to xarray");
+    Assert(back[1].is<double>() && back[1].get_as<double>() == 2.5, "element of converted array");
+
+    xarray_of<string> texts = xarray_of<string>::from_xarray(nodes);
+    AssertEquals(string("1"), texts[0], "numbers converted to texts");
+    Assert(texts.to_xarray()[2].get_as<string>() == "3", "texts to xarray");
+
+    xarray mixed = xarray::of(xnode::value_of(1), xnode::value_of(string("x")));
+    AssertThrows([&mixed]() { xarray_of<int32_t>::from_xarray(mixed); }, "element which can't be converted");
+}
+
+void TestTypedInNode() {
+    xnode node = xnode::value_of(xarray_of<double>({1.0, 2.0}));
+    Assert(node.is<xarray_of<double> >() && !node.is<xarray>(), "typed array in node");
+    AssertEquals(23, node.get_type_code(), "type code of double array");
+    AssertEquals(2.0, (*node.get_ptr<xarray_of<double> >())[1], "element of array in node");
+
+    xnode texts = xnode::value_of(xarray_of<string>({"a"}));
+    AssertEquals(25, texts.get_type_code(), "type code of text array");
+    Assert(xnode::value_of(xarray_of<int64_t>()).get_type_code() == 22, "type code of int64 array");
+    Assert(xnode::value_of(xarray_of<bool>()).get_type_code() == 24, "type code of bool array");
+    Assert(xnode::value_of(xarray_of<int32_t>()).get_type_code() == 26, "type code of int32 array");
+
+    xnode copy = texts;
+    Assert(copy == texts, "copy of node with typed array");
+}
+
+int xarray_typed_test() {
+    TEST_PROLOG();
+    TEST_FUNC(TypedNumbers);
+    TEST_FUNC(TypedBool);
+    TEST_FUNC(TypedStrings);
+    TEST_FUNC(TypedConversion);
+    TEST_FUNC(TypedInNode);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xarray_typed_test();
+}
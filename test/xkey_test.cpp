@@ -0,0 +1,127 @@
+//----------------------------------------------------------------------------------
+// Name:        xkey_test.cpp
+// Purpose:     Unit tests for interned keys and xobject_interned
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xobject.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cunit.h"
+
+using namespace std;
+
+void TestKeyIdentity() {
+    xkey first = xkey::of("name");
+    xkey second = xkey::of(std::string("name"));
+    xkey other = xkey::of("value");
+
+    Assert(first == second, "same text, same key");
+    Assert(first != other, "different text");
+    AssertEquals(std::string("name"), first.str(), "text");
+    AssertEquals(4u, static_cast<unsigned>(first.size()), "size");
+    AssertEquals(std::hash<std::string>()("name"), first.hash(), "precomputed hash");
+    AssertEquals(first.hash(), std::hash<xkey>()(first), "std::hash");
+    Assert(sizeof(xkey) == sizeof(void *), "pointer-sized");
+
+    xkey empty;
+    Assert(empty.empty(), "null key is empty");
+    AssertEquals(std::string(""), empty.str(), "null key text");
+    Assert(xkey::of("") != empty, "interned empty text is not null key");
+}
+
+void TestKeyInterner() {
+    xkey_interner interner;
+    xkey local = interner.intern("name");
+    Assert(local != xkey::of("name"), "keys of different interners differ");
+    Assert(local == interner.intern(std::string("name")), "same interner");
+    Assert(interner.find("name") == local, "find existing");
+    Assert(interner.find("missing").empty(), "find missing");
+    AssertEquals(1u, static_cast<unsigned>(interner.size()), "one text");
+
+    for (int i = 0; i < 1000; ++i)
+        interner.intern("key" + to_string(i));
+    AssertEquals(1001u, static_cast<unsigned>(interner.size()), "grown");
+    for (int i = 0; i < 1000; ++i)
+        AssertEquals("key" + to_string(i), interner.find("key" + to_string(i)).str(), "found after grow");
+    Assert(interner.find("name") == local, "key kept after grow");
+}
+
+void TestKeyScope() {
+    xnode_monotonic_buffer_resource arena;
+    xkey_interner interner(&arena);
+    xkey global = xkey::of("scoped");
+    {
+        xkey_interner_scope scope(&interner);
+        xkey local = xkey::of("scoped");
+        Assert(local != global, "scope selects interner");
+        Assert(interner.find("scoped") == local, "interned in scope");
+    }
+    Assert(xkey::of("scoped") == global, "global after scope");
+}
+
+void TestKeyThreads() {
+    const int thread_count = 4;
+    const int key_count = 500;
+    xkey_interner interner;
+    std::vector<std::vector<xkey> > results(thread_count);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.push_back(std::thread([&interner, &results, t, key_count]() {
+            for (int i = 0; i < key_count; ++i)
+                results[t].push_back(interner.intern("field" + to_string(i)));
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    AssertEquals(static_cast<unsigned>(key_count), static_cast<unsigned>(interner.size()), "each text once");
+    for (int t = 1; t < thread_count; ++t)
+        Assert(results[t] == results[0], "same keys in all threads");
+}
+
+void TestInternedObject() {
+    static const xkey name_key = xkey::of("name");
+    static const xkey count_key = xkey::of("count");
+
+    xobject_interned obj;
+    obj.put(name_key, xnode::value_of(std::string("item")));
+    obj.put(count_key, xnode::value_of(3));
+    AssertEquals(std::string("item"), obj.get(xkey::of("name")).get_as<std::string>(), "get by interned text");
+    AssertEquals(3, obj.get(count_key).get_as<int>(), "get");
+    AssertEquals(std::string("name"), obj.get_keys()[0].str(), "order");
+
+    try {
+        obj.get(xkey::of("missing"));
+        Assert(false, "exception expected");
+    }
+    catch (const std::runtime_error &e) {
+        AssertEquals(std::string("key not found: missing"), std::string(e.what()), "key text in message");
+    }
+
+    xnode value = xnode::value_of(obj);
+    Assert(value.is<xobject_interned>(), "stored in node");
+    AssertEquals(18, value.get_type_code(), "type code");
+    AssertEquals(3, value.get_ref<xobject_interned>().get(count_key).get_as<int>(), "read from node");
+}
+
+int xkey_test() {
+    TEST_PROLOG();
+    TEST_FUNC(KeyIdentity);
+    TEST_FUNC(KeyInterner);
+    TEST_FUNC(KeyScope);
+    TEST_FUNC(KeyThreads);
+    TEST_FUNC(InternedObject);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xkey_test();
+}
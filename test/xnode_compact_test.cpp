@@ -0,0 +1,161 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_compact_test.cpp
+// Purpose:     Unit tests for compact (NaN-boxed) xnode variant
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode_compact.h"
+#include "xarray.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "cunit.h"
+
+using namespace std;
+
+void TestCompactSize() {
+    AssertEquals(8u, static_cast<unsigned>(sizeof(xnode_compact)), "node size");
+    Assert(std::is_nothrow_move_constructible<xnode_compact>::value, "move constructor is noexcept");
+    Assert(std::is_nothrow_move_assignable<xnode_compact>::value, "move assignment is noexcept");
+}
+
+void TestCompactNull() {
+    xnode_compact value;
+    Assert(value.is_null(), "null by default");
+    Assert(value.is<xnode_null_value>(), "is null type");
+    Assert(value.type() == typeid(xnode_null_value), "type");
+    AssertEquals(0, value.get_as<int>(), "null read as int");
+}
+
+void TestCompactDouble() {
+    xnode_compact value = xnode_compact::value_of(3.25);
+    Assert(value.is<double>(), "is double");
+    AssertFalse(value.is_boxed(), "not boxed");
+    AssertEquals(3.25, value.get_as<double>(), "read");
+    AssertEquals(3, value.get_as<int>(), "converted");
+    AssertEquals(std::string("3.25"), value.get_as<std::string>(), "to string");
+
+    value.set_as(-0.0);
+    Assert(value.is<double>(), "negative zero");
+
+    value.set_as(std::numeric_limits<double>::quiet_NaN());
+    Assert(value.is<double>(), "nan is double");
+    Assert(std::isnan(value.get_as<double>()), "nan read");
+
+    value.set_as(-std::numeric_limits<double>::infinity());
+    Assert(std::isinf(value.get_as<double>()), "inf read");
+}
+
+void TestCompactScalars() {
+    xnode_compact value = xnode_compact::value_of(true);
+    Assert(value.is<bool>(), "bool");
+    Assert(value.get_as<bool>(), "bool read");
+    AssertEquals(1, value.get_as<int>(), "bool as int");
+
+    value.set_as(-12345);
+    Assert(value.is<int>(), "int");
+    AssertFalse(value.is_boxed(), "int not boxed");
+    AssertEquals(-12345, value.get_as<int>(), "int read");
+    AssertEquals(-12345LL, value.get_as<long long>(), "int as long long");
+    AssertEquals(std::string("-12345"), value.get_as<std::string>(), "int as string");
+
+    value.set_as(1.5f);
+    Assert(value.is<float>(), "float");
+    AssertEquals(1.5f, value.get_as<float>(), "float read");
+    AssertEquals(1.5, value.get_as<double>(), "float as double");
+
+    value.set_as('x');
+    Assert(value.is<char>(), "char");
+    AssertEquals('x', value.get_as<char>(), "char read");
+
+    value.set_as(std::numeric_limits<unsigned int>::max());
+    Assert(value.is<unsigned int>(), "uint");
+    AssertEquals(std::numeric_limits<unsigned int>::max(), value.get_as<unsigned int>(), "uint read");
+    AssertThrows([&]() { value.get_as<int>(); }, "range checked");
+}
+
+void TestCompactLargeInts() {
+    xnode_compact small = xnode_compact::value_of(-(1LL << 39));
+    Assert(small.is<long long>(), "small is long long");
+    AssertFalse(small.is_boxed(), "small not boxed");
+    AssertEquals(-(1LL << 39), small.get_as<long long>(), "small read");
+
+    xnode_compact large = xnode_compact::value_of(std::numeric_limits<long long>::max());
+    Assert(large.is<long long>(), "large is long long");
+    Assert(large.is_boxed(), "large boxed");
+    AssertEquals(std::numeric_limits<long long>::max(), large.get_as<long long>(), "large read");
+
+    Assert(small < large, "less mixed");
+    AssertFalse(large < small, "less mixed, reversed");
+    Assert(small != large, "not equal");
+}
+
+void TestCompactBoxed() {
+    xnode_compact value = xnode_compact::value_of("boxed text");
+    Assert(value.is<std::string>(), "string");
+    Assert(value.is_boxed(), "string boxed");
+    AssertEquals(std::string("boxed text"), value.get_ref<std::string>(), "read");
+
+    xnode_compact copy(value);
+    Assert(copy == value, "copy equal");
+    Assert(copy.get_ptr<std::string>() != value.get_ptr<std::string>(), "deep copy");
+
+    copy.set_as(std::string("other"));
+    AssertEquals(std::string("boxed text"), value.get_as<std::string>(), "source not changed");
+
+    xnode_compact moved(std::move(copy));
+    Assert(copy.is_null(), "moved from is null");
+    AssertEquals(std::string("other"), moved.get_as<std::string>(), "moved");
+
+    value = xnode_compact::value_of(std::string("12"));
+    AssertEquals(12, value.get_as<int>(), "string to int");
+    AssertEquals(7, xnode_compact::value_of(std::string("x")).get_as_def(7), "def value");
+
+    value.set_as(xarray::of_nodes(xnode::value_of(1), xnode::value_of(2)));
+    Assert(value.is<xarray>(), "array");
+    AssertEquals(2u, static_cast<unsigned>(value.get_ref<xarray>().size()), "array size");
+
+    value.set_as(1);
+    AssertFalse(value.is_boxed(), "box released");
+}
+
+void TestCompactConvertable() {
+    xnode_compact value = xnode_compact::value_of(std::string("abc"));
+    AssertFalse(value.is_convertable_to<int>(), "string not convertable");
+    value.set_as(10);
+    Assert(value.is_convertable_to<double>(), "int convertable");
+}
+
+void TestCompactSort() {
+    std::vector<xnode_compact> values;
+    values.push_back(xnode_compact::value_of(3));
+    values.push_back(xnode_compact::value_of(-1));
+    values.push_back(xnode_compact::value_of(2));
+    std::sort(values.begin(), values.end());
+    AssertEquals(-1, values[0].get_as<int>(), "sorted 0");
+    AssertEquals(2, values[1].get_as<int>(), "sorted 1");
+    AssertEquals(3, values[2].get_as<int>(), "sorted 2");
+}
+
+int xnode_compact_test() {
+    TEST_PROLOG();
+    TEST_FUNC(CompactSize);
+    TEST_FUNC(CompactNull);
+    TEST_FUNC(CompactDouble);
+    TEST_FUNC(CompactScalars);
+    TEST_FUNC(CompactLargeInts);
+    TEST_FUNC(CompactBoxed);
+    TEST_FUNC(CompactConvertable);
+    TEST_FUNC(CompactSort);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xnode_compact_test();
+}
@@ -1265,6 +1265,164 @@ void TestStringWithNegativeValues() {
 // Main test function
 //----------------------------------------------------------------------
 
+// converts value with table row and with caster, results and failures have to be the same
+template<typename DestType, typename SrcType>
+void CheckCastRowCell(const SrcType &value) {
+    SrcType input(value);
+    void *slot = nullptr;
+    if (xnode_storage_meta<SrcType>::storage_type == xstCasted)
+        xnode_set_scalar<SrcType>(&slot, value);
+    else
+        slot = &input;
+
+    DestType rowOut = DestType();
+    DestType casterOut = DestType();
+    bool rowResult = false, casterResult = false;
+    bool rowThrown = false, casterThrown = false;
+    try {
+        rowResult = xnode_cast_row<DestType, xnode_def_cast_policy>::cast_to_value(rowOut, &slot, xnode_type_code<SrcType>::value);
+    } catch (const std::exception &) {
+        rowThrown = true;
+    }
+    try {
+        casterResult = xnode_caster<DestType, xnode_def_cast_policy>::cast_to_value(casterOut, &slot, xnode_type_code<SrcType>::value);
+    } catch (const std::exception &) {
+        casterThrown = true;
+    }
+    Assert(rowThrown == casterThrown, "row throws like caster");
+    Assert(rowResult == casterResult, "row result is the same as caster result");
+    Assert(!rowResult || rowOut == casterOut, "row value is the same as caster value");
+}
+
+template<typename DestType>
+void CheckCastRow() {
+    CheckCastRowCell<DestType>(true);
+    CheckCastRowCell<DestType>('7');
+    CheckCastRowCell<DestType>(static_cast<short>(-7));
+    CheckCastRowCell<DestType>(7);
+    CheckCastRowCell<DestType>(-70000);
+    CheckCastRowCell<DestType>(7L);
+    CheckCastRowCell<DestType>(5000000000LL);
+    CheckCastRowCell<DestType>(static_cast<unsigned char>(7));
+    CheckCastRowCell<DestType>(static_cast<unsigned short>(65535));
+    CheckCastRowCell<DestType>(7u);
+    CheckCastRowCell<DestType>(7UL);
+    CheckCastRowCell<DestType>(18446744073709551615ULL);
+    CheckCastRowCell<DestType>(2.5f);
+    CheckCastRowCell<DestType>(-2.5);
+    CheckCastRowCell<DestType>(1e300);
+    CheckCastRowCell<DestType>(std::string("7"));
+    CheckCastRowCell<DestType>(std::string("-1"));
+    CheckCastRowCell<DestType>(std::string("text"));
+}
+
+void TestCastMatrix() {
+    typedef xnode_cast_matrix<xnode_def_cast_policy> matrix;
+
+    // every pair of built-in types has table entry
+    for (int dest = xnode_type_code<bool>::value; dest <= xnode_type_code<unsigned long long>::value; ++dest)
+        for (int src = xnode_type_code<bool>::value; src <= xnode_type_code<unsigned long long>::value; ++src) {
+            Assert(matrix::to_value(dest, src) != nullptr, "to_value entry");
+            Assert(matrix::from_value(src, dest) != nullptr, "from_value entry");
+        }
+
+    Assert(matrix::to_value(xnode_type_code<int>::value, 99) == nullptr, "unknown source");
+    Assert(matrix::to_value(99, xnode_type_code<int>::value) == nullptr, "unknown destination");
+
+    void *slot;
+    xnode_set_scalar<double>(&slot, 2.5);
+    int intOut = 0;
+    Assert(matrix::to_value(xnode_type_code<int>::value, xnode_type_code<double>::value)(&intOut, &slot), "double to int");
+    AssertEquals(2, intOut, "double to int value");
+
+    std::string text("12");
+    slot = &text;
+    long longOut = 0;
+    Assert(matrix::to_value(xnode_type_code<long>::value, xnode_type_code<std::string>::value)(&longOut, &slot), "string to long");
+    AssertEquals(12L, longOut, "string to long value");
+
+    int input = 42;
+    Assert(matrix::from_value(xnode_type_code<int>::value, xnode_type_code<std::string>::value)(&slot, &input), "int to string");
+    AssertEquals(std::string("42"), text, "int to string value");
+
+    // row used by get_as gives the same results as caster
+    CheckCastRow<unsigned short>();
+    CheckCastRow<int>();
+    CheckCastRow<long long>();
+    CheckCastRow<bool>();
+    CheckCastRow<double>();
+    CheckCastRow<std::string>();
+}
+
+void TestCastMatrixCustomPolicy() {
+    typedef xnode_cast_matrix<xnode_ld_cast_policy> matrix;
+
+    Assert(matrix::to_value(xnode_type_code<long double>::value, xnode_type_code<double>::value) != nullptr, "long double row");
+    Assert(matrix::to_value(xnode_type_code<double>::value, xnode_type_code<long double>::value) != nullptr, "double row");
+    Assert(matrix::to_value(xnode_type_code<int>::value, xnode_type_code<double>::value) == nullptr, "no int row");
+
+    long double ld = 1.5L;
+    void *slot = &ld;
+    double out = 0;
+    Assert(matrix::to_value(xnode_type_code<double>::value, xnode_type_code<long double>::value)(&out, &slot), "long double to double");
+    AssertEquals(1.5, out, "long double to double value");
+}
+
+void TestNumberFormatting() {
+    // shortest text which reads back to the same value
+    AssertEquals(std::string("0.1"), xnode::value_of(0.1).get_as<std::string>(), "double 0.1");
+    AssertEquals(std::string("0.3333333333333333"), xnode::value_of(1.0 / 3).get_as<std::string>(), "double 1/3");
+    AssertEquals(std::string("3.14"), xnode::value_of(3.14f).get_as<std::string>(), "float formatted as float");
+    AssertEquals(std::string("1e+20"), xnode::value_of(1e20).get_as<std::string>(), "exponent");
+    AssertEquals(std::string("-0.00125"), xnode::value_of(-0.00125).get_as<std::string>(), "fixed");
+    AssertEquals(std::string("-9223372036854775808"),
+                 xnode::value_of(std::numeric_limits<long long>::min()).get_as<std::string>(), "long long min");
+    AssertEquals(std::string("18446744073709551615"),
+                 xnode::value_of(std::numeric_limits<unsigned long long>::max()).get_as<std::string>(), "ull max");
+
+    const double samples[] = { 5e-324, 1.7976931348623157e308, 123456.789, -2.5e-7, 9007199254740993.0 };
+    for (double sample : samples) {
+        AssertEquals(sample, xnode::value_of(xnode::value_of(sample).get_as<std::string>()).get_as<double>(), "round trip");
+    }
+    float small = std::numeric_limits<float>::denorm_min();
+    AssertEquals(small, from_string<float>(xnode::value_of(small).get_as<std::string>()), "float round trip");
+
+    char buffer[xn_number_buffer_size];
+    AssertEquals(std::string("-42"), std::string(buffer, xn_format_number(buffer, -42)), "format to buffer");
+}
+
+void TestNumberParsing() {
+    int intValue = 0;
+    Assert(from_string(intValue, std::string("  +42abc")), "whitespace, sign and suffix");
+    AssertEquals(42, intValue, "int parsed");
+    AssertFalse(from_string(intValue, std::string("abc")), "not a number");
+    AssertFalse(from_string(intValue, std::string("2147483648")), "int out of range");
+
+    unsigned int uintValue = 0;
+    AssertFalse(from_string(uintValue, std::string("-1")), "negative unsigned");
+
+    double doubleValue = 0;
+    Assert(from_string(doubleValue, std::string("2.5e")), "incomplete exponent ignored");
+    AssertEquals(2.5, doubleValue, "double parsed");
+    AssertFalse(from_string(doubleValue, std::string("1e400")), "double out of range");
+
+    const char text[] = "17.5;";
+    const char *end = nullptr;
+    float floatValue = 0;
+    Assert(xn_parse_number(text, text + sizeof(text) - 1, floatValue, end) == xnsOk, "parse from buffer");
+    AssertEquals(17.5f, floatValue, "float parsed");
+    AssertEquals(';', *end, "end of number");
+
+    // conversions keep their exceptions
+    AssertThrows([]() { xnode::value_of(std::string("40000")).get_as<short>(); }, "short overflow");
+    AssertThrows([]() { xnode::value_of(std::string("-5")).get_as<unsigned long>(); }, "unsigned underflow");
+    AssertThrows([]() { xnode::value_of(std::string("1e39")).get_as<float>(); }, "float overflow");
+    AssertThrows([]() { xnode::value_of(std::string("1.2.3")).get_as<double>(); }, "malformed double");
+    AssertThrows([]() { xnode::value_of(std::string("1.2.3")).get_as<float>(); }, "malformed float");
+    AssertThrows([]() { xnode::value_of(std::string("2-1")).get_as<double>(); }, "double with sign inside");
+    AssertEquals(1.5, xnode::value_of(std::string("1.5 m")).get_as<double>(), "double with unit");
+}
+
 int xnode_convert_test() {
     TEST_PROLOG();
     
@@ -1290,6 +1448,10 @@ int xnode_convert_test() {
     TEST_FUNC(StringWithNegativeValues);
     TEST_FUNC(LongDoubleConversions);
     TEST_FUNC(SpecialFloatingValues);
+    TEST_FUNC(CastMatrix);
+    TEST_FUNC(CastMatrixCustomPolicy);
+    TEST_FUNC(NumberFormatting);
+    TEST_FUNC(NumberParsing);
     
     TEST_EPILOG();
 }
@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_memory_test.cpp
+// Purpose:     Unit tests for memory resources & arena-allocated nodes
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#include "xnode.h"
+#include "xarray.h"
+#include "xarray_typed.h"
+#include "xobject.h"
+#include <iostream>
+#include <string>
+
+#include "cunit.h"
+
+using namespace std;
+
+// resource counting requests forwarded to new/delete resource
+class counting_resource : public xnode_memory_resource {
+public:
+    counting_resource() : allocs_(0), deallocs_(0) {}
+
+    size_t allocs() const { return allocs_; }
+    size_t deallocs() const { return deallocs_; }
+
+protected:
+    virtual void *do_allocate(size_t bytes, size_t alignment) {
+        ++allocs_;
+        return xnode_new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    virtual void do_deallocate(void *ptr, size_t bytes, size_t alignment) {
+        ++deallocs_;
+        xnode_new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    virtual bool do_is_equal(const xnode_memory_resource &other) const noexcept {
+        return this == &other;
+    }
+
+private:
+    size_t allocs_;
+    size_t deallocs_;
+};
+
+void TestDefaultResourceScope() {
+    counting_resource res;
+    xnode_memory_resource *prev = xnode_get_default_resource();
+    Assert(prev == xnode_new_delete_resource(), "new/delete by default");
+    {
+        xnode_memory_scope scope(&res);
+        Assert(xnode_get_default_resource() == &res, "scoped resource");
+    }
+    Assert(xnode_get_default_resource() == prev, "restored");
+}
+
+void TestPmrValue() {
+    counting_resource res;
+    {
+        xnode_memory_scope scope(&res);
+        xnode_pmr value = xnode_pmr::value_of(std::string("12"));
+        AssertEquals(1u, static_cast<unsigned>(res.allocs()), "value allocated from resource");
+        Assert(value.is<std::string>(), "is string");
+        AssertEquals(12, value.get_as<int>(), "converted");
+        value.set_as(std::string("abc"));
+        AssertEquals(1u, static_cast<unsigned>(res.allocs()), "same type assigned in place");
+        value.set_as(5);
+        AssertEquals(1u, static_cast<unsigned>(res.deallocs()), "released to resource");
+        AssertEquals(5, value.get_as<int>(), "scalar");
+    }
+    AssertEquals(res.allocs(), res.deallocs(), "balanced");
+}
+
+void TestPmrCopyOutsideScope() {
+    counting_resource res;
+    xnode_pmr copy;
+    {
+        xnode_memory_scope scope(&res);
+        xnode_pmr value = xnode_pmr::value_of(std::string("abc"));
+        AssertEquals(1u, static_cast<unsigned>(res.allocs()), "allocated in scope");
+        xnode_memory_scope inner(xnode_new_delete_resource());
+        copy = value;
+        AssertEquals(1u, static_cast<unsigned>(res.allocs()), "copy uses current resource");
+    }
+    AssertEquals(std::string("abc"), copy.get_as<std::string>(), "copy survives");
+    AssertEquals(res.allocs(), res.deallocs(), "balanced");
+}
+
+void TestPmrHoldRelease() {
+    counting_resource res;
+    {
+        xnode_memory_scope scope(&res);
+        xnode_pmr value;
+        value.hold(new std::string("held"));
+        AssertEquals(1u, static_cast<unsigned>(res.allocs()), "moved to resource");
+        AssertEquals(std::string("held"), value.get_as<std::string>(), "read");
+
+        std::unique_ptr<std::string> released(value.release<std::string>());
+        Assert(released.get() != nullptr, "released");
+        AssertEquals(std::string("held"), *released, "released value");
+        Assert(value.is_null(), "null after release");
+        AssertEquals(1u, static_cast<unsigned>(res.deallocs()), "block returned");
+    }
+}
+
+void TestPmrTree() {
+    counting_resource res;
+    {
+        xnode_memory_scope scope(&res);
+
+        xobject_pmr obj;
+        obj.put("name", xnode_pmr::value_of(std::string("item")));
+        obj.put("count", xnode_pmr::value_of(3));
+
+        xarray_pmr arr;
+        arr.push_back(xnode_pmr::value_of(1));
+        arr.push_back(xnode_pmr::value_of(obj));
+
+        xnode_pmr root = xnode_pmr::value_of(arr);
+        size_t allocs = res.allocs();
+        Assert(allocs > 0, "tree allocated from resource");
+
+        Assert(root.is<xarray_pmr>(), "root is array");
+        AssertEquals(xnode_type_code<xarray>::value, root.get_type_code(), "array type code");
+        const xobject_pmr &item = root.get_ref<xarray_pmr>()[1].get_ref<xobject_pmr>();
+        AssertEquals(std::string("item"), item.get("name").get_as<std::string>(), "nested value");
+        AssertEquals(3, item.get("count").get_as<int>(), "nested scalar");
+    }
+    Assert(res.allocs() > 0, "allocated");
+    AssertEquals(res.allocs(), res.deallocs(), "balanced");
+}
+
+void TestMonotonicArena() {
+    xnode_monotonic_buffer_resource arena(64);
+    {
+        xnode_memory_scope scope(&arena);
+        xarray_pmr arr;
+        for (int i = 0; i < 100; ++i)
+            arr.push_back(xnode_pmr::value_of(std::string("value") + to_string(i)));
+        AssertEquals(100u, static_cast<unsigned>(arr.size()), "size");
+        AssertEquals(std::string("value42"), arr[42].get_as<std::string>(), "read");
+
+        void *ptr = arena.allocate(1, 1);
+        void *aligned = arena.allocate(sizeof(double), alignof(double));
+        Assert(ptr != aligned, "distinct blocks");
+        AssertEquals(0u, static_cast<unsigned>(reinterpret_cast<size_t>(aligned) % alignof(double)), "aligned");
+    }
+    arena.release();
+}
+
+// conversion reads packed elements one by one, nodes of source array are not created
+void TestPmrPackedConversion() {
+    counting_resource res;
+    {
+        xnode_memory_scope scope(&res);
+        xarray_pmr arr;
+        for (int i = 0; i < 100; ++i)
+            arr.push_back(xnode_pmr::value_of(i));
+        const xarray_pmr &src = arr;
+        Assert(src.packed(), "packed source");
+
+        size_t allocs = res.allocs();
+        xarray_of<double> values = xarray_of<double>::from_xarray(src);
+        xarray_of<std::string> texts = xarray_of<std::string>::from_xarray(src);
+        AssertEquals(allocs, res.allocs(), "source is not unpacked");
+        Assert(values.size() == 100 && values[42] == 42.0, "converted values");
+        AssertEquals(std::string("99"), texts[99], "converted texts");
+    }
+    AssertEquals(res.allocs(), res.deallocs(), "balanced");
+}
+
+int xnode_memory_test() {
+    TEST_PROLOG();
+    TEST_FUNC(DefaultResourceScope);
+    TEST_FUNC(PmrValue);
+    TEST_FUNC(PmrCopyOutsideScope);
+    TEST_FUNC(PmrHoldRelease);
+    TEST_FUNC(PmrTree);
+    TEST_FUNC(MonotonicArena);
+    TEST_FUNC(PmrPackedConversion);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xnode_memory_test();
+}
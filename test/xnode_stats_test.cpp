@@ -0,0 +1,155 @@
+//----------------------------------------------------------------------------------
+// Name:        xnode_stats_test.cpp
+// Purpose:     Unit tests for instrumentation counters (XNODE_ENABLE_STATS)
+// Author:      Piotr Likus
+// Created:     16/10/2026
+// License:     BSD
+//----------------------------------------------------------------------------------
+
+#ifndef XNODE_ENABLE_STATS
+#define XNODE_ENABLE_STATS
+#endif
+
+#include "xnode.h"
+#include "xarray.h"
+#include "xobject.h"
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "cunit.h"
+
+using namespace std;
+
+const int string_code = xnode_type_code<std::string>::value;
+const int int_code = xnode_type_code<int>::value;
+
+void TestStatsAllocations() {
+    xnode_stats_reset();
+    {
+        xnode value = xnode::value_of(std::string("text"));
+        xnode copy(value);
+        value.set_as(5);
+    }
+    xnode_stats_snapshot stats = xnode_stats_collect();
+    AssertEquals(2ull, stats.allocs[string_code], "string allocs");
+    AssertEquals(2ull, stats.frees[string_code], "string frees");
+    AssertEquals(0ull, stats.allocs[int_code], "int stored in node");
+    AssertEquals(1ull, stats.copies, "deep copies");
+    AssertEquals(static_cast<unsigned long long>(sizeof(std::string)), stats.copied_bytes, "copied bytes");
+
+    xnode_stats_reset();
+    {
+        xnode_cow shared = xnode_cow::value_of(std::string("shared"));
+        xnode_cow copy(shared);
+        copy.get_ref<std::string>() += "!";
+    }
+    stats = xnode_stats_collect();
+    AssertEquals(2ull, stats.allocs[string_code], "cow allocs after write");
+    AssertEquals(2ull, stats.frees[string_code], "cow frees");
+    AssertEquals(1ull, stats.copies, "cow copied on write");
+}
+
+void TestStatsReleaseAndHold() {
+    xnode_stats_reset();
+    std::unique_ptr<std::string> owned;
+    {
+        xnode value;
+        value.hold(new std::string("held"));
+        owned.reset(value.release<std::string>());
+    }
+    xnode_stats_snapshot stats = xnode_stats_collect();
+    AssertEquals(1ull, stats.allocs[string_code], "hold counted");
+    AssertEquals(1ull, stats.frees[string_code], "release counted");
+}
+
+void TestStatsConversions() {
+    xnode_stats_reset();
+    xnode value = xnode::value_of(std::string("12"));
+    AssertEquals(12, value.get_as<int>(), "converted");
+    AssertEquals(12, value.get_as<int>(), "converted again");
+    AssertEquals(std::string("12"), value.get_as<std::string>(), "same type");
+
+    xnode text = xnode::value_of(std::string("abc"));
+    AssertEquals(7, text.get_as_def<int>(7), "failed conversion");
+
+    xnode_stats_snapshot stats = xnode_stats_collect();
+    AssertEquals(3ull, stats.conversions[string_code][int_code], "string to int");
+    AssertEquals(1ull, stats.conversion_failures[string_code][int_code], "failed string to int");
+    AssertEquals(3ull, stats.total_conversions(), "same type read is not a conversion");
+}
+
+void TestStatsErrors() {
+    xnode_stats_reset();
+    xnode text = xnode::value_of(std::string("abc"));
+    AssertThrows([&]() { text.get_as<int>(); }, "wrong cast");
+    AssertThrows([&]() { text.get_ref<int>(); }, "ref read");
+    xnode big = xnode::value_of(std::numeric_limits<long long>::max());
+    AssertThrows([&]() { big.get_as<int>(); }, "range");
+
+    xnode_stats_snapshot stats = xnode_stats_collect();
+    AssertEquals(1ull, stats.errors[xseWrongCast], "wrong cast counted");
+    AssertEquals(1ull, stats.errors[xseRefReadFail], "ref read counted");
+    AssertEquals(1ull, stats.errors[xseOutOfRange], "range counted");
+    AssertEquals(1ull, stats.conversion_failures[xnode_type_code<long long>::value][int_code], "throwing conversion failed");
+}
+
+void TestStatsThreads() {
+    xnode_stats_reset();
+    std::thread worker([]() {
+        for (int i = 0; i < 10; ++i)
+            xnode::value_of(std::string("1")).get_as<int>();
+    });
+    worker.join();
+    xnode::value_of(std::string("1")).get_as<int>();
+
+    xnode_stats_snapshot stats = xnode_stats_collect();
+    AssertEquals(11ull, stats.conversions[string_code][int_code], "finished thread included");
+    AssertEquals(11ull, stats.allocs[string_code], "allocs of all threads");
+}
+
+// node destroyed after counters of its thread
+struct late_node_holder {
+    xnode node;
+};
+
+// global node is freed by static destructors, after counters of main thread
+xnode global_node;
+
+void TestStatsThreadExit() {
+    xnode_stats_reset();
+    std::thread worker([]() {
+        static thread_local late_node_holder holder;
+        holder.node = xnode::value_of(std::string("freed at thread exit"));
+    });
+    worker.join();
+
+    xnode_stats_snapshot stats = xnode_stats_collect();
+    AssertEquals(1ull, stats.allocs[string_code], "alloc counted");
+    AssertEquals(0ull, stats.frees[string_code], "free after counters are destroyed is not counted");
+
+    global_node.set_as(std::string("freed at exit"));
+}
+
+void TestStatsSlots() {
+    AssertEquals(static_cast<size_t>(xnode_stats_type_codes - 1), xnode_stats_snapshot::slot(1000), "high code");
+    AssertEquals(static_cast<size_t>(xnode_stats_type_codes - 1), xnode_stats_snapshot::slot(-1), "negative code");
+    AssertEquals(static_cast<size_t>(int_code), xnode_stats_snapshot::slot(int_code), "builtin code");
+}
+
+int xnode_stats_test() {
+    TEST_PROLOG();
+    TEST_FUNC(StatsAllocations);
+    TEST_FUNC(StatsReleaseAndHold);
+    TEST_FUNC(StatsConversions);
+    TEST_FUNC(StatsErrors);
+    TEST_FUNC(StatsThreads);
+    TEST_FUNC(StatsThreadExit);
+    TEST_FUNC(StatsSlots);
+    TEST_EPILOG();
+}
+
+int main()
+{
+    return xnode_stats_test();
+}
@@ -18,6 +18,7 @@
 
 #include "cunit.h"
 #include "xnode_long_double.h"
+#include "xarray.h"
 
 using namespace std;
 
@@ -648,6 +649,248 @@ void TestSafeCastNoThrow() {
     AssertNoThrow(readByDoubleDef(value, 13.1));
 }
 
+typedef basic_xnode<xnode_inline_value_policy<sizeof(std::string)> > xnode_inl;
+
+void TestInlineString() {
+    xnode_inl value = xnode_inl::value_of(std::string("inline"));
+    Assert(value.is<std::string>(), "is string");
+    Assert(value.get_ptr<std::string>() == value.get_vptr(), "stored inside node");
+    Assert(static_cast<const void *>(value.get_ptr<std::string>()) >= static_cast<const void *>(&value), "ptr in node, lower");
+    Assert(static_cast<const void *>(value.get_ptr<std::string>()) < static_cast<const void *>(&value + 1), "ptr in node, upper");
+    Assert(value.get_as<std::string>() == "inline", "read");
+
+    xnode_inl copy(value);
+    Assert(copy == value, "copy equals");
+    copy.set_as(std::string("changed"));
+    Assert(value.get_as<std::string>() == "inline", "source not changed");
+
+    xnode_inl moved(std::move(copy));
+    Assert(moved.get_as<std::string>() == "changed", "moved");
+    Assert(copy.is_null(), "source of move is null");
+
+    moved = value;
+    Assert(moved.get_as<std::string>() == "inline", "assigned");
+    Assert(value < xnode_inl::value_of(std::string("z")), "less");
+}
+
+void TestInlineConversions() {
+    xnode_inl value = xnode_inl::value_of(std::string("123"));
+    Assert(value.get_as<int>() == 123, "string to int");
+    Assert(value.is_convertable_to<double>(), "convertable");
+
+    value.set_value(456);
+    Assert(value.is<std::string>(), "type kept");
+    Assert(value.get_as<std::string>() == "456", "int to string");
+
+    value.set_as(12);
+    Assert(value.is<int>(), "scalar replaces inline value");
+    Assert(value.get_as<std::string>() == "12", "int read as string");
+}
+
+void TestInlineDestructor() {
+    struct TestStr {
+        int *counter_;
+
+        TestStr(int *counter) : counter_(counter) {}
+        TestStr(const TestStr &src) : counter_(src.counter_) { ++*counter_; }
+        TestStr(TestStr &&src) noexcept : counter_(src.counter_) { ++*counter_; }
+        TestStr &operator=(const TestStr &src) { counter_ = src.counter_; return *this; }
+        ~TestStr() { --*counter_; }
+    };
+
+    int alive = 0;
+    {
+        TestStr obj(&alive);
+        alive = 1;
+
+        xnode_inl value;
+        value.set_as(obj);
+        Assert(alive == 2, "copy constructed in node");
+        Assert(value.get_ptr<TestStr>() == value.get_vptr(), "stored inside node");
+
+        xnode_inl moved(std::move(value));
+        Assert(alive == 2, "moved, old value destroyed");
+
+        std::unique_ptr<TestStr> released(moved.release<TestStr>());
+        Assert(released.get() != nullptr, "released");
+        Assert(moved.is_null(), "null after release");
+        Assert(alive == 2, "released copy alive");
+    }
+    Assert(alive == 0, "all destroyed");
+}
+
+void TestInlineHold() {
+    xnode_inl value;
+    value.hold(new std::string("held"));
+    Assert(value.get_ptr<std::string>() == value.get_vptr(), "stored inside node");
+    Assert(value.get_as<std::string>() == "held", "read");
+}
+
+void TestInlineTooLarge() {
+    struct TestStr {
+        char data[sizeof(std::string) + 1];
+    };
+
+    TestStr obj;
+    obj.data[0] = 'x';
+
+    xnode_inl value;
+    value.set_as(obj);
+    const void *ptr = value.get_ptr<TestStr>();
+    Assert(ptr < static_cast<const void *>(&value) || ptr >= static_cast<const void *>(&value + 1), "allocated outside node");
+    Assert(value.get_ptr<TestStr>()->data[0] == 'x', "read");
+}
+
+template <typename T>
+const T *shared_ptr_of(const xnode_cow &node) {
+    return node.get_ptr<T>();
+}
+
+void TestCowCopyShares() {
+    xnode_cow value = xnode_cow::value_of(std::string("abc"));
+    xnode_cow copy1(value);
+    xnode_cow copy2;
+    copy2 = value;
+    Assert(shared_ptr_of<std::string>(value) == shared_ptr_of<std::string>(copy1), "copy shares value");
+    Assert(shared_ptr_of<std::string>(value) == shared_ptr_of<std::string>(copy2), "assignment shares value");
+    Assert(value == copy1, "equal");
+}
+
+void TestCowWriteUnshares() {
+    xnode_cow value = xnode_cow::value_of(std::string("abc"));
+    xnode_cow copy(value);
+
+    copy.get_ref<std::string>() = "changed";
+    AssertEquals(std::string("abc"), value.get_as<std::string>(), "original kept");
+    AssertEquals(std::string("changed"), copy.get_as<std::string>(), "copy changed");
+    Assert(shared_ptr_of<std::string>(value) != shared_ptr_of<std::string>(copy), "unshared");
+
+    // exclusive value is modified in place
+    const std::string *ptr = shared_ptr_of<std::string>(copy);
+    copy.get_ref<std::string>() += "!";
+    Assert(ptr == shared_ptr_of<std::string>(copy), "no copy when not shared");
+}
+
+void TestCowSetters() {
+    xnode_cow value = xnode_cow::value_of(std::string("1"));
+    xnode_cow copy1(value);
+    xnode_cow copy2(value);
+
+    copy1.set_as(std::string("2"));
+    copy2.set_value(3);
+    AssertEquals(std::string("1"), value.get_as<std::string>(), "original kept");
+    AssertEquals(std::string("2"), copy1.get_as<std::string>(), "set_as");
+    AssertEquals(std::string("3"), copy2.get_as<std::string>(), "set_value");
+
+    std::unique_ptr<std::string> released(value.release<std::string>());
+    copy1 = copy2;
+    copy2.reset();
+    AssertEquals(std::string("1"), *released, "released");
+    AssertEquals(std::string("3"), copy1.get_as<std::string>(), "still alive");
+}
+
+void TestCowNested() {
+    typedef basic_xarray<xnode_cow> xarray_cow;
+
+    xarray_cow items;
+    items.push_back(xnode_cow::value_of(std::string("a")));
+    items.push_back(xnode_cow::value_of(std::string("b")));
+
+    xnode_cow root = xnode_cow::value_of(items);
+    xnode_cow copy = root;
+    Assert(shared_ptr_of<xarray_cow>(root) == shared_ptr_of<xarray_cow>(copy), "shared array");
+
+    copy.get_ref<xarray_cow>()[1].set_as(std::string("c"));
+    AssertEquals(std::string("b"), root.get_ref<xarray_cow>()[1].get_as<std::string>(), "original kept");
+    AssertEquals(std::string("c"), copy.get_ref<xarray_cow>()[1].get_as<std::string>(), "copy changed");
+    Assert(shared_ptr_of<std::string>(root.get_ref<xarray_cow>()[0]) == shared_ptr_of<std::string>(copy.get_ref<xarray_cow>()[0]), "untouched element still shared");
+}
+
+struct copy_counter {
+    static int copies;
+    static int moves;
+
+    copy_counter() : value(0) {}
+    explicit copy_counter(int v) : value(v) {}
+    copy_counter(const copy_counter &src) : value(src.value) { ++copies; }
+    copy_counter(copy_counter &&src) noexcept : value(src.value) { ++moves; }
+    copy_counter &operator=(const copy_counter &src) { value = src.value; ++copies; return *this; }
+    copy_counter &operator=(copy_counter &&src) noexcept { value = src.value; ++moves; return *this; }
+    bool operator==(const copy_counter &rhs) const { return value == rhs.value; }
+    bool operator<(const copy_counter &rhs) const { return value < rhs.value; }
+
+    static void clear() { copies = moves = 0; }
+
+    int value;
+    char padding[32];
+};
+
+int copy_counter::copies = 0;
+int copy_counter::moves = 0;
+
+struct throwing_value {
+    explicit throwing_value(int) { throw std::runtime_error("ctor failed"); }
+    int value;
+    char padding[32];
+};
+
+void TestMoveValueOf() {
+    copy_counter::clear();
+    xnode value = xnode::value_of(copy_counter(1));
+    AssertEquals(0, copy_counter::copies, "no copy in value_of");
+    AssertEquals(1, value.get_ref<copy_counter>().value, "value");
+
+    value.set_as(copy_counter(2));
+    AssertEquals(0, copy_counter::copies, "no copy in set_as");
+    AssertEquals(2, value.get_ref<copy_counter>().value, "assigned");
+
+    xnode_inl inl;
+    inl.set_as(std::string("moved into inline storage"));
+    AssertEquals(std::string("moved into inline storage"), inl.get_as<std::string>(), "inline");
+
+    xnode_cow cow = xnode_cow::value_of(copy_counter(3));
+    xnode_cow cowCopy(cow);
+    cowCopy.set_as(copy_counter(4));
+    AssertEquals(0, copy_counter::copies, "no copy for shared");
+    AssertEquals(3, cow.get_ref<copy_counter>().value, "shared original kept");
+}
+
+void TestEmplace() {
+    copy_counter::clear();
+    xnode value;
+    value.emplace<copy_counter>(5);
+    AssertEquals(0, copy_counter::copies + copy_counter::moves, "constructed in place");
+    AssertEquals(5, value.get_ref<copy_counter>().value, "value");
+
+    value.emplace<std::string>(3, 'x');
+    AssertEquals(std::string("xxx"), value.get_as<std::string>(), "string");
+
+    value.emplace<int>(7);
+    AssertEquals(7, value.get_as<int>(), "scalar");
+
+    bool thrown = false;
+    try {
+        value.emplace<throwing_value>(1);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    Assert(thrown, "exception passed");
+    Assert(value.is_null(), "null after failed emplace");
+}
+
+void TestValueOfConverted() {
+    xnode value = xnode::value_of<std::string>(12);
+    Assert(value.is<std::string>(), "converted type");
+    AssertEquals(std::string("12"), value.get_as<std::string>(), "converted value");
+
+    xnode same = xnode::value_of<int>(12);
+    Assert(same.is<int>(), "same type");
+
+    xnode node = xnode::value_of(same);
+    Assert(node.is<xnode>() && node.get_type_code() == 0, "node is wrapped in node");
+    AssertEquals(12, node.get_ref<xnode>().get_as<int>(), "value of wrapped node");
+}
+
 int xnode_test() {
 	TEST_PROLOG();
 	TEST_FUNC(DefCntr);
@@ -698,6 +941,18 @@ int xnode_test() {
     TEST_FUNC(LongDoubleCastWithPolicyConstruct);
     TEST_FUNC(WrongCastThrows);
     TEST_FUNC(SafeCastNoThrow);
+    TEST_FUNC(InlineString);
+    TEST_FUNC(InlineConversions);
+    TEST_FUNC(InlineDestructor);
+    TEST_FUNC(InlineHold);
+    TEST_FUNC(InlineTooLarge);
+    TEST_FUNC(CowCopyShares);
+    TEST_FUNC(CowWriteUnshares);
+    TEST_FUNC(CowSetters);
+    TEST_FUNC(CowNested);
+    TEST_FUNC(MoveValueOf);
+    TEST_FUNC(Emplace);
+    TEST_FUNC(ValueOfConverted);
 	TEST_EPILOG();
 }
 
@@ -362,6 +362,49 @@ void TestStaticOfMethod() {
            "epsilon should have correct value");
 }
 
+void TestShapedObject() {
+	xobject_shaped a, b;
+	a.put("id", xnode::value_of(1));
+	a.put("name", xnode::value_of(std::string("ala")));
+	b.put("id", xnode::value_of(2));
+	b.put("name", xnode::value_of(std::string("ola")));
+
+	Assert(a.storage().shape() == b.storage().shape());
+	Assert(b.get("name").get_as<std::string>() == "ola");
+
+	xnode node = xnode::value_of(a);
+	Assert(node.is<xobject_shaped>());
+	Assert(node.get_ptr<xobject_shaped>()->get("id").get_as<int>() == 1);
+}
+
+// keys_end must not compact entries, removed keys stay valid until next keys_begin
+void TestRemoveWhileIterating() {
+	xobject obj;
+	for (int i = 0; i < 32; ++i)
+		obj.put("key" + std::to_string(i), xnode::value_of(i));
+
+	int count = 0;
+	for (auto it = obj.keys_begin(); it != obj.keys_end(); ++it, ++count)
+		obj.remove(*it);
+	Assert(count == 32 && obj.empty());
+	auto first = obj.keys_begin();
+	Assert(first == obj.keys_end());
+}
+
+void TestFrozenObject() {
+	xobject obj;
+	obj.put("id", xnode::value_of(1));
+	obj.put("name", xnode::value_of(std::string("ala")));
+	xnode node = xnode::value_of(obj.freeze());
+	Assert(node.is<frozen_xobject>() && !node.is<xobject>());
+
+	const frozen_xobject &frozen = *node.get_ptr<frozen_xobject>();
+	Assert(frozen.get("name").get_as<std::string>() == "ala");
+	xobject thawed(frozen);
+	thawed.put("value", xnode::value_of(2));
+	Assert(thawed.size() == 3 && thawed.get("id").get_as<int>() == 1);
+}
+
 int xobject_test() {
 	TEST_PROLOG();
 	TEST_FUNC(PropertyListPutGet);
@@ -373,6 +416,9 @@ int xobject_test() {
     TEST_FUNC(DefNamedParams);
     TEST_FUNC(StaticOfMethod);
     TEST_FUNC(Iterators);
+    TEST_FUNC(ShapedObject);
+    TEST_FUNC(RemoveWhileIterating);
+    TEST_FUNC(FrozenObject);
 	TEST_EPILOG();
 }
 